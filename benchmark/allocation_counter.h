@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+/**
+ * Count the heap allocations made by the current thread.
+ *
+ * Replaces the global allocation functions, include in exactly one translation
+ * unit of a benchmark executable.
+ */
+namespace ncdlgen
+{
+inline thread_local std::size_t thread_allocation_count{};
+}
+
+void* operator new(std::size_t size)
+{
+    ncdlgen::thread_allocation_count++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <string_view>
+
+#include <fmt/core.h>
+
+namespace ncdlgen
+{
+
+/**
+ * Measure the wall clock time of the benchmark runs
+ */
+class Timer
+{
+  public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+
+    double elapsed_seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point start{};
+};
+
+inline void print_throughput(std::string_view name, std::size_t bytes, double seconds)
+{
+    fmt::print("{:<40} {:>10.1f} MB/s {:>10.3f} s\n", name, static_cast<double>(bytes) / seconds / 1e6,
+               seconds);
+}
+
+inline void print_rate(std::string_view name, std::size_t count, double seconds)
+{
+    fmt::print("{:<40} {:>10.0f} ops/s {:>10.3f} us/op\n", name, static_cast<double>(count) / seconds,
+               seconds / static_cast<double>(count) * 1e6);
+}
+
+} // namespace ncdlgen
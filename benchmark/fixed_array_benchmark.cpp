@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "benchmark_utils.h"
+#include "fixed_array_interface.h"
+#include "nd_array_interface.h"
+#include "pipes/pipe_data.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t message_count = 200000;
+
+/**
+ * Encode and decode many small messages of a fixed size variable, e.g. the
+ * foobar(dim, dim) of data/simple.cdl. The writes flatten the container to the
+ * message as SharedMemoryPipe::write does, reusing the dimension sizes of the
+ * pipe. The reads decode to a new container each time as read<T>() does. The
+ * dynamic containers allocate for each message, FixedArray does not.
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+void run(std::string_view name, const ContainerType& data)
+{
+    std::vector<std::size_t> dimension_sizes{};
+    container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes);
+    const auto bytes = data_size<ContainerType, ElementType>(dimension_sizes);
+    std::vector<ElementType> buffer(bytes / sizeof(ElementType));
+
+    auto allocations_before = thread_allocation_count;
+    Timer write_timer{};
+    for (std::size_t i = 0; i < message_count; i++)
+    {
+        container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes);
+        copy_data<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes, buffer.data());
+    }
+    auto seconds = write_timer.elapsed_seconds();
+    auto allocations = thread_allocation_count - allocations_before;
+
+    print_rate(fmt::format("{} write", name), message_count, seconds);
+    fmt::print("{:<40} {:>10.1f} allocations/write\n", "", static_cast<double>(allocations) / message_count);
+
+    // Keep the decoded containers observable
+    std::size_t total_size{};
+    allocations_before = thread_allocation_count;
+    Timer read_timer{};
+    for (std::size_t i = 0; i < message_count; i++)
+    {
+        ContainerType output{};
+        data_from_buffer<ContainerType, ElementType, ContainerInterface>(output, buffer.data(), bytes,
+                                                                         dimension_sizes);
+        total_size += output.size();
+    }
+    seconds = read_timer.elapsed_seconds();
+    allocations = thread_allocation_count - allocations_before;
+
+    print_rate(fmt::format("{} read", name), message_count, seconds);
+    fmt::print("{:<40} {:>10.1f} allocations/read\n", "", static_cast<double>(allocations) / message_count);
+    if (total_size == 0)
+    {
+        fmt::print("No data decoded\n");
+    }
+}
+
+int main()
+{
+    constexpr std::size_t y = 5, x = 5;
+
+    run<std::vector<std::vector<int>>, int, VectorInterface>(
+        "5x5 vector", std::vector<std::vector<int>>(y, std::vector<int>(x, 1)));
+    run<NDArray<int, 2>, int, NDArrayInterface>("5x5 NDArray", NDArray<int, 2>{{y, x}, 1});
+
+    FixedArray<int, y, x> fixed_array{};
+    std::fill(fixed_array.begin(), fixed_array.end(), 1);
+    run<FixedArray<int, y, x>, int, FixedArrayInterface>("5x5 FixedArray", fixed_array);
+
+    return 0;
+}
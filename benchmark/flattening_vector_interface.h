@@ -0,0 +1,41 @@
+#pragma once
+
+#include "vector_interface.h"
+
+namespace ncdlgen
+{
+
+/**
+ * VectorInterface without the optional parts, i.e. how the pipes worked before
+ * the copy-free paths: flatten to a Data and copy it again to the message, and
+ * copy from the message to a Data before assigning to the final container.
+ */
+struct FlatteningVectorInterface
+{
+    template <typename ElementType, typename ContainerType,
+              std::enable_if_t<VectorOperations::is_vector_v<ContainerType>, bool> = true>
+    static constexpr bool is_supported_ndarray()
+    {
+        return true;
+    };
+
+    template <typename ElementType, typename ContainerType>
+    static Data<ElementType> prepare(const ContainerType& data)
+    {
+        return VectorInterface::prepare<ElementType, ContainerType>(data);
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static Data<ElementType> prepare(const std::vector<std::size_t>& dimension_sizes)
+    {
+        return VectorInterface::prepare<ElementType, ContainerType>(dimension_sizes);
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static void finalise(ContainerType& output, const Data<ElementType>& data)
+    {
+        VectorInterface::finalise<ElementType, ContainerType>(output, data);
+    }
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/in_process_pipe.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+/**
+ * A record like the generated structs, with the send time for measuring the latency
+ */
+struct Record
+{
+    std::int64_t sent_ns{};
+    std::vector<float> values{};
+};
+
+static std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * The generated functions of the record for both pipes
+ */
+void write(InProcessPipe<Record>& pipe, Record&& record) { pipe.write(std::move(record)); }
+void read(InProcessPipe<Record>& pipe, Record& record) { pipe.read(record); }
+
+void write(ZeroMQPipe& pipe, Record&& record)
+{
+    pipe.begin_record();
+    pipe.write<std::int64_t, std::int64_t, VectorInterface>({0, "/sent_ns"}, record.sent_ns);
+    pipe.write<std::vector<float>, float, VectorInterface>({1, "/values"}, record.values);
+    pipe.end_record();
+}
+void read(ZeroMQPipe& pipe, Record& record)
+{
+    pipe.read_into<std::int64_t, std::int64_t, VectorInterface>({0, "/sent_ns"}, record.sent_ns);
+    pipe.read_into<std::vector<float>, float, VectorInterface>({1, "/values"}, record.values);
+}
+
+/**
+ * Stream the records to a reading thread as fast as possible
+ */
+template <typename Pipe> void run_throughput(std::string_view name, Pipe& pipe, std::size_t record_size,
+                                             std::size_t record_count)
+{
+    std::thread reader(
+        [&pipe, record_count]
+        {
+            Record record{};
+            for (std::size_t i = 0; i < record_count; i++)
+            {
+                read(pipe, record);
+            }
+        });
+
+    Timer timer{};
+    Record record{};
+    for (std::size_t i = 0; i < record_count; i++)
+    {
+        // Fill the record as the acquisition would, reusing any recycled buffer
+        record.values.assign(record_size, static_cast<float>(i));
+        write(pipe, std::move(record));
+    }
+    reader.join();
+    auto seconds = timer.elapsed_seconds();
+
+    print_throughput(fmt::format("{} {} floats", name, record_size),
+                     record_count * record_size * sizeof(float), seconds);
+    print_rate("", record_count, seconds);
+}
+
+/**
+ * Send one record at a time and wait for the reader, and report the time from
+ * the write to the end of the read
+ */
+template <typename Pipe> void run_latency(std::string_view name, Pipe& pipe, std::size_t record_count)
+{
+    std::atomic<std::size_t> read_count{};
+    std::vector<std::int64_t> latencies(record_count);
+    std::thread reader(
+        [&]
+        {
+            Record record{};
+            for (std::size_t i = 0; i < record_count; i++)
+            {
+                read(pipe, record);
+                latencies[i] = now_ns() - record.sent_ns;
+                read_count.store(i + 1, std::memory_order_release);
+            }
+        });
+
+    Record record{};
+    for (std::size_t i = 0; i < record_count; i++)
+    {
+        record.values.assign(16, 1.0f);
+        record.sent_ns = now_ns();
+        write(pipe, std::move(record));
+        while (read_count.load(std::memory_order_acquire) != i + 1)
+        {
+            std::this_thread::yield();
+        }
+    }
+    reader.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    fmt::print("{:<40} {:>10.2f} us median {:>10.2f} us p99\n", fmt::format("{} latency", name),
+               static_cast<double>(latencies[record_count / 2]) / 1e3,
+               static_cast<double>(latencies[record_count * 99 / 100]) / 1e3);
+}
+
+int main()
+{
+    const ZeroMQConfiguration zeromq_config{.outbound_socket = "inproc://ncdlgen_benchmark",
+                                            .incoming_socket = "inproc://ncdlgen_benchmark"};
+
+    for (auto [record_size, record_count] : {std::pair<std::size_t, std::size_t>{16, 200000},
+                                             std::pair<std::size_t, std::size_t>{64 * 1024, 5000}})
+    {
+        InProcessPipe<Record> in_process{};
+        run_throughput("in process", in_process, record_size, record_count);
+
+        ZeroMQPipe zeromq{zeromq_config};
+        run_throughput("zeromq inproc", zeromq, record_size, record_count);
+    }
+
+    {
+        InProcessPipe<Record> in_process{};
+        run_latency("in process", in_process, 20000);
+
+        ZeroMQPipe zeromq{zeromq_config};
+        run_latency("zeromq inproc", zeromq, 20000);
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "nd_array_interface.h"
+#include "pipes/pipe_data.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t repeat_count = 200;
+
+/**
+ * Encode the container to a message buffer and decode it back, the way the
+ * ZeroMQ and shared memory pipes do for each write and read
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+void run(std::string_view name, const ContainerType& data)
+{
+    auto dimension_sizes = container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data);
+    const auto bytes = data_size<ContainerType, ElementType>(dimension_sizes);
+    std::vector<ElementType> buffer(bytes / sizeof(ElementType));
+
+    Timer write_timer{};
+    for (std::size_t i = 0; i < repeat_count; i++)
+    {
+        dimension_sizes = container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data);
+        copy_data<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes, buffer.data());
+    }
+    auto write_seconds = write_timer.elapsed_seconds();
+
+    // The output container is reused, as with read_into
+    ContainerType output{};
+    Timer read_timer{};
+    for (std::size_t i = 0; i < repeat_count; i++)
+    {
+        data_from_buffer<ContainerType, ElementType, ContainerInterface>(output, buffer.data(), bytes,
+                                                                         dimension_sizes);
+    }
+    auto read_seconds = read_timer.elapsed_seconds();
+
+    print_throughput(fmt::format("{} write", name), repeat_count * bytes, write_seconds);
+    print_throughput(fmt::format("{} read", name), repeat_count * bytes, read_seconds);
+}
+
+int main()
+{
+    // 2D, short rows
+    {
+        constexpr std::size_t y = 4096, x = 64;
+        run<std::vector<std::vector<float>>, float, VectorInterface>(
+            "2D vector", std::vector<std::vector<float>>(y, std::vector<float>(x, 1.0f)));
+        run<NDArray<float, 2>, float, NDArrayInterface>("2D NDArray", NDArray<float, 2>{{y, x}, 1.0f});
+    }
+
+    // 3D, a time series of grids
+    {
+        constexpr std::size_t t = 64, y = 90, x = 180;
+        using Vector3D = std::vector<std::vector<std::vector<float>>>;
+        run<Vector3D, float, VectorInterface>(
+            "3D vector", Vector3D(t, std::vector<std::vector<float>>(y, std::vector<float>(x, 1.0f))));
+        run<NDArray<float, 3>, float, NDArrayInterface>("3D NDArray", NDArray<float, 3>{{t, y, x}, 1.0f});
+    }
+
+    return 0;
+}
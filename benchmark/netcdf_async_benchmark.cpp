@@ -0,0 +1,88 @@
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "parser.h"
+#include "pipes/async_netcdf_pipe.h"
+#include "pipes/netcdf_pipe.h"
+#include "tokeniser.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t record_count = 10000;
+static constexpr std::size_t record_size = 256;
+
+static const char* file_name = "async_benchmark.nc";
+
+using Record = std::vector<std::vector<float>>;
+
+static RootGroup parse_schema()
+{
+    auto cdl = fmt::format("netcdf data {{\n"
+                           "dimensions:\n"
+                           "    time = unlimited, x = {};\n"
+                           "variables:\n"
+                           "    double time(time);\n"
+                           "    float values(time, x);\n"
+                           "    int count;\n"
+                           "}}",
+                           record_size);
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    return std::move(*parser.parse());
+}
+
+/**
+ * Write the records of the generated interface, the time of the writing
+ * thread is measured separately from the time until the file is synced
+ */
+template <typename PipeType> void write_records(std::string_view name, PipeType& pipe)
+{
+    Record record(1, std::vector<float>(record_size, 1.0f));
+
+    Timer write_timer{};
+    for (std::size_t i = 0; i < record_count; i++)
+    {
+        pipe.begin_record();
+        pipe.template write<std::vector<double>, double, VectorInterface>("/time", {i * 0.5});
+        pipe.template write<Record, float, VectorInterface>("/values", record);
+        pipe.template write<int, int, VectorInterface>("/count", static_cast<int>(i));
+        pipe.end_record();
+    }
+    auto write_seconds = write_timer.elapsed_seconds();
+    pipe.sync();
+    auto total_seconds = write_timer.elapsed_seconds();
+    pipe.close();
+
+    print_rate(fmt::format("{} writes", name), record_count, write_seconds);
+    print_rate(fmt::format("{} synced", name), record_count, total_seconds);
+}
+
+int main()
+{
+    auto root = parse_schema();
+
+    {
+        NetCDFPipe pipe{file_name, {.write_mode = NetCDFWriteMode::Append}};
+        pipe.create_from_schema(root);
+        write_records("synchronous", pipe);
+    }
+
+    {
+        AsyncNetCDFPipe pipe{file_name, {.netcdf = {.write_mode = NetCDFWriteMode::Append}}};
+        pipe.create_from_schema(root);
+        write_records("asynchronous", pipe);
+        fmt::print("asynchronous coalesced writes {}\n", pipe.statistics().coalesced_writes);
+    }
+
+    {
+        AsyncNetCDFPipe pipe{file_name,
+                             {.netcdf = {.write_mode = NetCDFWriteMode::Append}, .coalesce_records = false}};
+        pipe.create_from_schema(root);
+        write_records("asynchronous, not coalesced", pipe);
+    }
+
+    return 0;
+}
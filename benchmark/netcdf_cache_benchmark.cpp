@@ -0,0 +1,94 @@
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/netcdf_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t variable_count = 50;
+static constexpr std::size_t variable_size = 16;
+static constexpr std::size_t record_count = 10000;
+
+static const char* file_name = "cache_benchmark.nc";
+
+/**
+ * Create a file with a group of 1D variables
+ */
+static void create_file()
+{
+    int root_id{};
+    int group_id{};
+    int dimension_id{};
+    nc_create(file_name, NC_NETCDF4 | NC_CLOBBER, &root_id);
+    nc_def_grp(root_id, "data", &group_id);
+    nc_def_dim(group_id, "dim", variable_size, &dimension_id);
+    for (std::size_t i = 0; i < variable_count; i++)
+    {
+        int variable_id{};
+        nc_def_var(group_id, fmt::format("variable_{}", i).c_str(), NC_FLOAT, 1, &dimension_id,
+                   &variable_id);
+    }
+    nc_close(root_id);
+}
+
+enum class Lookup
+{
+    // Resolve every variable from the file
+    Uncached,
+    // Find the cached variables by the path
+    Path,
+    // Find the variables of the schema by the field id
+    Schema,
+};
+
+/**
+ * Write the records of all the variables
+ */
+void run(std::string_view name, Lookup lookup)
+{
+    create_file();
+
+    std::vector<std::string> paths{};
+    for (std::size_t i = 0; i < variable_count; i++)
+    {
+        paths.push_back(fmt::format("/data/variable_{}", i));
+    }
+    const std::vector<float> data(variable_size, 1.0f);
+
+    NetCDFPipe pipe{file_name};
+    if (lookup == Lookup::Schema)
+    {
+        pipe.use_schema(Schema{.paths = paths});
+    }
+    pipe.open();
+
+    Timer timer{};
+    for (std::size_t record = 0; record < record_count; record++)
+    {
+        if (lookup == Lookup::Uncached)
+        {
+            pipe.clear_cache();
+        }
+        for (std::uint32_t id = 0; id < paths.size(); id++)
+        {
+            auto field = lookup == Lookup::Schema ? Field{id, paths[id]} : Field{paths[id]};
+            pipe.write<std::vector<float>, float, VectorInterface>(field, data);
+        }
+    }
+    auto seconds = timer.elapsed_seconds();
+    auto statistics = pipe.cache_statistics();
+    pipe.close();
+
+    print_rate(name, record_count * variable_count, seconds);
+    fmt::print("{:<40} {:>10} hits {:>10} misses\n", "", statistics.hits, statistics.misses);
+}
+
+int main()
+{
+    run("resolve every write", Lookup::Uncached);
+    run("cached variables by path", Lookup::Path);
+    run("schema variables by id", Lookup::Schema);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "parser.h"
+#include "pipes/netcdf_pipe.h"
+#include "tokeniser.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t record_count = 100;
+static constexpr std::size_t lat_size = 180;
+static constexpr std::size_t lon_size = 360;
+static constexpr std::size_t tile_size = 30;
+
+static const char* file_name = "chunking_benchmark.nc";
+
+using Record = std::vector<std::vector<std::vector<float>>>;
+
+/**
+ * Create the file of a time series of 2D grids with the given storage attributes
+ */
+static void create_file(NetCDFPipe& pipe, std::string_view storage)
+{
+    auto cdl = fmt::format("netcdf data {{\n"
+                           "dimensions:\n"
+                           "    time = unlimited, lat = {}, lon = {};\n"
+                           "variables:\n"
+                           "    float t(time, lat, lon);\n"
+                           "    {}\n"
+                           "}}",
+                           lat_size, lon_size, storage);
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    auto root = parser.parse();
+    pipe.create_from_schema(*root);
+}
+
+/**
+ * Append the records one by one, and read the time series of every tile of the grid
+ */
+void run(std::string_view name, std::string_view storage, std::optional<NetCDFChunkCache> cache = {})
+{
+    NetCDFPipe pipe{file_name, {.write_mode = NetCDFWriteMode::Append}};
+    create_file(pipe, storage);
+    if (cache)
+    {
+        pipe.set_chunk_cache("/t", *cache);
+    }
+
+    Record record(1, std::vector<std::vector<float>>(lat_size, std::vector<float>(lon_size)));
+    for (std::size_t lat = 0; lat < lat_size; lat++)
+    {
+        for (std::size_t lon = 0; lon < lon_size; lon++)
+        {
+            record[0][lat][lon] = static_cast<float>(lat * lon % 97);
+        }
+    }
+
+    Timer write_timer{};
+    for (std::size_t i = 0; i < record_count; i++)
+    {
+        pipe.write<Record, float, VectorInterface>("/t", record);
+    }
+    pipe.sync();
+    auto write_seconds = write_timer.elapsed_seconds();
+
+    // Reopen to read from the file instead of the chunk cache of the writes
+    pipe.close();
+    pipe.open();
+    if (cache)
+    {
+        pipe.set_chunk_cache("/t", *cache);
+    }
+
+    Timer read_timer{};
+    for (std::size_t lat = 0; lat < lat_size; lat += tile_size)
+    {
+        for (std::size_t lon = 0; lon < lon_size; lon += tile_size)
+        {
+            auto tile = pipe.read_slab<Record, float, VectorInterface>("/t", {0, lat, lon},
+                                                                       {record_count, tile_size, tile_size});
+        }
+    }
+    auto read_seconds = read_timer.elapsed_seconds();
+    pipe.close();
+
+    const auto bytes = record_count * lat_size * lon_size * sizeof(float);
+    print_throughput(fmt::format("{} append", name), bytes, write_seconds);
+    print_throughput(fmt::format("{} tile reads", name), bytes, read_seconds);
+}
+
+int main()
+{
+    run("default chunks", "");
+    run("record chunks", fmt::format("t:_ChunkSizes = 1, {}, {};", lat_size, lon_size));
+    run("tile chunks", fmt::format("t:_ChunkSizes = 16, {}, {};", tile_size, tile_size));
+    run("tile chunks, small cache", fmt::format("t:_ChunkSizes = 16, {}, {};", tile_size, tile_size),
+        NetCDFChunkCache{.size = 256 * 1024, .slots = 7, .preemption = 0.75f});
+    run("record chunks, deflate", fmt::format("t:_ChunkSizes = 1, {}, {}; t:_DeflateLevel = 1; "
+                                              "t:_Shuffle = \"true\";",
+                                              lat_size, lon_size));
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "parser.h"
+#include "pipes/netcdf_pipe.h"
+#include "tokeniser.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t record_count = 1000;
+static constexpr std::size_t lat_size = 90;
+static constexpr std::size_t lon_size = 180;
+
+using Record = std::vector<std::vector<std::vector<float>>>;
+
+static RootGroup parse_schema()
+{
+    auto cdl = fmt::format("netcdf data {{\n"
+                           "dimensions:\n"
+                           "    time = unlimited, lat = {}, lon = {};\n"
+                           "variables:\n"
+                           "    float t(time, lat, lon);\n"
+                           "}}",
+                           lat_size, lon_size);
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    return std::move(*parser.parse());
+}
+
+/**
+ * Append the records to a new file of the storage and read them back after reopening
+ */
+void run(std::string_view name, const RootGroup& root, const NetCDFConfiguration& config)
+{
+    NetCDFPipe pipe{"memory_benchmark.nc", config};
+
+    Record record(1, std::vector<std::vector<float>>(lat_size, std::vector<float>(lon_size, 1.0f)));
+
+    Timer write_timer{};
+    pipe.create_from_schema(root);
+    for (std::size_t i = 0; i < record_count; i++)
+    {
+        pipe.write<Record, float, VectorInterface>("/t", record);
+    }
+
+    // The in-memory file is handed over as a buffer and opened again from it
+    std::vector<std::uint8_t> buffer{};
+    if (config.storage == NetCDFStorage::Memory)
+    {
+        buffer = pipe.close_memory();
+    }
+    else
+    {
+        pipe.close();
+    }
+    auto write_seconds = write_timer.elapsed_seconds();
+
+    Timer read_timer{};
+    if (config.storage == NetCDFStorage::Memory)
+    {
+        pipe.open_memory(buffer);
+    }
+    else
+    {
+        pipe.open();
+    }
+    auto records = pipe.read<Record, float, VectorInterface>("/t");
+    pipe.close();
+    auto read_seconds = read_timer.elapsed_seconds();
+
+    const auto bytes = record_count * lat_size * lon_size * sizeof(float);
+    print_throughput(fmt::format("{} write", name), bytes, write_seconds);
+    print_throughput(fmt::format("{} read", name), bytes, read_seconds);
+}
+
+int main()
+{
+    auto root = parse_schema();
+
+    run("disk", root, {.write_mode = NetCDFWriteMode::Append});
+    run("diskless, persisted", root,
+        {.write_mode = NetCDFWriteMode::Append, .storage = NetCDFStorage::Diskless, .persist = true});
+    run("memory", root, {.write_mode = NetCDFWriteMode::Append, .storage = NetCDFStorage::Memory});
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "nd_array_interface.h"
+#include "parser.h"
+#include "pipes/netcdf_pipe.h"
+#include "tokeniser.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t repeat_count = 20;
+static constexpr std::size_t time_size = 64;
+static constexpr std::size_t lat_size = 90;
+static constexpr std::size_t lon_size = 180;
+
+static RootGroup parse_schema()
+{
+    auto cdl = fmt::format("netcdf data {{\n"
+                           "dimensions:\n"
+                           "    time = {}, lat = {}, lon = {};\n"
+                           "variables:\n"
+                           "    float grid(lat, lon);\n"
+                           "    float field(time, lat, lon);\n"
+                           "}}",
+                           time_size, lat_size, lon_size);
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    return std::move(*parser.parse());
+}
+
+/**
+ * Write and read the variable repeatedly to an in-memory file, so that the
+ * cost of the containers is not hidden behind the disk
+ */
+template <typename ContainerType, typename ContainerInterface>
+void run(std::string_view name, const RootGroup& root, std::string_view path, const ContainerType& data,
+         std::size_t number_of_elements)
+{
+    NetCDFPipe pipe{"nd_array_benchmark.nc", {.storage = NetCDFStorage::Memory}};
+    pipe.create_from_schema(root);
+
+    Timer write_timer{};
+    for (std::size_t i = 0; i < repeat_count; i++)
+    {
+        pipe.write<ContainerType, float, ContainerInterface>(path, data);
+    }
+    auto write_seconds = write_timer.elapsed_seconds();
+
+    Timer read_timer{};
+    for (std::size_t i = 0; i < repeat_count; i++)
+    {
+        auto read_data = pipe.read<ContainerType, float, ContainerInterface>(path);
+    }
+    auto read_seconds = read_timer.elapsed_seconds();
+    pipe.close_memory();
+
+    const auto bytes = repeat_count * number_of_elements * sizeof(float);
+    print_throughput(fmt::format("{} write", name), bytes, write_seconds);
+    print_throughput(fmt::format("{} read", name), bytes, read_seconds);
+}
+
+int main()
+{
+    auto root = parse_schema();
+
+    using Vector2D = std::vector<std::vector<float>>;
+    using Vector3D = std::vector<Vector2D>;
+    run<Vector2D, VectorInterface>("2D vector", root, "/grid",
+                                   Vector2D(lat_size, std::vector<float>(lon_size)), lat_size * lon_size);
+    run<NDArray<float, 2>, NDArrayInterface>("2D NDArray", root, "/grid",
+                                             NDArray<float, 2>{{lat_size, lon_size}}, lat_size * lon_size);
+    run<Vector3D, VectorInterface>("3D vector", root, "/field",
+                                   Vector3D(time_size, Vector2D(lat_size, std::vector<float>(lon_size))),
+                                   time_size * lat_size * lon_size);
+    run<NDArray<float, 3>, NDArrayInterface>("3D NDArray", root, "/field",
+                                             NDArray<float, 3>{{time_size, lat_size, lon_size}},
+                                             time_size * lat_size * lon_size);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "benchmark_utils.h"
+#include "parser.h"
+#include "pipes/netcdf_pipe.h"
+#include "tokeniser.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t read_count = 1000;
+static constexpr std::size_t lat_size = 90;
+static constexpr std::size_t lon_size = 180;
+
+static RootGroup parse_schema()
+{
+    auto cdl = fmt::format("netcdf data {{\n"
+                           "dimensions:\n"
+                           "    lat = {}, lon = {};\n"
+                           "variables:\n"
+                           "    int count;\n"
+                           "    float lat(lat);\n"
+                           "    float grid(lat, lon);\n"
+                           "}}",
+                           lat_size, lon_size);
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    return std::move(*parser.parse());
+}
+
+/**
+ * The struct of the schema, as generated with and without --pmr_containers
+ */
+template <template <typename> typename Vector> struct Record
+{
+    int count{};
+    Vector<float> lat{};
+    Vector<Vector<float>> grid{};
+};
+
+template <typename T> using StdVector = std::vector<T>;
+template <typename T> using PmrVector = std::pmr::vector<T>;
+
+template <typename DataType> void read_fresh(NetCDFPipe& pipe, DataType& data)
+{
+    data.count = pipe.read<int, int, VectorInterface>({0, "/count"});
+    data.lat = pipe.read<decltype(data.lat), float, VectorInterface>({1, "/lat"});
+    data.grid = pipe.read<decltype(data.grid), float, VectorInterface>({2, "/grid"});
+}
+
+template <typename DataType> void read_into(NetCDFPipe& pipe, DataType& data)
+{
+    pipe.read_into<int, int, VectorInterface>({0, "/count"}, data.count);
+    pipe.read_into<decltype(data.lat), float, VectorInterface>({1, "/lat"}, data.lat);
+    pipe.read_into<decltype(data.grid), float, VectorInterface>({2, "/grid"}, data.grid);
+}
+
+/**
+ * Read the same variables in a loop, as a long-running receiver does, and count
+ * the allocations of the global operator new in the steady state. The
+ * allocations of the NetCDF library itself use malloc and are not counted.
+ */
+template <typename DataType, typename ReadFunction>
+void run(std::string_view name, NetCDFPipe& pipe, DataType& data, ReadFunction&& read_function)
+{
+    // Warm up, let the containers and the read buffer of the pipe grow to size
+    read_function(pipe, data);
+
+    auto allocations_before = thread_allocation_count;
+    Timer timer{};
+    for (std::size_t i = 0; i < read_count; i++)
+    {
+        read_function(pipe, data);
+    }
+    auto seconds = timer.elapsed_seconds();
+    auto allocations = thread_allocation_count - allocations_before;
+
+    print_rate(name, read_count, seconds);
+    fmt::print("{:<40} {:>10.1f} allocations/read\n", "", static_cast<double>(allocations) / read_count);
+}
+
+int main()
+{
+    auto root = parse_schema();
+
+    NetCDFPipe pipe{"read_allocation_benchmark.nc", {.storage = NetCDFStorage::Memory}};
+    pipe.create_from_schema(root);
+    pipe.use_schema({0, {"/count", "/lat", "/grid"}});
+
+    Record<StdVector> source{1, std::vector<float>(lat_size, 1.0f),
+                             std::vector<std::vector<float>>(lat_size, std::vector<float>(lon_size, 2.0f))};
+    pipe.write<int, int, VectorInterface>({0, "/count"}, source.count);
+    pipe.write<std::vector<float>, float, VectorInterface>({1, "/lat"}, source.lat);
+    pipe.write<std::vector<std::vector<float>>, float, VectorInterface>({2, "/grid"}, source.grid);
+
+    Record<StdVector> data{};
+    run("read, new containers", pipe, data, read_fresh<Record<StdVector>>);
+    run("read_into, std::vector", pipe, data, read_into<Record<StdVector>>);
+
+    // The containers are allocated once from the pool, and reused after that
+    std::pmr::unsynchronized_pool_resource pool{};
+    Record<PmrVector> pmr_data{0, PmrVector<float>{&pool}, PmrVector<PmrVector<float>>{&pool}};
+    run("read_into, std::pmr::vector", pipe, pmr_data, read_into<Record<PmrVector>>);
+
+    pipe.close_memory();
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/shared_memory_pipe.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+using Array = std::vector<float>;
+
+/**
+ * Send the arrays from the writing pipe to a receiving thread reading with the reading pipe
+ */
+template <typename WritingPipe, typename ReadingPipe>
+void run(std::string_view name, WritingPipe& writer, ReadingPipe& reader, std::size_t array_size,
+         std::size_t message_count)
+{
+    const Array data(array_size, 1.0f);
+
+    std::thread receiver(
+        [&reader, message_count]
+        {
+            Array read_data{};
+            for (std::size_t i = 0; i < message_count; i++)
+            {
+                reader.template read_into<Array, float, VectorInterface>("/data", read_data);
+            }
+        });
+
+    Timer timer{};
+    for (std::size_t i = 0; i < message_count; i++)
+    {
+        writer.template write<Array, float, VectorInterface>("/data", data);
+    }
+    receiver.join();
+    auto seconds = timer.elapsed_seconds();
+
+    print_throughput(fmt::format("{} {} floats", name, array_size),
+                     message_count * array_size * sizeof(float), seconds);
+    print_rate("", message_count, seconds);
+}
+
+void run_shared_memory(std::size_t array_size, std::size_t message_count)
+{
+    SharedMemoryPipe writer{{.name = "/ncdlgen_benchmark"}};
+    SharedMemoryPipe reader{{.name = "/ncdlgen_benchmark"}};
+    run("shared memory", writer, reader, array_size, message_count);
+}
+
+void run_zeromq(std::size_t array_size, std::size_t message_count)
+{
+    ZeroMQPipe pipe{};
+    run("zeromq tcp", pipe, pipe, array_size, message_count);
+}
+
+int main()
+{
+    run_shared_memory(16, 200000);
+    run_zeromq(16, 200000);
+
+    run_shared_memory(256 * 1024, 1000);
+    run_zeromq(256 * 1024, 1000);
+
+    run_shared_memory(4 * 1024 * 1024, 50);
+    run_zeromq(4 * 1024 * 1024, 50);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "array_span_interface.h"
+#include "benchmark_utils.h"
+#include "pipes/pipe_data.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t frame_count = 200;
+static constexpr std::size_t height = 1080;
+static constexpr std::size_t width = 1920;
+
+using Frame = std::vector<std::vector<std::uint16_t>>;
+
+/**
+ * Encode the frames of a camera, held in the buffer of the producer, to a
+ * message as ZeroMQPipe::write does. Without the span, the producer copies the
+ * frame to the nested vectors of the generated struct first.
+ */
+template <typename WriteFunction>
+void run(std::string_view name, const std::vector<std::uint16_t>& frame, WriteFunction&& write_function)
+{
+    std::vector<std::uint16_t> message(height * width);
+
+    Timer timer{};
+    for (std::size_t i = 0; i < frame_count; i++)
+    {
+        write_function(frame, message.data());
+    }
+    auto seconds = timer.elapsed_seconds();
+
+    print_throughput(name, frame_count * frame.size() * sizeof(std::uint16_t), seconds);
+    if (message.back() != frame.back())
+    {
+        fmt::print("The frame was not written\n");
+    }
+}
+
+int main()
+{
+    // The buffer of the producer, e.g. a slot of a DMA ring buffer
+    std::vector<std::uint16_t> frame(height * width);
+    for (std::size_t i = 0; i < frame.size(); i++)
+    {
+        frame[i] = static_cast<std::uint16_t>(i);
+    }
+
+    Frame copied_frame(height, std::vector<std::uint16_t>(width));
+    run("copy to struct, write vectors", frame,
+        [&](const std::vector<std::uint16_t>& buffer, std::uint16_t* output)
+        {
+            for (std::size_t y = 0; y < height; y++)
+            {
+                std::copy(buffer.begin() + y * width, buffer.begin() + (y + 1) * width,
+                          copied_frame[y].begin());
+            }
+            auto dimension_sizes =
+                container_dimension_sizes<Frame, std::uint16_t, VectorInterface>(copied_frame);
+            copy_data<Frame, std::uint16_t, VectorInterface>(copied_frame, dimension_sizes, output);
+        });
+
+    using Span = ArraySpan<std::uint16_t, 2>;
+    run("write ArraySpan", frame,
+        [&](const std::vector<std::uint16_t>& buffer, std::uint16_t* output)
+        {
+            Span span{buffer, {height, width}};
+            auto dimension_sizes = container_dimension_sizes<Span, std::uint16_t, ArraySpanInterface>(span);
+            copy_data<Span, std::uint16_t, ArraySpanInterface>(span, dimension_sizes, output);
+        });
+
+    return 0;
+}
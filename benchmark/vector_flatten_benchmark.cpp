@@ -0,0 +1,112 @@
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t repeat_count = 100;
+
+namespace previous
+{
+
+/**
+ * The flattening before the single pass: the shapes are computed recursively,
+ * the buffer is zero-initialised, and the elements are assigned one by one
+ */
+template <typename ElementType, typename ContainerType>
+std::vector<std::size_t> container_dimension_sizes(const ContainerType& data)
+{
+    if constexpr (std::is_same_v<ElementType, typename ContainerType::value_type>)
+    {
+        return {data.size()};
+    }
+    else
+    {
+        std::vector<std::size_t> dimension_sizes = {data.size()};
+        auto element_dimension_sizes =
+            container_dimension_sizes<ElementType, typename ContainerType::value_type>(data.front());
+        for (std::size_t i = 0; i < data.size(); i++)
+        {
+            auto sibling_dimension_sizes =
+                container_dimension_sizes<ElementType, typename ContainerType::value_type>(data.front());
+            if (sibling_dimension_sizes != element_dimension_sizes)
+            {
+                throw std::runtime_error("inconsistent dimension sizes");
+            }
+        }
+        dimension_sizes.insert(dimension_sizes.end(), element_dimension_sizes.begin(),
+                               element_dimension_sizes.end());
+        return dimension_sizes;
+    }
+}
+
+template <typename ElementType, typename ContainerType>
+void flatten_data(const ContainerType& data, std::vector<ElementType>& flat_data, std::size_t& flat_index)
+{
+    if constexpr (std::is_same_v<ElementType, ContainerType>)
+    {
+        flat_data[flat_index++] = data;
+    }
+    else
+    {
+        for (auto& element : data)
+        {
+            flatten_data<ElementType, typename ContainerType::value_type>(element, flat_data, flat_index);
+        }
+    }
+}
+
+template <typename ElementType, typename ContainerType>
+Data<ElementType> flatten_data(const ContainerType& data)
+{
+    Data<ElementType> flat_data{};
+    std::size_t flat_index{};
+    flat_data.dimension_sizes = container_dimension_sizes<ElementType, ContainerType>(data);
+    flat_data.data.resize(VectorOperations::number_of_elements(flat_data.dimension_sizes));
+    flatten_data<ElementType, ContainerType>(data, flat_data.data, flat_index);
+    return flat_data;
+}
+
+} // namespace previous
+
+template <typename ContainerType, typename Function>
+void run(std::string_view name, const ContainerType& data, std::size_t number_of_elements,
+         Function&& function)
+{
+    std::size_t checksum{};
+    Timer timer{};
+    for (std::size_t i = 0; i < repeat_count; i++)
+    {
+        checksum += function(data).data.size();
+    }
+    auto seconds = timer.elapsed_seconds();
+
+    if (checksum != repeat_count * number_of_elements)
+    {
+        throw std::runtime_error("Flattened the wrong number of elements");
+    }
+    print_throughput(name, repeat_count * number_of_elements * sizeof(float), seconds);
+}
+
+int main()
+{
+    constexpr std::size_t t = 64, y = 90, x = 180;
+    using Field = std::vector<std::vector<std::vector<float>>>;
+    Field field(t, std::vector<std::vector<float>>(y, std::vector<float>(x, 1.0f)));
+
+    run("3D element-wise (previous)", field, t * y * x,
+        [](const Field& data) { return previous::flatten_data<float, Field>(data); });
+    run("3D single pass", field, t * y * x,
+        [](const Field& data) { return VectorOperations::flatten_data<float, Field>(data); });
+
+    using Rows = std::vector<std::vector<float>>;
+    Rows rows(t * y * x / 8, std::vector<float>(8, 1.0f));
+    run("2D short rows element-wise (previous)", rows, t * y * x,
+        [](const Rows& data) { return previous::flatten_data<float, Rows>(data); });
+    run("2D short rows single pass", rows, t * y * x,
+        [](const Rows& data) { return VectorOperations::flatten_data<float, Rows>(data); });
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t message_size = 1024;
+static constexpr std::size_t burst_size = 4000;
+static constexpr std::size_t burst_count = 10;
+
+/**
+ * An acquisition loop writes bursts larger than the zeromq high-water mark,
+ * while another thread receives the messages. Measure the time the writing
+ * thread is held in write.
+ */
+void run(std::string_view name, const ZeroMQConfiguration& config)
+{
+    ZeroMQPipe pipe{config};
+    std::vector<float> data(message_size, 1.0f);
+
+    std::thread receiver(
+        [&pipe]
+        {
+            std::vector<float> read_data{};
+            for (std::size_t i = 0; i < burst_count * burst_size; i++)
+            {
+                pipe.read_into<std::vector<float>, float, VectorInterface>("/data", read_data);
+            }
+        });
+
+    double write_seconds{};
+    for (std::size_t burst = 0; burst < burst_count; burst++)
+    {
+        for (std::size_t i = 0; i < burst_size; i++)
+        {
+            Timer timer{};
+            pipe.write<std::vector<float>, float, VectorInterface>("/data", data);
+            write_seconds += timer.elapsed_seconds();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    pipe.flush();
+    receiver.join();
+
+    print_rate(name, burst_count * burst_size, write_seconds);
+
+    if (config.asynchronous_send)
+    {
+        auto statistics = pipe.send_statistics();
+        fmt::print("{:<40} {:>10} max queue depth {} stalls {:.3f} s stalled\n", "",
+                   statistics.max_queue_depth, statistics.stalls, statistics.stall_seconds);
+    }
+}
+
+int main()
+{
+    run("synchronous write (previous)", ZeroMQConfiguration{});
+    run("asynchronous write", ZeroMQConfiguration{.asynchronous_send = true, .send_queue_depth = 8192});
+    run("asynchronous write, queue depth 16",
+        ZeroMQConfiguration{.asynchronous_send = true, .send_queue_depth = 16});
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <atomic>
+#include <malloc.h>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t row_count = 32 * 1024;
+static constexpr std::size_t row_size = 1024;
+static constexpr std::size_t message_count = 4;
+
+using Array = std::vector<std::vector<float>>;
+
+static std::size_t heap_in_use()
+{
+    auto info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/**
+ * Stream the 2D arrays to a receiving thread, and sample the heap in use
+ * while sending to find the peak memory of the transfer
+ */
+void run(std::string_view name, const ZeroMQConfiguration& config, const Array& data)
+{
+    ZeroMQPipe pipe{config};
+
+    const auto baseline = heap_in_use();
+    std::atomic<bool> done{};
+    std::size_t peak{};
+    std::thread monitor(
+        [&]
+        {
+            while (!done.load())
+            {
+                peak = std::max(peak, heap_in_use());
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+
+    std::thread receiver(
+        [&pipe]
+        {
+            Array read_data{};
+            for (std::size_t i = 0; i < message_count; i++)
+            {
+                pipe.read_into<Array, float, VectorInterface>("/data", read_data);
+            }
+        });
+
+    Timer timer{};
+    for (std::size_t i = 0; i < message_count; i++)
+    {
+        pipe.write<Array, float, VectorInterface>("/data", data);
+    }
+    receiver.join();
+    auto seconds = timer.elapsed_seconds();
+
+    done = true;
+    monitor.join();
+
+    print_throughput(name, message_count * row_count * row_size * sizeof(float), seconds);
+    fmt::print("{:<40} {:>10.1f} MB peak heap over the array\n", "",
+               (static_cast<double>(peak) - static_cast<double>(baseline)) / 1e6);
+}
+
+int main()
+{
+    const Array data(row_count, std::vector<float>(row_size, 1.0f));
+    fmt::print("{:.1f} MB arrays\n", static_cast<double>(row_count * row_size * sizeof(float)) / 1e6);
+
+    run("single message", ZeroMQConfiguration{}, data);
+    run("chunked 4 MB", ZeroMQConfiguration{.chunk_size = 4 * 1024 * 1024}, data);
+    run("chunked 1 MB", ZeroMQConfiguration{.chunk_size = 1024 * 1024}, data);
+
+    return 0;
+}
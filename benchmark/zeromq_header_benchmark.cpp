@@ -0,0 +1,87 @@
+#include <string>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/zeromq_pipe.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t iteration_count = 1000000;
+
+int main()
+{
+    ZeroMQVariableInfo info{"/group/subgroup/variable", {128, 256, 4}, ZeroMQElementType::Float};
+
+    {
+        Timer timer{};
+        std::size_t total_size{};
+        for (std::size_t i = 0; i < iteration_count; i++)
+        {
+            total_size += info.to_string().size();
+        }
+        // Keep the encoding from being optimised away
+        if (total_size == 0)
+        {
+            return 1;
+        }
+        print_rate("encode text", iteration_count, timer.elapsed_seconds());
+    }
+
+    {
+        // Encode into a reused buffer, as done when sending the id message
+        std::string buffer(ZeroMQVariableInfo::binary_size(info.name, info.dimension_sizes.size()), '\0');
+        Timer timer{};
+        for (std::size_t i = 0; i < iteration_count; i++)
+        {
+            ZeroMQVariableInfo::to_binary(info.name, info.element_type, info.dimension_sizes, buffer.data());
+        }
+        print_rate("encode binary", iteration_count, timer.elapsed_seconds());
+    }
+
+    {
+        // With a schema, the path is replaced by the field id
+        std::string buffer(ZeroMQVariableInfo::binary_id_size(info.dimension_sizes.size()), '\0');
+        Timer timer{};
+        for (std::size_t i = 0; i < iteration_count; i++)
+        {
+            ZeroMQVariableInfo::to_binary_id(3, info.element_type, info.dimension_sizes, buffer.data());
+        }
+        print_rate("encode binary id", iteration_count, timer.elapsed_seconds());
+    }
+
+    {
+        auto text = info.to_string();
+        ZeroMQVariableInfo decoded{};
+        Timer timer{};
+        for (std::size_t i = 0; i < iteration_count; i++)
+        {
+            decoded.decode(text);
+        }
+        print_rate("decode text", iteration_count, timer.elapsed_seconds());
+    }
+
+    {
+        auto binary = info.to_binary();
+        ZeroMQVariableInfo decoded{};
+        Timer timer{};
+        for (std::size_t i = 0; i < iteration_count; i++)
+        {
+            decoded.decode(binary);
+        }
+        print_rate("decode binary", iteration_count, timer.elapsed_seconds());
+    }
+
+    {
+        std::string binary(ZeroMQVariableInfo::binary_id_size(info.dimension_sizes.size()), '\0');
+        ZeroMQVariableInfo::to_binary_id(3, info.element_type, info.dimension_sizes, binary.data());
+        ZeroMQVariableInfo decoded{};
+        Timer timer{};
+        for (std::size_t i = 0; i < iteration_count; i++)
+        {
+            decoded.decode(binary);
+        }
+        print_rate("decode binary id", iteration_count, timer.elapsed_seconds());
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <thread>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "benchmark_utils.h"
+#include "flattening_vector_interface.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+using Container = std::vector<std::vector<float>>;
+
+static constexpr std::size_t rows = 1024;
+static constexpr std::size_t columns = 1024;
+static constexpr std::size_t message_count = 64;
+
+/**
+ * Send the messages from another thread and measure the receiving
+ */
+template <typename ReadFunction> void run(std::string_view name, ReadFunction&& read_function)
+{
+    ZeroMQPipe pipe{};
+
+    Container data(rows, std::vector<float>(columns, 1.0f));
+    std::thread sender(
+        [&]
+        {
+            for (std::size_t i = 0; i < message_count; i++)
+            {
+                pipe.write<Container, float, VectorInterface>("/data", data);
+            }
+        });
+
+    Container output{};
+
+    // Warm up, let the output grow to size
+    read_function(pipe, output);
+
+    auto allocations_before = thread_allocation_count;
+    Timer timer{};
+    for (std::size_t i = 1; i < message_count; i++)
+    {
+        read_function(pipe, output);
+    }
+    auto seconds = timer.elapsed_seconds();
+    auto allocations = thread_allocation_count - allocations_before;
+    sender.join();
+
+    print_throughput(name, (message_count - 1) * rows * columns * sizeof(float), seconds);
+    fmt::print("{:<40} {:>10.1f} allocations/read\n", "", static_cast<double>(allocations) / (message_count - 1));
+}
+
+int main()
+{
+    run("prepare and finalise (previous)", [](ZeroMQPipe& pipe, Container& output)
+        { output = pipe.read<Container, float, FlatteningVectorInterface>("/data"); });
+
+    run("read", [](ZeroMQPipe& pipe, Container& output)
+        { output = pipe.read<Container, float, VectorInterface>("/data"); });
+
+    run("read_into", [](ZeroMQPipe& pipe, Container& output)
+        { pipe.read_into<Container, float, VectorInterface>("/data", output); });
+
+    return 0;
+}
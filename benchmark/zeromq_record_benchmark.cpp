@@ -0,0 +1,68 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t field_count = 40;
+static constexpr std::size_t record_count = 20000;
+
+/**
+ * A small telemetry record of scalar fields, sent either field by field
+ * or as a single record message
+ */
+void run(std::string_view name, bool batch)
+{
+    ZeroMQPipe pipe{};
+
+    std::vector<std::string> paths{};
+    for (std::size_t i = 0; i < field_count; i++)
+    {
+        paths.push_back(fmt::format("/telemetry/field_{}", i));
+    }
+
+    std::thread receiver(
+        [&]
+        {
+            double value{};
+            for (std::size_t record = 0; record < record_count; record++)
+            {
+                for (auto& path : paths)
+                {
+                    pipe.read_into<double, double, VectorInterface>(path, value);
+                }
+            }
+        });
+
+    Timer timer{};
+    for (std::size_t record = 0; record < record_count; record++)
+    {
+        if (batch)
+        {
+            pipe.begin_record();
+        }
+        for (auto& path : paths)
+        {
+            pipe.write<double, double, VectorInterface>(path, static_cast<double>(record));
+        }
+        if (batch)
+        {
+            pipe.end_record();
+        }
+    }
+    receiver.join();
+
+    print_rate(name, record_count, timer.elapsed_seconds());
+}
+
+int main()
+{
+    run("records field by field (previous)", false);
+    run("records batched", true);
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <thread>
+#include <vector>
+
+#include "benchmark_utils.h"
+#include "flattening_vector_interface.h"
+#include "pipes/zeromq_pipe.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static constexpr std::size_t message_size = 16 * 1024 * 1024;
+static constexpr std::size_t message_count = 16;
+
+/**
+ * Receive the messages in another thread so that the sender
+ * does not block on the high-water mark
+ */
+template <typename WriteFunction> void run(std::string_view name, WriteFunction&& write_function)
+{
+    ZeroMQPipe pipe{};
+
+    std::thread receiver(
+        [&pipe]
+        {
+            for (std::size_t i = 0; i < message_count; i++)
+            {
+                pipe.read<std::vector<float>, float, VectorInterface>("/data");
+            }
+        });
+
+    Timer timer{};
+    for (std::size_t i = 0; i < message_count; i++)
+    {
+        write_function(pipe, i);
+    }
+    receiver.join();
+
+    print_throughput(name, message_count * message_size * sizeof(float), timer.elapsed_seconds());
+}
+
+int main()
+{
+    std::vector<float> data(message_size, 1.0f);
+
+    run("flatten and copy (previous)", [&](ZeroMQPipe& pipe, std::size_t)
+        { pipe.write<std::vector<float>, float, FlatteningVectorInterface>("/data", data); });
+
+    run("copy contiguous", [&](ZeroMQPipe& pipe, std::size_t)
+        { pipe.write<std::vector<float>, float, VectorInterface>("/data", data); });
+
+    // Prepare the buffers up front so that only the sending is measured
+    std::vector<std::vector<float>> moved_data(message_count, data);
+    run("move contiguous (zero-copy)", [&](ZeroMQPipe& pipe, std::size_t i)
+        { pipe.write<std::vector<float>, float, VectorInterface>("/data", std::move(moved_data[i])); });
+
+    auto shared_data = std::make_shared<const std::vector<float>>(data);
+    run("shared contiguous (zero-copy)", [&](ZeroMQPipe& pipe, std::size_t)
+        { pipe.write<std::vector<float>, float, VectorInterface>("/data", shared_data); });
+
+    return 0;
+}
@@ -1,5 +1,7 @@
-
 #include <ncdlgen/netcdf_pipe.h>
+#include <ncdlgen/parser.h>
+#include <ncdlgen/tokeniser.h>
+#include <ncdlgen/utils.h>
 #include <ncdlgen/zeromq_configuration.h>
 #include <ncdlgen/zeromq_pipe.h>
 
@@ -11,15 +13,16 @@
 /**
  * Example receiver
  *
- * Will write the Data in a new example_N.nc file
- * each time we receive data over the socket.
+ * Appends the Data received over the socket as a new record
+ * to the example_archive.nc file, which is created from
+ * example_data.cdl when it does not exist.
  *
  * Pairs together with sender.cpp
  *
  * Demo:
  *   Start the receiver
  *   Execute sender N times
- *   Writes example_[1,N].nc files
+ *   Appends N records to example_archive.nc
  */
 int main()
 {
@@ -27,26 +30,39 @@ int main()
     ncdlgen::ZeroMQConfiguration config{.incoming_socket = "tcp://127.0.0.1:42043"};
     ncdlgen::ZeroMQPipe pipe(config);
 
-    size_t count{1};
+    // The records are appended along the time dimension
+    const std::string output_name{"example_archive.nc"};
+    ncdlgen::NetCDFPipe output_pipe{output_name, {.write_mode = ncdlgen::NetCDFWriteMode::Append}};
+    if (std::filesystem::exists(output_name))
+    {
+        output_pipe.open();
+    }
+    else
+    {
+        // Create the archive from the CDL the interface was generated from
+        auto cdl = ncdlgen::read_file(EXAMPLE_CDL_PATH);
+        ncdlgen::Tokeniser tokeniser{cdl};
+        auto tokens = tokeniser.tokenise();
+        ncdlgen::Parser parser{tokens};
+        auto root = parser.parse();
+        if (!root)
+        {
+            fmt::print(stderr, "Parsing {} failed\n", EXAMPLE_CDL_PATH);
+            return 1;
+        }
+        output_pipe.create_from_schema(*root);
+    }
 
     while (true)
     {
         generated::Data data{};
         read(pipe, data);
 
-        fmt::print("Read data\n");
-
-        auto output_name = fmt::format("example_{}.nc", count);
-        std::filesystem::copy_file("example.nc", output_name,
-                                   std::filesystem::copy_options::overwrite_existing);
-
-        ncdlgen::NetCDFPipe output_pipe{output_name};
-
-        output_pipe.open();
         generated::write(output_pipe, data);
-        output_pipe.close();
-        count++;
+        output_pipe.sync();
+
+        fmt::print("Appended record {}\n", output_pipe.next_record("/time") - 1);
     }
 
     return 0;
-}
\ No newline at end of file
+}
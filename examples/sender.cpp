@@ -14,7 +14,7 @@
  * Demo:
  *   Start the receiver
  *   Execute sender N times
- *   Writes example_[1,N].nc files
+ *   Appends N records to example_archive.nc
  */
 int main()
 {
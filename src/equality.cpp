@@ -134,6 +134,30 @@ bool operator==(const CompoundType& type, const CompoundType& other_type)
     return types_ok;
 }
 
+bool operator==(const Variable& variable, const Variable& other_variable)
+{
+    if (!(variable.name() == other_variable.name() && variable.type() == other_variable.type() &&
+          variable.dimensions().size() == other_variable.dimensions().size()))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < variable.dimensions().size(); i++)
+    {
+        if (variable.dimensions()[i].name() != other_variable.dimensions()[i].name())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool operator==(const Group& group, const Group& other_group)
+{
+    return group.name() == other_group.name() && group.dimensions() == other_group.dimensions() &&
+           group.types() == other_group.types() && group.variables() == other_group.variables() &&
+           group.groups() == other_group.groups();
+}
+
 bool operator!=(const NetCDFType& type, const NetCDFType& other_type) { return !(type == other_type); }
 bool operator!=(const ComplexType& type, const ComplexType& other_type) { return !(type == other_type); }
 bool operator!=(const EnumValue& value, const EnumValue& other_value) { return !(value == other_value); }
@@ -143,5 +167,137 @@ bool operator!=(const VLenType& type, const VLenType& other_type) { return !(typ
 bool operator!=(const EnumType& type, const EnumType& other_type) { return !(type == other_type); }
 bool operator!=(const ArrayType& type, const ArrayType& other_type) { return !(type == other_type); }
 bool operator!=(const CompoundType& type, const CompoundType& other_type) { return !(type == other_type); }
+bool operator!=(const Variable& variable, const Variable& other_variable)
+{
+    return !(variable == other_variable);
+}
+bool operator!=(const Group& group, const Group& other_group) { return !(group == other_group); }
+
+/**
+ * 64-bit FNV-1a, the fields are hashed in the order they are compared for equality
+ */
+class Fingerprint
+{
+  public:
+    void add(std::uint64_t value)
+    {
+        for (size_t i = 0; i < sizeof(value); i++)
+        {
+            m_hash = (m_hash ^ ((value >> (8 * i)) & 0xff)) * prime;
+        }
+    }
+
+    void add(const std::string_view value)
+    {
+        // The length separates consecutive strings
+        add(static_cast<std::uint64_t>(value.size()));
+        for (auto character : value)
+        {
+            m_hash = (m_hash ^ static_cast<unsigned char>(character)) * prime;
+        }
+    }
+
+    void add(const NetCDFElementaryType type) { add(static_cast<std::uint64_t>(type)); }
+
+    void add(const Dimension& dimension)
+    {
+        add(dimension.name);
+        add(static_cast<std::uint64_t>(dimension.length));
+    }
+
+    void add(const EnumValue& value)
+    {
+        add(value.name);
+        add(static_cast<std::uint64_t>(value.value));
+    }
+
+    void add(const OpaqueType& type)
+    {
+        add(static_cast<std::uint64_t>(type.length));
+        add(type.name);
+    }
+
+    void add(const VLenType& type)
+    {
+        add(type.type);
+        add(type.name);
+    }
+
+    void add(const EnumType& type)
+    {
+        add_all(type.enum_values);
+        add(type.type);
+        add(type.name);
+    }
+
+    void add(const ArrayType& type)
+    {
+        add(type.type);
+        add(type.name);
+        add_all(type.dimensions.dimensions);
+    }
+
+    void add(const CompoundType& type)
+    {
+        add(type.name);
+        add_all(type.type_names);
+        add_all(type.types);
+    }
+
+    void add(const ComplexType& type)
+    {
+        // The alternative separates the types with equal contents
+        add(static_cast<std::uint64_t>(type.type.index()));
+        std::visit([this](auto&& contained_type) { add(contained_type); }, type.type);
+    }
+
+    void add(const NetCDFType& type)
+    {
+        add(static_cast<std::uint64_t>(type.type.index()));
+        std::visit([this](auto&& contained_type) { add(contained_type); }, type.type);
+    }
+
+    void add(const Variable& variable)
+    {
+        add(variable.name());
+        add(variable.type());
+        add(static_cast<std::uint64_t>(variable.dimensions().size()));
+        for (auto& dimension : variable.dimensions())
+        {
+            add(dimension.name());
+        }
+    }
+
+    void add(const Group& group)
+    {
+        add(group.name());
+        add_all(group.dimensions());
+        add_all(group.types());
+        add_all(group.variables());
+        add_all(group.groups());
+    }
+
+    std::uint64_t value() const { return m_hash; }
+
+  private:
+    template <typename ValueType> void add_all(const std::vector<ValueType>& values)
+    {
+        add(static_cast<std::uint64_t>(values.size()));
+        for (auto& value : values)
+        {
+            add(value);
+        }
+    }
+
+    static constexpr std::uint64_t prime{0x100000001b3};
+    std::uint64_t m_hash{0xcbf29ce484222325};
+};
+
+std::uint64_t fingerprint(const Group& group)
+{
+    Fingerprint hash{};
+    hash.add(group);
+    return hash.value();
+}
 
 } // namespace ncdlgen
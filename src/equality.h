@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "types.h"
 
 namespace ncdlgen
@@ -25,5 +27,18 @@ bool operator==(const ArrayType& type, const ArrayType& other_type);
 bool operator!=(const ArrayType& type, const ArrayType& other_type);
 bool operator==(const CompoundType& type, const CompoundType& other_type);
 bool operator!=(const CompoundType& type, const CompoundType& other_type);
+bool operator==(const Variable& variable, const Variable& other_variable);
+bool operator!=(const Variable& variable, const Variable& other_variable);
+bool operator==(const Group& group, const Group& other_group);
+bool operator!=(const Group& group, const Group& other_group);
+
+/**
+ * Hash of the group tree over the same fields that are compared for equality,
+ * equal groups have equal fingerprints
+ *
+ * The hash does not depend on the platform or the build, so it can be used
+ * to check that two programs use the same schema.
+ */
+std::uint64_t fingerprint(const Group& group);
 
 } // namespace ncdlgen
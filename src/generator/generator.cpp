@@ -1,8 +1,10 @@
 
+#include <algorithm>
 #include <cassert>
 
 #include <fmt/core.h>
 
+#include "equality.h"
 #include "generator.h"
 #include "parser.h"
 #include "syntax.h"
@@ -24,6 +26,47 @@ DefaultCustomisation::container_for_dimensions(const std::string_view& element_t
     return full_name;
 }
 
+std::string
+NDArrayCustomisation::container_for_dimensions(const std::string_view& element_type_name,
+                                               const std::vector<ncdlgen::VariableDimension>& dimensions)
+{
+    if (dimensions.empty())
+    {
+        return std::string(element_type_name);
+    }
+    return fmt::format("ncdlgen::NDArray<{}, {}>", element_type_name, dimensions.size());
+}
+
+std::string FixedArrayCustomisation::container_for_dimension_lengths(
+    const std::string_view& element_type_name, const std::vector<ncdlgen::VariableDimension>& dimensions,
+    const std::vector<std::size_t>& lengths)
+{
+    // The variables with an unlimited dimension keep the dynamic containers
+    if (dimensions.empty() || std::find(lengths.begin(), lengths.end(), 0) != lengths.end())
+    {
+        return DefaultCustomisation::container_for_dimensions(element_type_name, dimensions);
+    }
+
+    std::string full_name = fmt::format("ncdlgen::FixedArray<{}", element_type_name);
+    for (auto length : lengths)
+    {
+        full_name += fmt::format(", {}", length);
+    }
+    return full_name + ">";
+}
+
+std::string
+PmrCustomisation::container_for_dimensions(const std::string_view& element_type_name,
+                                           const std::vector<ncdlgen::VariableDimension>& dimensions)
+{
+    std::string full_name{element_type_name};
+    for (std::size_t i = 0; i < dimensions.size(); i++)
+    {
+        full_name = fmt::format("std::pmr::vector<{}>", full_name);
+    }
+    return full_name;
+}
+
 void Generator::dump_header(const ncdlgen::Group& group, int indent)
 {
     assert(indent >= 0);
@@ -33,10 +76,7 @@ void Generator::dump_header(const ncdlgen::Group& group, int indent)
     for (auto& variable : group.variables())
     {
         auto indent_str_inner = fmt::format("{}{}", indent_str, std::string((indent + 1) * 2, ' '));
-        fmt::print(
-            "{}{} {};\n", indent_str_inner,
-            options.container_for_dimensions(cpp_name_for_type(variable.basic_type()), variable.dimensions()),
-            variable.name());
+        fmt::print("{}{} {};\n", indent_str_inner, container_type_name(variable), variable.name());
     }
 
     for (auto& sub_group : group.groups())
@@ -45,16 +85,158 @@ void Generator::dump_header(const ncdlgen::Group& group, int indent)
         fmt::print("{}{} {}_g{{}};\n", std::string((indent + 1) * 2, ' '), sub_group.name(),
                    sub_group.name());
     }
+
+    if (options.memory_resource_constructors)
+    {
+        dump_header_memory_resource_constructors(group, indent + 1);
+    }
     fmt::print("{}}};\n\n", indent_str);
 }
 
+void Generator::dump_header_memory_resource_constructors(const ncdlgen::Group& group, int indent)
+{
+    auto indent_str = std::string(indent * 2, ' ');
+
+    // The arrays and the sub groups are constructed with the resource, in the order of the members
+    std::vector<std::string> initialisers{};
+    for (auto& variable : group.variables())
+    {
+        if (!variable.dimensions().empty())
+        {
+            initialisers.push_back(fmt::format("{}(resource)", variable.name()));
+        }
+    }
+    for (auto& sub_group : group.groups())
+    {
+        initialisers.push_back(fmt::format("{}_g(resource)", sub_group.name()));
+    }
+
+    fmt::print("\n{}{}() = default;\n", indent_str, group.name());
+    fmt::print("{}explicit {}(std::pmr::memory_resource*{})", indent_str, group.name(),
+               initialisers.empty() ? "" : " resource");
+    for (std::size_t i = 0; i < initialisers.size(); i++)
+    {
+        fmt::print("{}{}", i == 0 ? " : " : ", ", initialisers[i]);
+    }
+    fmt::print(" {{}}\n");
+}
+
+void Generator::dump_header_lazy(const ncdlgen::Group& group, const std::string_view group_path,
+                                 const std::string_view struct_name, int indent)
+{
+    assert(indent >= 0);
+    auto indent_str = std::string(indent * 2, ' ');
+    auto indent_str_inner = std::string((indent + 1) * 2, ' ');
+    fmt::print("{}struct {}\n", indent_str, struct_name);
+    fmt::print("{}{{\n", indent_str);
+
+    for (auto& sub_group : group.groups())
+    {
+        auto sub_group_path = fmt::format("{}/{}", group_path, sub_group.name());
+        dump_header_lazy(sub_group, sub_group_path, sub_group.name(), indent + 1);
+    }
+
+    // The fields only keep the pipe and the path until they are read
+    std::vector<std::string> initialisers{};
+    for (auto& variable : group.variables())
+    {
+        auto full_path = fmt::format("{}/{}", group_path, variable.name());
+        initialisers.push_back(
+            fmt::format("{}(pipe, {{{}, \"{}\"}})", variable.name(), field_ids.at(full_path), full_path));
+    }
+    for (auto& sub_group : group.groups())
+    {
+        initialisers.push_back(fmt::format("{}_g(pipe)", sub_group.name()));
+    }
+    fmt::print("{}explicit {}({}::NetCDFPipe& pipe)", indent_str_inner, struct_name,
+               options.ncdlgen_namespace);
+    for (std::size_t i = 0; i < initialisers.size(); i++)
+    {
+        fmt::print("{}{}", i == 0 ? " : " : ", ", initialisers[i]);
+    }
+    fmt::print(" {{}}\n\n");
+
+    // Free the read variables, the next access reads them again
+    fmt::print("{}void release()\n{}{{\n", indent_str_inner, indent_str_inner);
+    for (auto& variable : group.variables())
+    {
+        fmt::print("{}  {}.release();\n", indent_str_inner, variable.name());
+    }
+    for (auto& sub_group : group.groups())
+    {
+        fmt::print("{}  {}_g.release();\n", indent_str_inner, sub_group.name());
+    }
+    fmt::print("{}}}\n\n", indent_str_inner);
+
+    for (auto& variable : group.variables())
+    {
+        auto container_type = container_type_name(variable);
+        fmt::print("{}{}::LazyField<{}, {}, {}::{}, {}::NetCDFPipe> {};\n", indent_str_inner,
+                   options.ncdlgen_namespace, container_type, cpp_name_for_type(variable.basic_type()),
+                   options.ncdlgen_namespace, options.array_interface, options.ncdlgen_namespace,
+                   variable.name());
+    }
+    for (auto& sub_group : group.groups())
+    {
+        fmt::print("{}{} {}_g;\n", indent_str_inner, sub_group.name(), sub_group.name());
+    }
+    fmt::print("{}}};\n\n", indent_str);
+}
+
+void Generator::dump_header_view(const ncdlgen::Group& group, const std::string_view struct_name, int indent)
+{
+    assert(indent >= 0);
+    auto indent_str = std::string(indent * 2, ' ');
+    auto indent_str_inner = std::string((indent + 1) * 2, ' ');
+    fmt::print("{}struct {}\n", indent_str, struct_name);
+    fmt::print("{}{{\n", indent_str);
+
+    for (auto& sub_group : group.groups())
+    {
+        dump_header_view(sub_group, sub_group.name(), indent + 1);
+    }
+
+    // The arrays view the memory of the caller, the scalars are copied
+    for (auto& variable : group.variables())
+    {
+        auto element_type_name = cpp_name_for_type(variable.basic_type());
+        if (variable.dimensions().empty())
+        {
+            fmt::print("{}{} {}{{}};\n", indent_str_inner, element_type_name, variable.name());
+            continue;
+        }
+        fmt::print("{}{}::ArraySpan<{}, {}> {}{{}};\n", indent_str_inner, options.ncdlgen_namespace,
+                   element_type_name, variable.dimensions().size(), variable.name());
+    }
+    for (auto& sub_group : group.groups())
+    {
+        fmt::print("{}{} {}_g{{}};\n", indent_str_inner, sub_group.name(), sub_group.name());
+    }
+    fmt::print("{}}};\n\n", indent_str);
+}
+
+std::string Generator::pipe_type(const std::string_view pipe, const std::string_view struct_name) const
+{
+    if (is_value_pipe(pipe))
+    {
+        return fmt::format("{}::{}<{}>", options.ncdlgen_namespace, pipe, struct_name);
+    }
+    return fmt::format("{}::{}", options.ncdlgen_namespace, pipe);
+}
+
+bool Generator::is_value_pipe(const std::string_view pipe) const
+{
+    return std::find(options.value_pipes.begin(), options.value_pipes.end(), pipe) !=
+           options.value_pipes.end();
+}
+
 void Generator::dump_header_reading(const ncdlgen::Group& group,
                                     const std::string_view fully_qualified_struct_name)
 {
     for (auto& serialisation_pipe : options.serialisation_pipes)
     {
-        fmt::print("void read({}::{}& pipe, {}&);\n\n", options.ncdlgen_namespace, serialisation_pipe,
-                   fully_qualified_struct_name);
+        fmt::print("void read({}& pipe, {}&);\n\n",
+                   pipe_type(serialisation_pipe, fully_qualified_struct_name), fully_qualified_struct_name);
     }
 
     for (auto& sub_group : group.groups())
@@ -69,8 +251,14 @@ void Generator::dump_header_writing(const ncdlgen::Group& group,
 {
     for (auto& serialisation_pipe : options.serialisation_pipes)
     {
-        fmt::print("void write({}::{}& pipe, const {}&);\n\n", options.ncdlgen_namespace, serialisation_pipe,
-                   fully_qualified_struct_name);
+        fmt::print("void write({}& pipe, const {}&);\n\n",
+                   pipe_type(serialisation_pipe, fully_qualified_struct_name), fully_qualified_struct_name);
+        if (is_value_pipe(serialisation_pipe))
+        {
+            fmt::print("void write({}& pipe, {}&&);\n\n",
+                       pipe_type(serialisation_pipe, fully_qualified_struct_name),
+                       fully_qualified_struct_name);
+        }
     }
     for (auto& sub_group : group.groups())
     {
@@ -79,16 +267,55 @@ void Generator::dump_header_writing(const ncdlgen::Group& group,
     }
 }
 
+void Generator::dump_header_writing_view(const ncdlgen::Group& group,
+                                         const std::string_view fully_qualified_struct_name)
+{
+    // The pipes of whole structs have no views to write
+    for (auto& serialisation_pipe : options.serialisation_pipes)
+    {
+        if (!is_value_pipe(serialisation_pipe))
+        {
+            fmt::print("void write({}& pipe, const {}&);\n\n",
+                       pipe_type(serialisation_pipe, fully_qualified_struct_name),
+                       fully_qualified_struct_name);
+        }
+    }
+    for (auto& sub_group : group.groups())
+    {
+        auto sub_group_name = fmt::format("{}::{}", fully_qualified_struct_name, sub_group.name());
+        dump_header_writing_view(sub_group, sub_group_name);
+    }
+}
+
 void Generator::dump_header_namespace(const ncdlgen::Group& group)
 {
     fmt::print("namespace {} {{\n\n", options.generated_namespace);
 
     dump_header(group, 0);
 
+    if (options.lazy_structs && has_pipe("NetCDFPipe"))
+    {
+        dump_header_lazy(group, "", fmt::format("lazy_{}", group.name()), 0);
+    }
+
+    fmt::print("const {}::Schema& {}_schema();\n\n", options.ncdlgen_namespace, group.name());
+
     dump_header_reading(group, group.name());
 
     dump_header_writing(group, group.name());
 
+    if (options.view_structs)
+    {
+        auto view_name = fmt::format("view_{}", group.name());
+        dump_header_view(group, view_name, 0);
+        dump_header_writing_view(group, view_name);
+    }
+
+    if (has_pipe("NetCDFPipe"))
+    {
+        dump_header_read_records(group, group.name());
+    }
+
     fmt::print("}};\n");
 }
 
@@ -100,17 +327,27 @@ void Generator::dump_source_read_group(const ncdlgen::Group& group, const std::s
 
     for (auto& serialisation_pipe : options.serialisation_pipes)
     {
-        fmt::print("void {}::read({}::{}& pipe, {}& {})\n{{\n", name_space_root, options.ncdlgen_namespace,
-                   serialisation_pipe, fully_qualified_struct_name, group.name());
+        fmt::print("void {}::read({}& pipe, {}& {})\n{{\n", name_space_root,
+                   pipe_type(serialisation_pipe, fully_qualified_struct_name), fully_qualified_struct_name,
+                   group.name());
+
+        // The whole struct is moved out of the pipe
+        if (is_value_pipe(serialisation_pipe))
+        {
+            fmt::print("    pipe.read({});\n", group.name());
+            fmt::print("}}\n\n");
+            continue;
+        }
 
         for (auto& variable : group.variables())
         {
             auto full_path = fmt::format("{}/{}", group_path, variable.name());
-            auto container_type_name = options.container_for_dimensions(
-                cpp_name_for_type(variable.basic_type()), variable.dimensions());
-            fmt::print("    {}.{} = pipe.read<{}, {}, {}::{}>(\"{}\");\n", group.name(), variable.name(),
-                       container_type_name, cpp_name_for_type(variable.basic_type()),
-                       options.ncdlgen_namespace, options.array_interface, full_path);
+            auto container_type = container_type_name(variable);
+            // The existing capacity of the members is reused
+            fmt::print("    pipe.read_into<{}, {}, {}::{}>({{{}, \"{}\"}}, {}.{});\n", container_type,
+                       cpp_name_for_type(variable.basic_type()), options.ncdlgen_namespace,
+                       options.array_interface, field_ids.at(full_path), full_path, group.name(),
+                       variable.name());
         }
 
         for (auto& sub_group : group.groups())
@@ -135,17 +372,32 @@ void Generator::dump_source_write_group(const ncdlgen::Group& group, const std::
 
     for (auto& serialisation_pipe : options.serialisation_pipes)
     {
-        fmt::print("void {}::write({}::{}& pipe, const {}& data)\n{{\n", name_space_root,
-                   options.ncdlgen_namespace, serialisation_pipe, fully_qualified_struct_name);
+        fmt::print("void {}::write({}& pipe, const {}& data)\n{{\n", name_space_root,
+                   pipe_type(serialisation_pipe, fully_qualified_struct_name), fully_qualified_struct_name);
+
+        // The whole struct is copied or moved to the pipe
+        if (is_value_pipe(serialisation_pipe))
+        {
+            fmt::print("    pipe.write(data);\n");
+            fmt::print("}}\n\n");
+            fmt::print("void {}::write({}& pipe, {}&& data)\n{{\n", name_space_root,
+                       pipe_type(serialisation_pipe, fully_qualified_struct_name),
+                       fully_qualified_struct_name);
+            fmt::print("    pipe.write(std::move(data));\n");
+            fmt::print("}}\n\n");
+            continue;
+        }
+
+        // Let the pipe send the whole record at once, a failed write discards the record
+        fmt::print("    {}::RecordScope record{{pipe}};\n", options.ncdlgen_namespace);
 
         for (auto& variable : group.variables())
         {
             auto full_path = fmt::format("{}/{}", group_path, variable.name());
-            auto container_type_name = options.container_for_dimensions(
-                cpp_name_for_type(variable.basic_type()), variable.dimensions());
-            fmt::print("    pipe.write<{}, {}, {}::{}>(\"{}\", data.{});\n", container_type_name,
+            auto container_type = container_type_name(variable);
+            fmt::print("    pipe.write<{}, {}, {}::{}>({{{}, \"{}\"}}, data.{});\n", container_type,
                        cpp_name_for_type(variable.basic_type()), options.ncdlgen_namespace,
-                       options.array_interface, full_path, variable.name());
+                       options.array_interface, field_ids.at(full_path), full_path, variable.name());
         }
 
         for (auto& sub_group : group.groups())
@@ -153,6 +405,7 @@ void Generator::dump_source_write_group(const ncdlgen::Group& group, const std::
             fmt::print("    {}::write(pipe, data.{}_g);\n", name_space_name, sub_group.name());
         }
 
+        fmt::print("    record.end();\n");
         fmt::print("}}\n\n");
     }
 
@@ -163,15 +416,224 @@ void Generator::dump_source_write_group(const ncdlgen::Group& group, const std::
     }
 }
 
+void Generator::dump_source_write_view_group(const ncdlgen::Group& group, const std::string_view group_path,
+                                             const std::string_view name_space_name,
+                                             const std::string_view struct_name)
+{
+    auto fully_qualified_struct_name = fmt::format("{}::{}", name_space_name, struct_name);
+    auto name_space_root = split_string(name_space_name, ':').at(0);
+
+    for (auto& serialisation_pipe : options.serialisation_pipes)
+    {
+        if (is_value_pipe(serialisation_pipe))
+        {
+            continue;
+        }
+
+        fmt::print("void {}::write({}& pipe, const {}& data)\n{{\n", name_space_root,
+                   pipe_type(serialisation_pipe, fully_qualified_struct_name), fully_qualified_struct_name);
+        fmt::print("    {}::RecordScope record{{pipe}};\n", options.ncdlgen_namespace);
+
+        // The spans are written straight from the memory they view
+        for (auto& variable : group.variables())
+        {
+            auto full_path = fmt::format("{}/{}", group_path, variable.name());
+            auto element_type_name = cpp_name_for_type(variable.basic_type());
+            if (variable.dimensions().empty())
+            {
+                fmt::print("    pipe.write<{}, {}, {}::{}>({{{}, \"{}\"}}, data.{});\n", element_type_name,
+                           element_type_name, options.ncdlgen_namespace, options.array_interface,
+                           field_ids.at(full_path), full_path, variable.name());
+                continue;
+            }
+            fmt::print("    pipe.write<{}::ArraySpan<{}, {}>, {}, {}::ArraySpanInterface>({{{}, \"{}\"}}, "
+                       "data.{});\n",
+                       options.ncdlgen_namespace, element_type_name, variable.dimensions().size(),
+                       element_type_name, options.ncdlgen_namespace, field_ids.at(full_path), full_path,
+                       variable.name());
+        }
+
+        for (auto& sub_group : group.groups())
+        {
+            fmt::print("    {}::write(pipe, data.{}_g);\n", name_space_root, sub_group.name());
+        }
+
+        fmt::print("    record.end();\n");
+        fmt::print("}}\n\n");
+    }
+
+    for (auto& sub_group : group.groups())
+    {
+        auto sub_group_path = fmt::format("{}/{}", group_path, sub_group.name());
+        dump_source_write_view_group(sub_group, sub_group_path, fully_qualified_struct_name,
+                                     sub_group.name());
+    }
+}
+
+bool Generator::collect_fields(const ncdlgen::Group& group, const std::string_view group_path,
+                               std::unordered_map<std::string, std::size_t> visible_dimensions)
+{
+    // The dimensions of the group hide the dimensions of the same name of the parent groups
+    for (auto& dimension : group.dimensions())
+    {
+        visible_dimensions[dimension.name] = dimension.length;
+    }
+
+    // The ids follow the order of the variables in the cdl
+    bool has_records{};
+    for (auto& variable : group.variables())
+    {
+        auto full_path = fmt::format("{}/{}", group_path, variable.name());
+        field_ids[full_path] = static_cast<std::uint32_t>(field_paths.size());
+        field_paths.push_back(full_path);
+
+        // The unlimited and the unknown dimensions have the length 0
+        auto& lengths = dimension_lengths[&variable];
+        for (auto& dimension : variable.dimensions())
+        {
+            auto visible_dimension = visible_dimensions.find(std::string(dimension.name()));
+            lengths.push_back(visible_dimension != visible_dimensions.end() ? visible_dimension->second : 0);
+        }
+
+        auto& dimensions = variable.dimensions();
+        if (!dimensions.empty() && visible_dimensions.count(std::string(dimensions.front().name())) > 0 &&
+            lengths.front() == 0)
+        {
+            record_paths.insert(full_path);
+            has_records = true;
+        }
+    }
+
+    for (auto& sub_group : group.groups())
+    {
+        auto sub_group_path = fmt::format("{}/{}", group_path, sub_group.name());
+        has_records |= collect_fields(sub_group, sub_group_path, visible_dimensions);
+    }
+
+    if (has_records)
+    {
+        record_groups.insert(&group);
+    }
+    return has_records;
+}
+
+std::string Generator::container_type_name(const ncdlgen::Variable& variable) const
+{
+    auto element_type_name = cpp_name_for_type(variable.basic_type());
+    if (options.container_for_dimension_lengths)
+    {
+        return options.container_for_dimension_lengths(element_type_name, variable.dimensions(),
+                                                       dimension_lengths.at(&variable));
+    }
+    return options.container_for_dimensions(element_type_name, variable.dimensions());
+}
+
+bool Generator::has_pipe(const std::string_view pipe) const
+{
+    return std::find(options.serialisation_pipes.begin(), options.serialisation_pipes.end(), pipe) !=
+           options.serialisation_pipes.end();
+}
+
+void Generator::dump_header_read_records(const ncdlgen::Group& group,
+                                         const std::string_view fully_qualified_struct_name)
+{
+    if (record_groups.count(&group) == 0)
+    {
+        return;
+    }
+
+    fmt::print("void read_records({}::NetCDFPipe& pipe, {}&, std::size_t start, std::size_t count);\n\n",
+               options.ncdlgen_namespace, fully_qualified_struct_name);
+
+    for (auto& sub_group : group.groups())
+    {
+        auto sub_group_name = fmt::format("{}::{}", fully_qualified_struct_name, sub_group.name());
+        dump_header_read_records(sub_group, sub_group_name);
+    }
+}
+
+void Generator::dump_source_read_records(const ncdlgen::Group& group, const std::string_view group_path,
+                                         const std::string_view name_space_name)
+{
+    if (record_groups.count(&group) == 0)
+    {
+        return;
+    }
+
+    auto fully_qualified_struct_name = fmt::format("{}::{}", name_space_name, group.name());
+    auto name_space_root = split_string(name_space_name, ':').at(0);
+
+    fmt::print("void {}::read_records({}::NetCDFPipe& pipe, {}& {}, std::size_t start, "
+               "std::size_t count)\n{{\n",
+               name_space_root, options.ncdlgen_namespace, fully_qualified_struct_name, group.name());
+
+    for (auto& variable : group.variables())
+    {
+        auto full_path = fmt::format("{}/{}", group_path, variable.name());
+        if (record_paths.count(full_path) == 0)
+        {
+            continue;
+        }
+        auto container_type = container_type_name(variable);
+        fmt::print("    {}.{} = pipe.read_records<{}, {}, {}::{}>({{{}, \"{}\"}}, start, count);\n",
+                   group.name(), variable.name(), container_type,
+                   cpp_name_for_type(variable.basic_type()), options.ncdlgen_namespace,
+                   options.array_interface, field_ids.at(full_path), full_path);
+    }
+
+    for (auto& sub_group : group.groups())
+    {
+        if (record_groups.count(&sub_group) > 0)
+        {
+            fmt::print("    {}::read_records(pipe, {}.{}_g, start, count);\n", name_space_name, group.name(),
+                       sub_group.name());
+        }
+    }
+    fmt::print("}}\n\n");
+
+    for (auto& sub_group : group.groups())
+    {
+        auto sub_group_path = fmt::format("{}/{}", group_path, sub_group.name());
+        dump_source_read_records(sub_group, sub_group_path, fully_qualified_struct_name);
+    }
+}
+
+void Generator::dump_source_schema(const ncdlgen::Group& group)
+{
+    fmt::print("const {}::Schema& {}::{}_schema()\n{{\n", options.ncdlgen_namespace,
+               options.generated_namespace, group.name());
+    fmt::print("    static const {}::Schema schema{{0x{:016x}, {{", options.ncdlgen_namespace,
+               fingerprint(group));
+    for (std::size_t i = 0; i < field_paths.size(); i++)
+    {
+        fmt::print("{}\"{}\"", i == 0 ? "" : ", ", field_paths[i]);
+    }
+    fmt::print("}}}};\n");
+    fmt::print("    return schema;\n}}\n\n");
+}
+
 void Generator::dump_source(const ncdlgen::Group& group, const std::string_view group_path)
 {
     fmt::print("#include \"{}.h\"\n\n", options.header_name);
 
+    dump_source_schema(group);
+
     // writing
     dump_source_write_group(group, group_path, options.generated_namespace);
 
+    if (options.view_structs)
+    {
+        dump_source_write_view_group(group, group_path, options.generated_namespace,
+                                     fmt::format("view_{}", group.name()));
+    }
+
     // reading
     dump_source_read_group(group, group_path, options.generated_namespace);
+
+    if (has_pipe("NetCDFPipe"))
+    {
+        dump_source_read_records(group, group_path, options.generated_namespace);
+    }
 }
 
 void Generator::dump_source_headers(const ncdlgen::Group& group)
@@ -216,6 +678,7 @@ void Generator::generate(const std::string_view input_cdl)
     // ast->print_tree();
 
     auto& group = *(ast->group);
+    collect_fields(group, "");
     if (options.target == GenerateTarget::Header)
     {
         dump_source_headers(group);
@@ -1,9 +1,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "syntax.h"
 
@@ -16,6 +19,29 @@ struct DefaultCustomisation
                                                 const std::vector<ncdlgen::VariableDimension>& dimensions);
 };
 
+// The contiguous NDArray containers of the NDArrayInterface
+struct NDArrayCustomisation
+{
+    static std::string container_for_dimensions(const std::string_view& element_type_name,
+                                                const std::vector<ncdlgen::VariableDimension>& dimensions);
+};
+
+// The std::pmr::vector containers of the VectorInterface, allocated from a memory resource
+struct PmrCustomisation
+{
+    static std::string container_for_dimensions(const std::string_view& element_type_name,
+                                                const std::vector<ncdlgen::VariableDimension>& dimensions);
+};
+
+// The FixedArray containers of the FixedArrayInterface for the fixed length dimensions
+struct FixedArrayCustomisation
+{
+    static std::string
+    container_for_dimension_lengths(const std::string_view& element_type_name,
+                                    const std::vector<ncdlgen::VariableDimension>& dimensions,
+                                    const std::vector<std::size_t>& lengths);
+};
+
 class Generator
 {
   public:
@@ -32,13 +58,28 @@ class Generator
         std::string generated_namespace{"generated"};
         std::string ncdlgen_namespace{"ncdlgen"};
         std::vector<std::string> serialisation_pipes{"NetCDFPipe"};
+        // The pipes that hand over whole structs, with a pipe type per struct
+        std::vector<std::string> value_pipes{"InProcessPipe"};
+        // The interface of the containers, see container_for_dimensions
         std::string array_interface{"VectorInterface"};
+        // Generate the lazy structs that read the variables from the NetCDFPipe on the first access
+        bool lazy_structs{false};
+        // Generate the constructors of the structs that construct the containers with a
+        // std::pmr::memory_resource, see PmrCustomisation
+        bool memory_resource_constructors{false};
+        // Generate the view structs of spans over caller-owned memory, and their writes
+        bool view_structs{false};
         std::vector<std::string> base_headers{"stdint.h"};
         std::vector<std::string> pipe_headers{"pipes/netcdf_pipe.h"};
         std::vector<std::string> library_headers{"<vector>"};
         std::vector<std::string> interface_headers{"vector_interface.h"};
         std::function<std::string(const std::string_view&, const std::vector<ncdlgen::VariableDimension>&)>
             container_for_dimensions{DefaultCustomisation::container_for_dimensions};
+        // Optional, used instead of container_for_dimensions when set. The lengths
+        // of the unlimited dimensions are 0.
+        std::function<std::string(const std::string_view&, const std::vector<ncdlgen::VariableDimension>&,
+                                  const std::vector<std::size_t>&)>
+            container_for_dimension_lengths{};
     };
 
     Generator(Options options) : options(std::move(options)) {}
@@ -48,20 +89,62 @@ class Generator
   private:
     // header
     void dump_header(const ncdlgen::Group& group, int indent);
+    void dump_header_memory_resource_constructors(const ncdlgen::Group& group, int indent);
     void dump_header_reading(const ncdlgen::Group& group, const std::string_view fully_qualified_struct_name);
     void dump_header_writing(const ncdlgen::Group& group, const std::string_view fully_qualified_struct_name);
     void dump_header_namespace(const ncdlgen::Group& group);
+    void dump_header_lazy(const ncdlgen::Group& group, const std::string_view group_path,
+                          const std::string_view struct_name, int indent);
+    void dump_header_view(const ncdlgen::Group& group, const std::string_view struct_name, int indent);
+    void dump_header_writing_view(const ncdlgen::Group& group,
+                                  const std::string_view fully_qualified_struct_name);
 
     // source
     void dump_source_read_group(const ncdlgen::Group& group, const std::string_view group_path,
                                 const std::string_view name_space_name);
     void dump_source_write_group(const ncdlgen::Group& group, const std::string_view group_path,
                                  const std::string_view name_space_name);
+    void dump_source_write_view_group(const ncdlgen::Group& group, const std::string_view group_path,
+                                      const std::string_view name_space_name,
+                                      const std::string_view struct_name);
     void dump_source(const ncdlgen::Group& group, const std::string_view group_path);
     void dump_source_headers(const ncdlgen::Group& group);
+    void dump_source_schema(const ncdlgen::Group& group);
+
+    // The pipe type in the generated functions for the struct
+    std::string pipe_type(const std::string_view pipe, const std::string_view struct_name) const;
+    bool is_value_pipe(const std::string_view pipe) const;
+
+    // Assign the field ids of the variables, resolve the lengths of their
+    // dimensions, and find the record variables of the unlimited dimensions
+    // visible to the group. Returns whether the group or its sub groups have
+    // record variables.
+    bool collect_fields(const ncdlgen::Group& group, const std::string_view group_path,
+                        std::unordered_map<std::string, std::size_t> visible_dimensions = {});
+
+    // The container of the variable, see Options::container_for_dimensions
+    std::string container_type_name(const ncdlgen::Variable& variable) const;
+
+    // Read a range of records of the record variables
+    void dump_header_read_records(const ncdlgen::Group& group,
+                                  const std::string_view fully_qualified_struct_name);
+    void dump_source_read_records(const ncdlgen::Group& group, const std::string_view group_path,
+                                  const std::string_view name_space_name);
+    bool has_pipe(const std::string_view pipe) const;
 
     // options
     Options options{};
+
+    // The field ids by the full variable path, and the paths by the id
+    std::unordered_map<std::string, std::uint32_t> field_ids{};
+    std::vector<std::string> field_paths{};
+
+    // The variables whose first dimension is unlimited, and the groups that have them
+    std::unordered_set<std::string> record_paths{};
+    std::unordered_set<const ncdlgen::Group*> record_groups{};
+
+    // The lengths of the dimensions of the variables, 0 for the unlimited dimensions
+    std::unordered_map<const ncdlgen::Variable*, std::vector<std::size_t>> dimension_lengths{};
 };
 
 } // namespace ncdlgen
@@ -10,36 +10,76 @@ using namespace ncdlgen;
 
 void generate(const std::string& input_cdl, Generator::GenerateTarget target,
               const std::vector<std::string>& target_pipes, const std::string& interface_name,
-              const std::string& namespace_name, bool use_library_include)
+              const std::string& namespace_name, const std::string& array_interface, bool use_library_include,
+              bool lazy_structs, bool pmr_containers, bool view_structs)
 {
     // The pipe includes for internal use in ncdlgen
     std::unordered_map<std::string, std::string> supported_pipes = {
         {"NetCDFPipe", "\"pipes/netcdf_pipe.h\""},
         {"ZeroMQPipe", "\"pipes/zeromq_pipe.h\""},
+        {"SharedMemoryPipe", "\"pipes/shared_memory_pipe.h\""},
+        {"InProcessPipe", "\"pipes/in_process_pipe.h\""},
     };
 
     // The pipe includes when using ncdlgen as library
     std::unordered_map<std::string, std::string> supported_library_pipes = {
         {"NetCDFPipe", "<ncdlgen/netcdf_pipe.h>"},
         {"ZeroMQPipe", "<ncdlgen/zeromq_pipe.h>"},
+        {"SharedMemoryPipe", "<ncdlgen/shared_memory_pipe.h>"},
+        {"InProcessPipe", "<ncdlgen/in_process_pipe.h>"},
     };
 
     // Support internal and external use
     auto& pipes = use_library_include ? supported_library_pipes : supported_pipes;
 
     // The interface includes for internal use in ncdlgen
-    std::vector<std::string> supported_interfaces = {"\"vector_interface.h\""};
+    std::unordered_map<std::string, std::string> supported_interfaces = {
+        {"VectorInterface", "\"vector_interface.h\""},
+        {"NDArrayInterface", "\"nd_array_interface.h\""},
+        {"FixedArrayInterface", "\"fixed_array_interface.h\""},
+    };
 
     // The interface includes when using ncdlgen as library
-    std::vector<std::string> supported_library_interfaces = {"<ncdlgen/vector_interface.h>"};
+    std::unordered_map<std::string, std::string> supported_library_interfaces = {
+        {"VectorInterface", "<ncdlgen/vector_interface.h>"},
+        {"NDArrayInterface", "<ncdlgen/nd_array_interface.h>"},
+        {"FixedArrayInterface", "<ncdlgen/fixed_array_interface.h>"},
+    };
 
     // Support internal and external use
-    auto interfaces = use_library_include ? supported_library_interfaces : supported_interfaces;
+    auto& interfaces = use_library_include ? supported_library_interfaces : supported_interfaces;
+    if (interfaces.find(array_interface) == interfaces.end())
+    {
+        throw std::runtime_error(
+            fmt::format("Interface Generator: Unsupported array interface {}.", array_interface));
+    }
 
     Generator::Options options{
         .target = target, .header_name = interface_name, .generated_namespace = namespace_name};
 
-    options.interface_headers = interfaces;
+    options.interface_headers = {interfaces.at(array_interface)};
+    options.array_interface = array_interface;
+    if (array_interface == "NDArrayInterface")
+    {
+        options.container_for_dimensions = NDArrayCustomisation::container_for_dimensions;
+    }
+    else if (array_interface == "FixedArrayInterface")
+    {
+        options.container_for_dimension_lengths = FixedArrayCustomisation::container_for_dimension_lengths;
+    }
+
+    // The std::pmr::vector members are allocated from the resource given to the structs
+    if (pmr_containers)
+    {
+        if (array_interface != "VectorInterface")
+        {
+            throw std::runtime_error(fmt::format(
+                "Interface Generator: --pmr_containers is not supported with {}.", array_interface));
+        }
+        options.container_for_dimensions = PmrCustomisation::container_for_dimensions;
+        options.memory_resource_constructors = true;
+        options.library_headers = {"<memory_resource>", "<vector>"};
+    }
     options.serialisation_pipes = target_pipes;
     options.pipe_headers = {};
     for (auto& pipe : target_pipes)
@@ -51,6 +91,22 @@ void generate(const std::string& input_cdl, Generator::GenerateTarget target,
         options.pipe_headers.push_back(pipes.at(pipe));
     }
 
+    // The lazy structs read through the NetCDFPipe
+    options.lazy_structs = lazy_structs;
+    if (lazy_structs)
+    {
+        options.pipe_headers.push_back(use_library_include ? "<ncdlgen/lazy_field.h>"
+                                                           : "\"pipes/lazy_field.h\"");
+    }
+
+    // The view structs write the arrays through spans of the memory of the caller
+    options.view_structs = view_structs;
+    if (view_structs)
+    {
+        options.interface_headers.push_back(use_library_include ? "<ncdlgen/array_span_interface.h>"
+                                                                : "\"array_span_interface.h\"");
+    }
+
     Generator generator{options};
 
     auto contents = read_file(input_cdl);
@@ -69,19 +125,33 @@ int main(int argc, char** argv)
     std::vector<std::string> target_pipes = {"NetCDFPipe", "ZeroMQPipe"};
     std::string interface_name{};
     std::string namespace_name{"ncdlgen"};
+    std::string array_interface{"VectorInterface"};
     bool use_library_include{};
+    bool lazy_structs{};
+    bool pmr_containers{};
+    bool view_structs{};
 
     app.add_option("interface_cdl", interface_cdl, "The input .cdl file path")->required();
     app.add_flag("--header", create_header, "Create the interface header");
     app.add_flag("--source", create_source, "Create the interface header");
     app.add_option("--target_pipes", target_pipes,
-                   "Create interfaces for specific pipes (NetCDFPipe, ZeroMQPipe).")
+                   "Create interfaces for specific pipes (NetCDFPipe, ZeroMQPipe, SharedMemoryPipe, "
+                   "InProcessPipe).")
         ->expected(0, -1);
     app.add_option("--interface_class_name", interface_name, "The name of the generated interface class");
     app.add_option("--interface_namespace_name", namespace_name,
                    "The name of the namespace of generated interface");
+    app.add_option("--array_interface", array_interface,
+                   "The containers of the arrays (VectorInterface, NDArrayInterface, FixedArrayInterface)");
     app.add_flag("--use_library_include", use_library_include,
                  "Include files as '<ncdlgen/interface.h> (true) or 'interface.h' (false)");
+    app.add_flag("--lazy_structs", lazy_structs,
+                 "Create the lazy structs that read the variables from NetCDF on the first access");
+    app.add_flag("--pmr_containers", pmr_containers,
+                 "Use std::pmr::vector for the arrays, and create the struct constructors that take the "
+                 "std::pmr::memory_resource");
+    app.add_flag("--view_structs", view_structs,
+                 "Create the view structs of spans over the memory of the caller, and the writes of them");
 
     CLI11_PARSE(app, argc, argv);
 
@@ -94,12 +164,14 @@ int main(int argc, char** argv)
     if (create_header)
     {
         generate(interface_cdl, Generator::GenerateTarget::Header, target_pipes, interface_name,
-                 namespace_name, use_library_include);
+                 namespace_name, array_interface, use_library_include, lazy_structs, pmr_containers,
+                 view_structs);
     }
     if (create_source)
     {
         generate(interface_cdl, Generator::GenerateTarget::Source, target_pipes, interface_name,
-                 namespace_name, use_library_include);
+                 namespace_name, array_interface, use_library_include, lazy_structs, pmr_containers,
+                 view_structs);
     }
 
     return 0;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "interface.h"
+#include "vector_interface.h"
+
+namespace ncdlgen
+{
+
+/**
+ * A read-only view of N-dimensional data in memory owned by the caller, e.g. a
+ * camera frame or a DMA ring slot, in the spirit of std::span
+ *
+ * The viewed elements are contiguous in row-major order. The span does not own
+ * the elements, and is valid as long as the viewed buffer. The pipes write the
+ * elements straight from the viewed buffer, without an intermediate container.
+ * Spans are only written, reading needs a container that owns its elements.
+ */
+template <typename ElementType, std::size_t Rank> class ArraySpan
+{
+  public:
+    static_assert(Rank > 0, "ArraySpan needs at least one dimension, use the element type for scalars");
+
+    using value_type = ElementType;
+    using const_iterator = const ElementType*;
+
+    static constexpr std::size_t rank = Rank;
+
+    ArraySpan() = default;
+    ArraySpan(const ElementType* data, const std::array<std::size_t, Rank>& shape)
+        : m_data(data), m_shape(shape), m_size(number_of_elements(shape))
+    {
+    }
+    template <std::size_t R = Rank, std::enable_if_t<R == 1, bool> = true>
+    ArraySpan(const ElementType* data, std::size_t size) : m_data(data), m_shape{size}, m_size(size)
+    {
+    }
+
+    /**
+     * View the elements of a contiguous container, e.g. a std::vector, in the given shape
+     */
+    template <typename ContainerType,
+              std::enable_if_t<std::is_same_v<typename ContainerType::value_type, ElementType>, bool> = true>
+    ArraySpan(const ContainerType& container, const std::array<std::size_t, Rank>& shape)
+        : ArraySpan(container.data(), shape)
+    {
+        if (container.size() != m_size)
+        {
+            throw std::runtime_error(fmt::format(
+                "ArraySpan: {} elements do not match the shape of {} elements.", container.size(), m_size));
+        }
+    }
+
+    const ElementType* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const std::array<std::size_t, Rank>& shape() const { return m_shape; }
+    std::size_t extent(std::size_t dimension) const { return m_shape[dimension]; }
+
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+
+    std::vector<std::size_t> dimension_sizes() const { return {m_shape.begin(), m_shape.end()}; }
+
+  private:
+    static std::size_t number_of_elements(const std::array<std::size_t, Rank>& shape)
+    {
+        std::size_t number_of_elements{1};
+        for (auto dimension_size : shape)
+        {
+            number_of_elements *= dimension_size;
+        }
+        return number_of_elements;
+    }
+
+    const ElementType* m_data{};
+    std::array<std::size_t, Rank> m_shape{};
+    std::size_t m_size{};
+};
+
+namespace ArraySpanOperations
+{
+
+template <typename T> struct is_array_span : std::false_type
+{
+};
+
+template <typename ElementType, std::size_t Rank>
+struct is_array_span<ArraySpan<ElementType, Rank>> : std::true_type
+{
+};
+
+template <typename T> inline constexpr bool is_array_span_v = is_array_span<T>::value;
+
+static_assert(is_array_span_v<ArraySpan<float, 2>>);
+static_assert(!is_array_span_v<std::vector<float>>);
+
+} // namespace ArraySpanOperations
+
+/**
+ * The interface of ArraySpan, the viewed buffer is written as is. The shape
+ * is taken from the span.
+ */
+struct ArraySpanInterface
+{
+    template <typename ElementType, typename ContainerType,
+              std::enable_if_t<ArraySpanOperations::is_array_span_v<ContainerType>, bool> = true>
+    static constexpr bool is_supported_ndarray()
+    {
+        return true;
+    };
+
+    template <typename ElementType, typename ContainerType> static constexpr bool is_contiguous()
+    {
+        if constexpr (ArraySpanOperations::is_array_span_v<ContainerType>)
+        {
+            return std::is_same_v<ElementType, typename ContainerType::value_type>;
+        }
+        return false;
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static std::vector<std::size_t> dimension_sizes(const ContainerType& data)
+    {
+        return data.dimension_sizes();
+    }
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "interface.h"
+#include "vector_interface.h"
+
+namespace ncdlgen
+{
+
+/**
+ * An N-dimensional array with the dimension sizes known at compile time
+ *
+ * The generator uses FixedArray for the variables whose dimensions all have a
+ * fixed length in the CDL. The elements are stored inline in row-major order,
+ * so reading and writing the array never allocates or resizes, and the shape
+ * is not stored per instance. FixedArray is an aggregate:
+ *
+ *     FixedArray<int, 2, 3> array{{1, 2, 3, 4, 5, 6}};
+ */
+template <typename ElementType, std::size_t... Dimensions> struct FixedArray
+{
+    static_assert(sizeof...(Dimensions) > 0,
+                  "FixedArray needs at least one dimension, use the element type for scalars");
+
+    using value_type = ElementType;
+    using iterator = ElementType*;
+    using const_iterator = const ElementType*;
+
+    static constexpr std::size_t rank = sizeof...(Dimensions);
+    static constexpr std::array<std::size_t, rank> shape{Dimensions...};
+    static constexpr std::size_t number_of_elements = (Dimensions * ...);
+
+    std::array<ElementType, number_of_elements> elements{};
+
+    ElementType* data() { return elements.data(); }
+    const ElementType* data() const { return elements.data(); }
+    static constexpr std::size_t size() { return number_of_elements; }
+    static constexpr bool empty() { return number_of_elements == 0; }
+    static constexpr std::size_t extent(std::size_t dimension) { return shape[dimension]; }
+
+    iterator begin() { return elements.data(); }
+    iterator end() { return elements.data() + number_of_elements; }
+    const_iterator begin() const { return elements.data(); }
+    const_iterator end() const { return elements.data() + number_of_elements; }
+
+    template <typename... Indices> ElementType& operator()(Indices... indices)
+    {
+        return elements[offset(indices...)];
+    }
+    template <typename... Indices> const ElementType& operator()(Indices... indices) const
+    {
+        return elements[offset(indices...)];
+    }
+
+    std::vector<std::size_t> dimension_sizes() const { return {shape.begin(), shape.end()}; }
+
+    bool operator==(const FixedArray& other) const { return elements == other.elements; }
+    bool operator!=(const FixedArray& other) const { return !(*this == other); }
+
+  private:
+    template <typename... Indices> static constexpr std::size_t offset(Indices... indices)
+    {
+        static_assert(sizeof...(Indices) == rank, "One index is needed for each dimension");
+        std::size_t dimension{};
+        std::size_t index{};
+        ((index = index * shape[dimension++] + static_cast<std::size_t>(indices)), ...);
+        return index;
+    }
+};
+
+namespace FixedArrayOperations
+{
+
+template <typename T> struct is_fixed_array : std::false_type
+{
+};
+
+template <typename ElementType, std::size_t... Dimensions>
+struct is_fixed_array<FixedArray<ElementType, Dimensions...>> : std::true_type
+{
+};
+
+template <typename T> inline constexpr bool is_fixed_array_v = is_fixed_array<T>::value;
+
+static_assert(is_fixed_array_v<FixedArray<float, 5, 5>>);
+static_assert(!is_fixed_array_v<std::vector<float>>);
+static_assert(sizeof(FixedArray<float, 5, 5>) == 25 * sizeof(float), "The shape is not stored per instance");
+
+/**
+ * The shape is fixed, the dimension sizes of the data have to match it
+ */
+template <typename ContainerType> void check_shape(const std::vector<std::size_t>& dimension_sizes)
+{
+    if (dimension_sizes.size() != ContainerType::rank)
+    {
+        throw std::runtime_error(
+            fmt::format("FixedArrayInterface: {} dimensions do not match the {} dimensions of the array.",
+                        dimension_sizes.size(), ContainerType::rank));
+    }
+    for (std::size_t i = 0; i < ContainerType::rank; i++)
+    {
+        if (dimension_sizes[i] != ContainerType::shape[i])
+        {
+            throw std::runtime_error(fmt::format(
+                "FixedArrayInterface: The size {} of the dimension {} does not match the fixed size {}.",
+                dimension_sizes[i], i, ContainerType::shape[i]));
+        }
+    }
+}
+
+} // namespace FixedArrayOperations
+
+/**
+ * The interface of FixedArray, the array is read and written directly from
+ * its inline buffer. The nested std::vectors of the variables with unlimited
+ * dimensions are handled as in VectorInterface, so the generated structs can
+ * mix both.
+ */
+struct FixedArrayInterface
+{
+    template <typename ElementType, typename ContainerType,
+              std::enable_if_t<FixedArrayOperations::is_fixed_array_v<ContainerType> ||
+                                   VectorOperations::is_vector_v<ContainerType>,
+                               bool> = true>
+    static constexpr bool is_supported_ndarray()
+    {
+        return true;
+    };
+
+    template <typename ElementType, typename ContainerType> static constexpr bool is_contiguous()
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            static_assert(std::is_trivially_copyable_v<ElementType>,
+                          "FixedArray elements are copied bytewise");
+            return std::is_same_v<ElementType, typename ContainerType::value_type>;
+        }
+        else
+        {
+            return VectorInterface::is_contiguous<ElementType, ContainerType>();
+        }
+    }
+
+    /**
+     * The shape of the array is known at compile time
+     */
+    template <typename ElementType, typename ContainerType>
+    static std::vector<std::size_t> dimension_sizes(const ContainerType& data)
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            return data.dimension_sizes();
+        }
+        else
+        {
+            return VectorOperations::container_dimension_sizes<ElementType, ContainerType>(data);
+        }
+    }
+
+    /**
+     * Only the nested std::vectors are flattened, FixedArray is contiguous
+     */
+    template <typename ElementType, typename ContainerType,
+              std::enable_if_t<VectorOperations::is_vector_v<ContainerType>, bool> = true>
+    static Data<ElementType> prepare(const ContainerType& data)
+    {
+        return VectorInterface::prepare<ElementType, ContainerType>(data);
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static Data<ElementType> prepare(const std::vector<std::size_t>& dimension_sizes)
+    {
+        return VectorInterface::prepare<ElementType, ContainerType>(dimension_sizes);
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static void finalise(ContainerType& output, const Data<ElementType>& data)
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            copy_from<ElementType, ContainerType>(output, data.data.data(), data.dimension_sizes);
+        }
+        else
+        {
+            VectorInterface::finalise<ElementType, ContainerType>(output, data);
+        }
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static void copy_to(const ContainerType& data, ElementType* output,
+                        const std::vector<std::size_t>& dimension_sizes)
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            FixedArrayOperations::check_shape<ContainerType>(dimension_sizes);
+            std::memcpy(output, data.data(), data.size() * sizeof(ElementType));
+        }
+        else
+        {
+            VectorInterface::copy_to<ElementType, ContainerType>(data, output, dimension_sizes);
+        }
+    }
+
+    /**
+     * The buffer is copied bytewise, the input buffer is not necessarily aligned for ElementType
+     */
+    template <typename ElementType, typename ContainerType>
+    static void copy_from(ContainerType& output, const ElementType* input,
+                          const std::vector<std::size_t>& dimension_sizes)
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            FixedArrayOperations::check_shape<ContainerType>(dimension_sizes);
+            std::memcpy(output.data(), input, output.size() * sizeof(ElementType));
+        }
+        else
+        {
+            VectorInterface::copy_from<ElementType, ContainerType>(output, input, dimension_sizes);
+        }
+    }
+
+    template <typename ElementType, typename ContainerType, typename Function>
+    static void for_each_row(ContainerType& data, Function&& function)
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            constexpr std::size_t row_size = ContainerType::shape.back();
+            for (std::size_t offset = 0; row_size > 0 && offset < data.size(); offset += row_size)
+            {
+                function(data.data() + offset, row_size);
+            }
+        }
+        else
+        {
+            VectorInterface::for_each_row<ElementType>(data, std::forward<Function>(function));
+        }
+    }
+
+    /**
+     * The array cannot be resized, the dimension sizes are only checked
+     */
+    template <typename ElementType, typename ContainerType>
+    static void reshape(ContainerType& output, const std::vector<std::size_t>& dimension_sizes)
+    {
+        if constexpr (FixedArrayOperations::is_fixed_array_v<ContainerType>)
+        {
+            FixedArrayOperations::check_shape<ContainerType>(dimension_sizes);
+        }
+        else
+        {
+            VectorInterface::reshape<ElementType, ContainerType>(output, dimension_sizes);
+        }
+    }
+};
+
+} // namespace ncdlgen
@@ -34,6 +34,218 @@ struct Interface
     {
         static_assert(always_false_v<ContainerType>, "The finalise interface not implemented.");
     }
+
+    /**
+     * Optional, containers that store all their elements in a single contiguous buffer
+     * with data() and size() members can be handed to the pipes without copying
+     */
+    template <typename ElementType, typename ContainerType>
+    static constexpr bool is_contiguous()
+    {
+        return false;
+    }
+
+    /**
+     * Optional, the dimension sizes of the container, for containers that know
+     * their shape without walking the elements
+     */
+    template <typename ElementType, typename ContainerType>
+    static std::vector<std::size_t> dimension_sizes(const ContainerType& data)
+    {
+        static_assert(always_false_v<ContainerType>, "The dimension_sizes interface not implemented.");
+        return {};
+    }
+
+    /**
+     * Optional, flatten the container to a new flat buffer with its dimension sizes
+     */
+    template <typename ElementType, typename ContainerType>
+    static Data<ElementType> prepare(const ContainerType& data)
+    {
+        static_assert(always_false_v<ContainerType>, "The flattening prepare interface not implemented.");
+    }
+
+    /**
+     * Optional, copy the container contents directly to a flat buffer that has space
+     * for all the elements described by dimension_sizes
+     */
+    template <typename ElementType, typename ContainerType>
+    static void copy_to(const ContainerType& data, ElementType* output,
+                        const std::vector<std::size_t>& dimension_sizes)
+    {
+        static_assert(always_false_v<ContainerType>, "The copy_to interface not implemented.");
+    }
+
+    /**
+     * Optional, resize the output container to dimension_sizes and copy the contents
+     * of a flat buffer directly to it
+     */
+    template <typename ElementType, typename ContainerType>
+    static void copy_from(ContainerType& output, const ElementType* input,
+                          const std::vector<std::size_t>& dimension_sizes)
+    {
+        static_assert(always_false_v<ContainerType>, "The copy_from interface not implemented.");
+    }
+
+    /**
+     * Optional, call function(row, row_size) for each contiguous innermost row of the
+     * container in row-major order, used to stream the container without a flat copy
+     */
+    template <typename ElementType, typename ContainerType, typename Function>
+    static void for_each_row(ContainerType& data, Function&& function)
+    {
+        static_assert(always_false_v<ContainerType>, "The for_each_row interface not implemented.");
+    }
+
+    /**
+     * Optional, resize the output container to dimension_sizes, keeping the existing capacity
+     */
+    template <typename ElementType, typename ContainerType>
+    static void reshape(ContainerType& output, const std::vector<std::size_t>& dimension_sizes)
+    {
+        static_assert(always_false_v<ContainerType>, "The reshape interface not implemented.");
+    }
+};
+
+/**
+ * Detect the optional parts of an interface. Interfaces without them are
+ * served through prepare and finalise.
+ */
+namespace InterfaceTraits
+{
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct is_contiguous : std::false_type
+{
 };
 
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct is_contiguous<
+    ContainerInterface, ElementType, ContainerType,
+    std::enable_if_t<ContainerInterface::template is_contiguous<ElementType, ContainerType>()>>
+    : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool is_contiguous_v = is_contiguous<ContainerInterface, ElementType, ContainerType>::value;
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct has_dimension_sizes : std::false_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct has_dimension_sizes<
+    ContainerInterface, ElementType, ContainerType,
+    std::void_t<decltype(ContainerInterface::template dimension_sizes<ElementType, ContainerType>(
+        std::declval<const ContainerType&>()))>> : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool has_dimension_sizes_v =
+    has_dimension_sizes<ContainerInterface, ElementType, ContainerType>::value;
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct has_copy_to : std::false_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct has_copy_to<ContainerInterface, ElementType, ContainerType,
+                   std::void_t<decltype(ContainerInterface::template copy_to<ElementType, ContainerType>(
+                       std::declval<const ContainerType&>(), std::declval<ElementType*>(),
+                       std::declval<const std::vector<std::size_t>&>()))>> : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool has_copy_to_v = has_copy_to<ContainerInterface, ElementType, ContainerType>::value;
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct has_prepare_from_container : std::false_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct has_prepare_from_container<
+    ContainerInterface, ElementType, ContainerType,
+    std::void_t<decltype(ContainerInterface::template prepare<ElementType, ContainerType>(
+        std::declval<const ContainerType&>()))>> : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool has_prepare_from_container_v =
+    has_prepare_from_container<ContainerInterface, ElementType, ContainerType>::value;
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct has_copy_from : std::false_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct has_copy_from<ContainerInterface, ElementType, ContainerType,
+                     std::void_t<decltype(ContainerInterface::template copy_from<ElementType, ContainerType>(
+                         std::declval<ContainerType&>(), std::declval<const ElementType*>(),
+                         std::declval<const std::vector<std::size_t>&>()))>> : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool has_copy_from_v = has_copy_from<ContainerInterface, ElementType, ContainerType>::value;
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct has_for_each_row : std::false_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct has_for_each_row<ContainerInterface, ElementType, ContainerType,
+                        std::void_t<decltype(ContainerInterface::template for_each_row<ElementType>(
+                            std::declval<const ContainerType&>(),
+                            std::declval<void (*)(const ElementType*, std::size_t)>()))>> : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool has_for_each_row_v =
+    has_for_each_row<ContainerInterface, ElementType, ContainerType>::value;
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType, typename = void>
+struct has_reshape : std::false_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+struct has_reshape<ContainerInterface, ElementType, ContainerType,
+                   std::void_t<decltype(ContainerInterface::template reshape<ElementType, ContainerType>(
+                       std::declval<ContainerType&>(), std::declval<const std::vector<std::size_t>&>()))>>
+    : std::true_type
+{
+};
+
+template <typename ContainerInterface, typename ElementType, typename ContainerType>
+inline constexpr bool has_reshape_v = has_reshape<ContainerInterface, ElementType, ContainerType>::value;
+
+/**
+ * Containers with the shape known at compile time, e.g. FixedArray, in the static
+ * array member shape. The shape is checked without building the dimension sizes
+ */
+template <typename ContainerType, typename = void> struct has_static_shape : std::false_type
+{
+};
+
+template <typename ContainerType>
+struct has_static_shape<ContainerType, std::void_t<decltype(ContainerType::shape.data()),
+                                                   decltype(ContainerType::shape.size())>> : std::true_type
+{
+};
+
+template <typename ContainerType>
+inline constexpr bool has_static_shape_v = has_static_shape<ContainerType>::value;
+
+} // namespace InterfaceTraits
+
 } // namespace ncdlgen
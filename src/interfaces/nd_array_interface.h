@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "interface.h"
+#include "vector_interface.h"
+
+namespace ncdlgen
+{
+
+/**
+ * Row-major strides of the shape, in elements
+ */
+template <std::size_t Rank>
+std::array<std::size_t, Rank> row_major_strides(const std::array<std::size_t, Rank>& shape)
+{
+    std::array<std::size_t, Rank> strides{};
+    std::size_t stride{1};
+    for (std::size_t i = Rank; i > 0; i--)
+    {
+        strides[i - 1] = stride;
+        stride *= shape[i - 1];
+    }
+    return strides;
+}
+
+/**
+ * A non-owning view to N-dimensional data, in the spirit of std::mdspan
+ *
+ * The view does not own the elements, and is valid as long as the viewed
+ * buffer. Indexing with operator[] returns the view of a sub array.
+ */
+template <typename ElementType, std::size_t Rank> class NDArrayView
+{
+  public:
+    static_assert(Rank > 0, "NDArrayView needs at least one dimension");
+
+    NDArrayView() = default;
+    NDArrayView(ElementType* data, const std::array<std::size_t, Rank>& shape)
+        : m_data(data), m_shape(shape), m_strides(row_major_strides(shape))
+    {
+    }
+    NDArrayView(ElementType* data, const std::array<std::size_t, Rank>& shape,
+                const std::array<std::size_t, Rank>& strides)
+        : m_data(data), m_shape(shape), m_strides(strides)
+    {
+    }
+
+    ElementType* data() const { return m_data; }
+    const std::array<std::size_t, Rank>& shape() const { return m_shape; }
+    const std::array<std::size_t, Rank>& strides() const { return m_strides; }
+    std::size_t extent(std::size_t dimension) const { return m_shape[dimension]; }
+
+    template <typename... Indices> ElementType& operator()(Indices... indices) const
+    {
+        static_assert(sizeof...(Indices) == Rank, "One index is needed for each dimension");
+        std::size_t dimension{};
+        std::size_t offset{};
+        ((offset += static_cast<std::size_t>(indices) * m_strides[dimension++]), ...);
+        return m_data[offset];
+    }
+
+    /**
+     * The element of a 1D view, or the view of the sub array along the first dimension
+     */
+    decltype(auto) operator[](std::size_t index) const
+    {
+        if constexpr (Rank == 1)
+        {
+            return m_data[index * m_strides[0]];
+        }
+        else
+        {
+            std::array<std::size_t, Rank - 1> shape{};
+            std::array<std::size_t, Rank - 1> strides{};
+            std::copy(m_shape.begin() + 1, m_shape.end(), shape.begin());
+            std::copy(m_strides.begin() + 1, m_strides.end(), strides.begin());
+            return NDArrayView<ElementType, Rank - 1>{m_data + index * m_strides[0], shape, strides};
+        }
+    }
+
+  private:
+    ElementType* m_data{};
+    std::array<std::size_t, Rank> m_shape{};
+    std::array<std::size_t, Rank> m_strides{};
+};
+
+/**
+ * An N-dimensional array that stores its elements in a single contiguous buffer
+ *
+ * An alternative to nested std::vectors, the pipes read and write the buffer
+ * as is, without flattening it or assigning the rows one by one. The elements
+ * are in row-major order, the same as in NetCDF.
+ */
+template <typename ElementType, std::size_t Rank> class NDArray
+{
+  public:
+    static_assert(Rank > 0, "NDArray needs at least one dimension, use the element type for scalars");
+
+    using value_type = ElementType;
+    using iterator = typename std::vector<ElementType>::iterator;
+    using const_iterator = typename std::vector<ElementType>::const_iterator;
+
+    NDArray() = default;
+    explicit NDArray(const std::array<std::size_t, Rank>& shape, const ElementType& value = {})
+        : m_shape(shape), m_strides(row_major_strides(shape)), m_data(number_of_elements(shape), value)
+    {
+    }
+    NDArray(const std::array<std::size_t, Rank>& shape, std::vector<ElementType> data)
+        : m_shape(shape), m_strides(row_major_strides(shape)), m_data(std::move(data))
+    {
+        if (m_data.size() != number_of_elements(shape))
+        {
+            throw std::runtime_error(
+                fmt::format("NDArray: {} elements do not match the shape of {} elements.", m_data.size(),
+                            number_of_elements(shape)));
+        }
+    }
+
+    ElementType* data() { return m_data.data(); }
+    const ElementType* data() const { return m_data.data(); }
+    std::size_t size() const { return m_data.size(); }
+    bool empty() const { return m_data.empty(); }
+
+    const std::array<std::size_t, Rank>& shape() const { return m_shape; }
+    const std::array<std::size_t, Rank>& strides() const { return m_strides; }
+    std::size_t extent(std::size_t dimension) const { return m_shape[dimension]; }
+
+    iterator begin() { return m_data.begin(); }
+    iterator end() { return m_data.end(); }
+    const_iterator begin() const { return m_data.begin(); }
+    const_iterator end() const { return m_data.end(); }
+
+    template <typename... Indices> ElementType& operator()(Indices... indices) { return view()(indices...); }
+    template <typename... Indices> const ElementType& operator()(Indices... indices) const
+    {
+        return view()(indices...);
+    }
+
+    decltype(auto) operator[](std::size_t index) { return view()[index]; }
+    decltype(auto) operator[](std::size_t index) const { return view()[index]; }
+
+    NDArrayView<ElementType, Rank> view() { return {m_data.data(), m_shape, m_strides}; }
+    NDArrayView<const ElementType, Rank> view() const { return {m_data.data(), m_shape, m_strides}; }
+
+    /**
+     * Change the shape, the elements are not kept in place. The existing
+     * capacity of the buffer is reused.
+     */
+    void reshape(const std::vector<std::size_t>& dimension_sizes)
+    {
+        if (dimension_sizes.size() != Rank)
+        {
+            throw std::runtime_error(
+                fmt::format("Error with reshaping NDArray with {} dimensions with {} target dimensions.",
+                            Rank, dimension_sizes.size()));
+        }
+        std::copy(dimension_sizes.begin(), dimension_sizes.end(), m_shape.begin());
+        m_strides = row_major_strides(m_shape);
+        m_data.resize(VectorOperations::number_of_elements(dimension_sizes));
+    }
+
+    std::vector<std::size_t> dimension_sizes() const { return {m_shape.begin(), m_shape.end()}; }
+
+    bool operator==(const NDArray& other) const { return m_shape == other.m_shape && m_data == other.m_data; }
+    bool operator!=(const NDArray& other) const { return !(*this == other); }
+
+  private:
+    static std::size_t number_of_elements(const std::array<std::size_t, Rank>& shape)
+    {
+        std::size_t number_of_elements{1};
+        for (auto dimension_size : shape)
+        {
+            number_of_elements *= dimension_size;
+        }
+        return number_of_elements;
+    }
+
+    std::array<std::size_t, Rank> m_shape{};
+    std::array<std::size_t, Rank> m_strides{};
+    std::vector<ElementType> m_data{};
+};
+
+namespace NDArrayOperations
+{
+
+template <typename T> struct is_nd_array : std::false_type
+{
+};
+
+template <typename ElementType, std::size_t Rank>
+struct is_nd_array<NDArray<ElementType, Rank>> : std::true_type
+{
+};
+
+template <typename T> inline constexpr bool is_nd_array_v = is_nd_array<T>::value;
+
+static_assert(is_nd_array_v<NDArray<float, 2>>);
+static_assert(!is_nd_array_v<std::vector<float>>);
+
+template <typename ElementType, typename ContainerType>
+void check_size(const ContainerType& data, const std::vector<std::size_t>& dimension_sizes)
+{
+    if (data.size() != VectorOperations::number_of_elements(dimension_sizes))
+    {
+        throw std::runtime_error(
+            fmt::format("NDArrayInterface: The array has {} elements, when expecting {}.", data.size(),
+                        VectorOperations::number_of_elements(dimension_sizes)));
+    }
+}
+
+} // namespace NDArrayOperations
+
+/**
+ * The interface of NDArray, the array is read and written directly from its
+ * buffer without an intermediate Data
+ */
+struct NDArrayInterface
+{
+    template <typename ElementType, typename ContainerType,
+              std::enable_if_t<NDArrayOperations::is_nd_array_v<ContainerType>, bool> = true>
+    static constexpr bool is_supported_ndarray()
+    {
+        return true;
+    };
+
+    template <typename ElementType, typename ContainerType> static constexpr bool is_contiguous()
+    {
+        if constexpr (NDArrayOperations::is_nd_array_v<ContainerType>)
+        {
+            return std::is_same_v<ElementType, typename ContainerType::value_type>;
+        }
+        return false;
+    }
+
+    /**
+     * The shape of the array, without walking the elements
+     */
+    template <typename ElementType, typename ContainerType>
+    static std::vector<std::size_t> dimension_sizes(const ContainerType& data)
+    {
+        return data.dimension_sizes();
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static Data<ElementType> prepare(const std::vector<std::size_t>& dimension_sizes)
+    {
+        Data<ElementType> data{};
+        data.dimension_sizes = dimension_sizes;
+        data.data.resize(VectorOperations::number_of_elements(dimension_sizes));
+        return data;
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static void finalise(ContainerType& output, const Data<ElementType>& data)
+    {
+        output.reshape(data.dimension_sizes);
+        NDArrayOperations::check_size<ElementType>(data.data, data.dimension_sizes);
+        // The buffer of an empty array may be null, which memcpy does not accept
+        if (!data.data.empty())
+        {
+            std::memcpy(output.data(), data.data.data(), data.data.size() * sizeof(ElementType));
+        }
+    }
+
+    /**
+     * The buffer is copied bytewise, the output buffer is not necessarily aligned for ElementType
+     */
+    template <typename ElementType, typename ContainerType>
+    static void copy_to(const ContainerType& data, ElementType* output,
+                        const std::vector<std::size_t>& dimension_sizes)
+    {
+        NDArrayOperations::check_size<ElementType>(data, dimension_sizes);
+        if (data.size() > 0)
+        {
+            std::memcpy(output, data.data(), data.size() * sizeof(ElementType));
+        }
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static void copy_from(ContainerType& output, const ElementType* input,
+                          const std::vector<std::size_t>& dimension_sizes)
+    {
+        output.reshape(dimension_sizes);
+        if (output.size() > 0)
+        {
+            std::memcpy(output.data(), input, output.size() * sizeof(ElementType));
+        }
+    }
+
+    template <typename ElementType, typename ContainerType, typename Function>
+    static void for_each_row(ContainerType& data, Function&& function)
+    {
+        const std::size_t row_size = data.shape().back();
+        for (std::size_t offset = 0; row_size > 0 && offset < data.size(); offset += row_size)
+        {
+            function(data.data() + offset, row_size);
+        }
+    }
+
+    template <typename ElementType, typename ContainerType>
+    static void reshape(ContainerType& output, const std::vector<std::size_t>& dimension_sizes)
+    {
+        output.reshape(dimension_sizes);
+    }
+};
+
+} // namespace ncdlgen
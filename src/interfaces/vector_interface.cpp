@@ -18,4 +18,11 @@ std::size_t VectorOperations::number_of_elements(const std::vector<std::size_t>&
     return number_of_elements;
 }
 
+void VectorOperations::throw_dimension_size_error(std::size_t expected_size, std::size_t size)
+{
+    throw std::runtime_error(fmt::format("VectorInterface: The container dimension sizes are not consistent "
+                                         "between sibling entries, expected size {}, found size {}",
+                                         expected_size, size));
+}
+
 } // namespace ncdlgen
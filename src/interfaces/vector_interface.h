@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+#include <memory_resource>
 #include <vector>
 
 #include <fmt/core.h>
@@ -16,15 +18,13 @@ namespace VectorOperations
 {
 
 /**
- * is vector
+ * is vector, with any allocator e.g. std::pmr::vector
  */
-template <typename T, typename U = void> struct is_vector : std::false_type
+template <typename T> struct is_vector : std::false_type
 {
 };
 
-template <typename T>
-struct is_vector<T, std::enable_if_t<std::is_same_v<T, std::vector<typename T::value_type>>>>
-    : public std::true_type
+template <typename T, typename Allocator> struct is_vector<std::vector<T, Allocator>> : public std::true_type
 {
 };
 template <typename T> inline constexpr bool is_vector_v = is_vector<T>::value;
@@ -32,6 +32,7 @@ template <typename T> inline constexpr bool is_vector_v = is_vector<T>::value;
 static_assert(is_vector_v<std::vector<int>>);
 static_assert(is_vector_v<std::vector<short unsigned int>>);
 static_assert(is_vector_v<std::vector<std::vector<int>>>);
+static_assert(is_vector_v<std::pmr::vector<std::pmr::vector<int>>>);
 static_assert(!is_vector_v<int>);
 
 /**
@@ -59,13 +60,61 @@ static_assert(dimension_count_v<std::vector<std::vector<int>>> == 2, "2d vector
  */
 std::size_t number_of_elements(const std::vector<std::size_t>& dimension_sizes);
 
+/**
+ * Report a container that does not have the size of its dimension
+ */
+[[noreturn]] void throw_dimension_size_error(std::size_t expected_size, std::size_t size);
+
+/**
+ * Append the sizes of the first container at each level to dimension_sizes,
+ * without looking at the siblings. An empty container has 0 as the size of
+ * all its remaining dimensions.
+ */
+template <typename ElementType, typename ContainerType>
+void leading_dimension_sizes(const ContainerType& data, std::vector<std::size_t>& dimension_sizes)
+{
+    using ValueType = typename ContainerType::value_type;
+    dimension_sizes.push_back(data.size());
+    if constexpr (!std::is_same_v<ElementType, ValueType>)
+    {
+        if (data.empty())
+        {
+            dimension_sizes.resize(dimension_sizes.size() + dimension_count_v<ValueType>, 0);
+            return;
+        }
+        leading_dimension_sizes<ElementType, ValueType>(data.front(), dimension_sizes);
+    }
+}
+
+/**
+ * Check that every container has the size of its dimension, i.e. the container
+ * is not ragged. Only the containers are visited, not the elements.
+ */
+template <typename ElementType, typename ContainerType>
+void check_dimension_sizes(const ContainerType& data, const std::size_t* dimension_sizes)
+{
+    if (data.size() != *dimension_sizes)
+    {
+        throw_dimension_size_error(*dimension_sizes, data.size());
+    }
+    using ValueType = typename ContainerType::value_type;
+    if constexpr (!std::is_same_v<ElementType, ValueType>)
+    {
+        for (auto& element : data)
+        {
+            check_dimension_sizes<ElementType, ValueType>(element, dimension_sizes + 1);
+        }
+    }
+}
+
 /**
  * Get the size of each dimension of a container
  *
  * Return 1 for scalar
  * Return 0 for each empty dimension
  *
- * The number of returned entries matches the dimension_count_v<ContainerType>
+ * The number of returned entries matches the dimension_count_v<ContainerType>.
+ * Throws if the sibling containers have different sizes.
  */
 template <typename ElementType, typename ContainerType>
 static std::vector<std::size_t> container_dimension_sizes(const ContainerType& data)
@@ -74,80 +123,54 @@ static std::vector<std::size_t> container_dimension_sizes(const ContainerType& d
     {
         return {1};
     }
-    else if constexpr (std::is_same_v<ElementType, typename ContainerType::value_type>)
-    {
-        return {data.size()};
-    }
     else
     {
-        std::vector<std::size_t> dimension_sizes = {data.size()};
-
-        // Stop checking dimension sizes at first empty container
-        // Fill 0 as dimension size for all remaining dimensions
-        if (data.empty())
-        {
-            auto number_of_empty_dimensions =
-                VectorOperations::dimension_count_v<typename ContainerType::value_type>;
-            dimension_sizes.resize(dimension_sizes.size() + number_of_empty_dimensions, 0);
-            return dimension_sizes;
-        }
-
-        // Get the container sizes from the first child
-        auto element_dimension_sizes =
-            container_dimension_sizes<ElementType, typename ContainerType::value_type>(data.front());
-
-        // Double check that the remaining elements are consistently sized
-        for (size_t ielem = 0; ielem < data.size(); ielem++)
-        {
-            auto& element = data[ielem];
-            auto sibling_dimension_sizes =
-                container_dimension_sizes<ElementType, typename ContainerType::value_type>(data.front());
-
-            for (size_t i = 0; i < sibling_dimension_sizes.size(); i++)
-            {
-                if (sibling_dimension_sizes[i] != element_dimension_sizes[i])
-                {
-                    throw std::runtime_error(
-                        fmt::format("VectorInterface: The container dimension sizes are not consistent "
-                                    "between sibling entries, expected size {}, found size {}",
-                                    element_dimension_sizes[i], sibling_dimension_sizes[i]));
-                }
-            }
-        }
-
-        dimension_sizes.insert(dimension_sizes.end(), element_dimension_sizes.begin(),
-                               element_dimension_sizes.end());
+        std::vector<std::size_t> dimension_sizes{};
+        dimension_sizes.reserve(dimension_count_v<ContainerType>);
+        leading_dimension_sizes<ElementType, ContainerType>(data, dimension_sizes);
+        check_dimension_sizes<ElementType, ContainerType>(data, dimension_sizes.data());
         return dimension_sizes;
     }
 }
 
 /**
  * Resize the input Container (vector of vectors) based on input dimension sizes
+ *
+ * Walks the dimension sizes with a pointer to not allocate while resizing,
+ * existing capacity of the container is reused.
  */
 template <typename ContainerType>
-void resize(ContainerType& container, const std::vector<std::size_t>& dimension_sizes)
+void resize_recursive(ContainerType& container, const std::size_t* dimension_sizes)
 {
-    if (dimension_count_v<ContainerType> != dimension_sizes.size())
-    {
-        throw std::runtime_error(
-            fmt::format("Error with resizing container with {} dimensions with {} target dimensions.",
-                        dimension_count_v<ContainerType>, dimension_sizes.size()));
-    }
     if constexpr (dimension_count_v<ContainerType> == 0)
     {
         return;
     }
     else
     {
-        container.resize(dimension_sizes.front(), {});
+        container.resize(*dimension_sizes, {});
         for (auto& element : container)
         {
-            std::vector<std::size_t> reduced_sizes(dimension_sizes.begin() + 1, dimension_sizes.end());
-            resize<typename ContainerType::value_type>(element, reduced_sizes);
+            resize_recursive<typename ContainerType::value_type>(element, dimension_sizes + 1);
         }
     }
 };
 
+/**
+ * Resize the input Container (vector of vectors) based on input dimension sizes
+ */
+template <typename ContainerType>
+void resize(ContainerType& container, const std::vector<std::size_t>& dimension_sizes)
+{
+    if (dimension_count_v<ContainerType> != dimension_sizes.size())
+    {
+        throw std::runtime_error(
+            fmt::format("Error with resizing container with {} dimensions with {} target dimensions.",
+                        dimension_count_v<ContainerType>, dimension_sizes.size()));
+    }
+    resize_recursive<ContainerType>(container, dimension_sizes.data());
+};
+
 /**
  * Assign to input Container (vector of vectors) from a flat vector that has the
  * correct amount of elements.
@@ -193,47 +216,145 @@ void assign(ContainerType& container, const std::vector<ElementType>& data)
 };
 
 /**
- * Assign elements from input Container (vector of vectors) to flat vector
+ * Call function(row_pointer, row_size) for each innermost row of the input
+ * Container (vector of vectors) in row-major order, checking the size of each
+ * container against the dimension sizes on the way
+ *
+ * Validates, and visits the rows, in a single traversal.
  */
-template <typename ElementType, typename ContainerType>
-void flatten_data(const ContainerType& data, std::vector<ElementType>& flat_data, std::size_t& flat_index)
+template <typename ElementType, typename ContainerType, typename Function>
+void for_each_checked_row(const ContainerType& data, const std::size_t* dimension_sizes, Function& function)
 {
-    if constexpr (std::is_same_v<ElementType, ContainerType>)
+    if (data.size() != *dimension_sizes)
     {
-        if (flat_index >= flat_data.size())
-        {
-            throw std::runtime_error(
-                fmt::format("Trying to assign to flat_data at index {}, when space available for {} entries.",
-                            flat_index, flat_data.size()));
-        }
+        throw_dimension_size_error(*dimension_sizes, data.size());
+    }
 
-        flat_data[flat_index++] = data;
+    using ValueType = typename ContainerType::value_type;
+    if constexpr (std::is_same_v<ElementType, ValueType>)
+    {
+        function(data.data(), data.size());
     }
     else
     {
         for (auto& element : data)
         {
-            flatten_data<ElementType, typename ContainerType::value_type>(element, flat_data, flat_index);
+            for_each_checked_row<ElementType, ValueType>(element, dimension_sizes + 1, function);
         }
     }
 }
 
 /**
- * Assign elements from input Container (vector of vectors) to flat vector
+ * Flatten the input Container (vector of vectors) to a flat vector with its dimension sizes
  *
- * Main interface for users, set up the flat index counter
+ * The dimension sizes are taken from the first container at each level, and
+ * the other containers are checked against them while their rows are copied,
+ * so the elements are read and written once.
  */
 template <typename ElementType, typename ContainerType>
 Data<ElementType> flatten_data(const ContainerType& data)
 {
     Data<ElementType> flat_data = {};
-    std::size_t flat_index{};
-    flat_data.dimension_sizes = container_dimension_sizes<ElementType, ContainerType>(data);
-    flat_data.data.resize(VectorOperations::number_of_elements(flat_data.dimension_sizes));
-    flatten_data<ElementType, ContainerType>(data, flat_data.data, flat_index);
+    if constexpr (std::is_same_v<ElementType, ContainerType>)
+    {
+        flat_data.dimension_sizes = {1};
+        flat_data.data = {data};
+    }
+    else
+    {
+        flat_data.dimension_sizes.reserve(dimension_count_v<ContainerType>);
+        leading_dimension_sizes<ElementType, ContainerType>(data, flat_data.dimension_sizes);
+
+        // The rows are appended without initialising the buffer first
+        flat_data.data.reserve(VectorOperations::number_of_elements(flat_data.dimension_sizes));
+        auto append_row = [&](const ElementType* row, std::size_t size)
+        { flat_data.data.insert(flat_data.data.end(), row, row + size); };
+        for_each_checked_row<ElementType, ContainerType>(data, flat_data.dimension_sizes.data(), append_row);
+    }
     return flat_data;
 }
 
+/**
+ * Call function(row_pointer, row_size) for each innermost row of the input Container
+ * (vector of vectors) in row-major order. The rows are contiguous in memory.
+ *
+ * Works for both const and non-const containers.
+ */
+template <typename ElementType, typename ContainerType, typename Function>
+void for_each_row(ContainerType& data, Function&& function)
+{
+    if constexpr (std::is_same_v<ElementType, typename ContainerType::value_type>)
+    {
+        function(data.data(), data.size());
+    }
+    else
+    {
+        for (auto& element : data)
+        {
+            for_each_row<ElementType>(element, function);
+        }
+    }
+}
+
+/**
+ * Copy elements from input Container (vector of vectors) to a flat buffer with
+ * space for all the elements described by dimension_sizes. Copies one innermost
+ * row at a time, and checks the size of each container on the way.
+ *
+ * The rows are copied bytewise, the output buffer (e.g. a message buffer) is not
+ * necessarily aligned for ElementType.
+ */
+template <typename ElementType, typename ContainerType>
+void copy_rows(const ContainerType& data, ElementType* output, const std::vector<std::size_t>& dimension_sizes)
+{
+    if (dimension_sizes.size() != dimension_count_v<ContainerType>)
+    {
+        throw std::runtime_error(
+            fmt::format("VectorInterface: Trying to copy a container with {} dimensions as {} dimensions.",
+                        dimension_count_v<ContainerType>, dimension_sizes.size()));
+    }
+
+    auto* bytes = reinterpret_cast<unsigned char*>(output);
+    auto copy_row = [&](const ElementType* row, std::size_t size)
+    {
+        // The buffer of an empty row may be null, which memcpy does not accept
+        if (size > 0)
+        {
+            std::memcpy(bytes, row, size * sizeof(ElementType));
+            bytes += size * sizeof(ElementType);
+        }
+    };
+    for_each_checked_row<ElementType, ContainerType>(data, dimension_sizes.data(), copy_row);
+}
+
+/**
+ * Copy elements from a flat buffer to the input Container (vector of vectors), that
+ * has been resized to match the dimension_sizes. Copies one innermost row at a time.
+ */
+template <typename ElementType, typename ContainerType>
+void assign_rows(ContainerType& data, const ElementType* input, const std::vector<std::size_t>& dimension_sizes)
+{
+    const std::size_t number_of_elements = VectorOperations::number_of_elements(dimension_sizes);
+    std::size_t flat_index{};
+
+    for_each_row<ElementType>(data,
+                              [&](ElementType* row, std::size_t size)
+                              {
+                                  if (flat_index + size > number_of_elements)
+                                  {
+                                      throw std::runtime_error(fmt::format(
+                                          "VectorInterface: Trying to assign row of size {} at index {}, "
+                                          "when data available for {} entries.",
+                                          size, flat_index, number_of_elements));
+                                  }
+                                  if (size > 0)
+                                  {
+                                      std::memcpy(row, input + flat_index, size * sizeof(ElementType));
+                                      flat_index += size;
+                                  }
+                              });
+}
+
 }; // namespace VectorOperations
 
 struct VectorInterface
@@ -255,6 +376,29 @@ struct VectorInterface
         return VectorOperations::flatten_data<ElementType, ContainerType>(data);
     }
 
+    /**
+     * 1D vectors store their elements contiguously and can be used as is
+     */
+    template <typename ElementType, typename ContainerType>
+    static constexpr bool is_contiguous()
+    {
+        if constexpr (VectorOperations::is_vector_v<ContainerType>)
+        {
+            return std::is_same_v<ElementType, typename ContainerType::value_type>;
+        }
+        return false;
+    }
+
+    /**
+     * Copy container contents directly to a flat buffer, without an intermediate Data
+     */
+    template <typename ElementType, typename ContainerType>
+    static void copy_to(const ContainerType& data, ElementType* output,
+                        const std::vector<std::size_t>& dimension_sizes)
+    {
+        VectorOperations::copy_rows<ElementType, ContainerType>(data, output, dimension_sizes);
+    }
+
     /**
      * Prepare container for reading into, with known dimension sizes of the input
      */
@@ -267,6 +411,19 @@ struct VectorInterface
         return data;
     }
 
+    /**
+     * Copy a flat buffer directly to the final container, without an intermediate Data.
+     *
+     * The existing capacity of the output container is reused.
+     */
+    template <typename ElementType, typename ContainerType>
+    static void copy_from(ContainerType& output, const ElementType* input,
+                          const std::vector<std::size_t>& dimension_sizes)
+    {
+        VectorOperations::resize(output, dimension_sizes);
+        VectorOperations::assign_rows<ElementType, ContainerType>(output, input, dimension_sizes);
+    }
+
     /**
      * Return the intermediate buffer transformed in the shape of the final container
      */
@@ -277,6 +434,24 @@ struct VectorInterface
         VectorOperations::assign(output, data.data);
     }
 
+    /**
+     * Visit the innermost rows of the container, the rows are contiguous in memory
+     */
+    template <typename ElementType, typename ContainerType, typename Function>
+    static void for_each_row(ContainerType& data, Function&& function)
+    {
+        VectorOperations::for_each_row<ElementType>(data, std::forward<Function>(function));
+    }
+
+    /**
+     * Resize the container to the dimension sizes, reusing the existing capacity
+     */
+    template <typename ElementType, typename ContainerType>
+    static void reshape(ContainerType& output, const std::vector<std::size_t>& dimension_sizes)
+    {
+        VectorOperations::resize(output, dimension_sizes);
+    }
+
     template <typename ElementType>
     static constexpr void resize(std::vector<ElementType>& data,
                                  const std::vector<std::size_t>& dimension_sizes)
@@ -0,0 +1,358 @@
+#include <chrono>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include "async_netcdf_pipe.h"
+#include "backoff.h"
+
+namespace ncdlgen
+{
+
+AsyncNetCDFPipe::AsyncNetCDFPipe(std::string_view file_path, const AsyncNetCDFConfiguration& config)
+    : m_config(config), m_pipe(file_path, config.netcdf), m_queue(config.queue_depth)
+{
+    m_thread = std::thread([this] { run(); });
+}
+
+AsyncNetCDFPipe::~AsyncNetCDFPipe()
+{
+    // The queued writes are written before the thread stops
+    {
+        std::lock_guard lock{m_mutex};
+        m_stop = true;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+}
+
+void AsyncNetCDFPipe::open()
+{
+    call([](NetCDFPipe& pipe) { pipe.open(); });
+}
+
+void AsyncNetCDFPipe::close()
+{
+    call([](NetCDFPipe& pipe) { pipe.close(); });
+}
+
+void AsyncNetCDFPipe::create_from_schema(const RootGroup& root)
+{
+    call([&](NetCDFPipe& pipe) { pipe.create_from_schema(root); });
+}
+
+void AsyncNetCDFPipe::use_schema(const Schema& schema)
+{
+    call([&](NetCDFPipe& pipe) { pipe.use_schema(schema); });
+}
+
+void AsyncNetCDFPipe::flush()
+{
+    const bool sync = m_config.sync_policy == NetCDFSyncPolicy::OnFlush;
+    call(
+        [&](NetCDFPipe& pipe)
+        {
+            if (sync && pipe.is_open())
+            {
+                pipe.sync();
+                m_syncs++;
+            }
+        });
+    rethrow_error();
+}
+
+void AsyncNetCDFPipe::sync()
+{
+    call(
+        [&](NetCDFPipe& pipe)
+        {
+            pipe.sync();
+            m_syncs++;
+        });
+    rethrow_error();
+}
+
+void AsyncNetCDFPipe::begin_record()
+{
+    push(std::make_unique<AsyncNetCDFOperation>(AsyncNetCDFOperation::Kind::BeginRecord));
+}
+
+void AsyncNetCDFPipe::end_record()
+{
+    push(std::make_unique<AsyncNetCDFOperation>(AsyncNetCDFOperation::Kind::EndRecord));
+}
+
+AsyncNetCDFStatistics AsyncNetCDFPipe::statistics() const
+{
+    return AsyncNetCDFStatistics{.queue_depth = m_queue.size(),
+                                 .max_queue_depth = m_max_queue_depth,
+                                 .written_operations = m_written_operations.load(),
+                                 .coalesced_writes = m_coalesced_writes.load(),
+                                 .syncs = m_syncs.load(),
+                                 .stalls = m_stalls,
+                                 .stall_seconds = m_stall_seconds};
+}
+
+void AsyncNetCDFPipe::push(std::unique_ptr<AsyncNetCDFOperation>&& operation)
+{
+    rethrow_error();
+
+    if (!m_queue.try_push(std::move(operation)))
+    {
+        auto stall_start = std::chrono::steady_clock::now();
+        if (!wait_until([&] { return m_queue.try_push(std::move(operation)); }, m_config.send_timeout_ms))
+        {
+            throw std::runtime_error(fmt::format(
+                "AsyncNetCDFPipe: timed out waiting for space, {} writes queued.", m_queue.size()));
+        }
+        m_stalls++;
+        m_stall_seconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - stall_start).count();
+    }
+
+    m_max_queue_depth = std::max(m_max_queue_depth, m_queue.size());
+
+    if (m_waiting.load())
+    {
+        std::lock_guard lock{m_mutex};
+        m_condition.notify_one();
+    }
+}
+
+void AsyncNetCDFPipe::rethrow_error()
+{
+    if (!m_failed.load())
+    {
+        return;
+    }
+
+    std::exception_ptr error{};
+    {
+        std::lock_guard lock{m_mutex};
+        std::swap(error, m_error);
+        m_failed = false;
+    }
+    std::rethrow_exception(error);
+}
+
+void AsyncNetCDFPipe::run()
+{
+    Operations batch{};
+    std::unique_ptr<AsyncNetCDFOperation> operation{};
+    while (true)
+    {
+        // Take all the queued writes, the more the disk lags behind the more can be combined
+        while (batch.size() < m_queue.capacity() && m_queue.try_pop(operation))
+        {
+            batch.push_back(std::move(operation));
+        }
+
+        if (!batch.empty())
+        {
+            write_batch(batch);
+            batch.clear();
+            continue;
+        }
+
+        std::unique_lock lock{m_mutex};
+        if (m_stop)
+        {
+            break;
+        }
+        // The timeout guards against missing a push between the flag and the wait
+        m_waiting = true;
+        m_condition.wait_for(lock, std::chrono::milliseconds(1), [this] { return m_stop || !m_queue.empty(); });
+        m_waiting = false;
+    }
+}
+
+void AsyncNetCDFPipe::write_batch(Operations& batch)
+{
+    if (m_config.coalesce_records && !m_failed.load())
+    {
+        coalesce(batch);
+    }
+
+    for (auto& operation : batch)
+    {
+        if (!operation)
+        {
+            continue;
+        }
+
+        if (operation->kind == AsyncNetCDFOperation::Kind::BeginRecord)
+        {
+            m_record_depth++;
+        }
+        else if (operation->kind == AsyncNetCDFOperation::Kind::EndRecord && m_record_depth > 0 &&
+                 --m_record_depth == 0)
+        {
+            m_records_since_sync++;
+        }
+
+        // The tasks report their errors to the waiting caller, and are run also
+        // after a failed write
+        if (operation->kind == AsyncNetCDFOperation::Kind::Task)
+        {
+            operation->execute(m_pipe);
+            continue;
+        }
+
+        // Skip the writes after a failure until the error is rethrown. The record
+        // boundaries are kept, so that the record index of the pipe keeps advancing.
+        if (m_failed.load() && operation->kind == AsyncNetCDFOperation::Kind::Write)
+        {
+            continue;
+        }
+
+        try
+        {
+            operation->execute(m_pipe);
+            if (operation->kind == AsyncNetCDFOperation::Kind::Write)
+            {
+                m_written_operations++;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard lock{m_mutex};
+            m_error = std::current_exception();
+            m_failed = true;
+        }
+    }
+
+    if (m_config.sync_policy == NetCDFSyncPolicy::Periodic && m_records_since_sync >= m_config.sync_interval &&
+        !m_failed.load() && m_pipe.is_open())
+    {
+        m_records_since_sync = 0;
+        try
+        {
+            m_pipe.sync();
+            m_syncs++;
+        }
+        catch (...)
+        {
+            std::lock_guard lock{m_mutex};
+            m_error = std::current_exception();
+            m_failed = true;
+        }
+    }
+}
+
+/**
+ * The writes of a record, or a single write outside of the records, the
+ * writes of which are combined with the following segment of the same writes
+ */
+struct AsyncNetCDFSegment
+{
+    // The indices of the writes in the batch
+    std::vector<std::size_t> writes{};
+    std::vector<bool> appends{};
+    // The segment contains other operations than the writes, or does not end in the batch
+    bool can_coalesce{true};
+};
+
+/**
+ * Combine the consecutive segments of the same writes, the records of the
+ * appends are taken over by the first segment and the other writes by the
+ * last one. The record boundaries are kept, so that the record indices of the
+ * pipe advance as without combining.
+ */
+void AsyncNetCDFPipe::coalesce(Operations& batch)
+{
+    auto write_at = [&](std::size_t index) { return static_cast<AsyncNetCDFWriteOperation*>(batch[index].get()); };
+
+    // Split the batch to segments, a batch taken in the middle of a record continues it
+    std::vector<AsyncNetCDFSegment> segments{};
+    std::size_t depth = m_record_depth;
+    segments.emplace_back().can_coalesce = depth == 0;
+    for (std::size_t index = 0; index < batch.size(); index++)
+    {
+        auto& segment = segments.back();
+        switch (batch[index]->kind)
+        {
+        case AsyncNetCDFOperation::Kind::Write:
+            segment.writes.push_back(index);
+            break;
+        case AsyncNetCDFOperation::Kind::BeginRecord:
+            depth++;
+            break;
+        case AsyncNetCDFOperation::Kind::EndRecord:
+            depth = depth > 0 ? depth - 1 : 0;
+            break;
+        case AsyncNetCDFOperation::Kind::Task:
+            segment.can_coalesce = false;
+            break;
+        }
+
+        if (depth == 0)
+        {
+            segments.emplace_back();
+        }
+    }
+    segments.back().can_coalesce = segments.back().can_coalesce && depth == 0;
+
+    // The errors of the variables are reported by the writes themselves
+    try
+    {
+        for (auto& segment : segments)
+        {
+            for (auto index : segment.writes)
+            {
+                segment.appends.push_back(write_at(index)->appends(m_pipe));
+            }
+        }
+    }
+    catch (...)
+    {
+        return;
+    }
+
+    auto can_combine = [&](const AsyncNetCDFSegment& first, const AsyncNetCDFSegment& next)
+    {
+        if (!first.can_coalesce || !next.can_coalesce || first.writes.empty() ||
+            first.writes.size() != next.writes.size() || first.appends != next.appends)
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < first.writes.size(); i++)
+        {
+            auto* write = write_at(first.writes[i]);
+            auto* next_write = write_at(next.writes[i]);
+            if (write->path != next_write->path || (first.appends[i] && !write->can_absorb(*next_write)))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::size_t first = 0;
+    for (std::size_t next = 1; next < segments.size(); next++)
+    {
+        if (!can_combine(segments[first], segments[next]))
+        {
+            first = next;
+            continue;
+        }
+
+        for (std::size_t i = 0; i < segments[first].writes.size(); i++)
+        {
+            auto index = segments[first].writes[i];
+            auto next_index = segments[next].writes[i];
+            if (segments[first].appends[i])
+            {
+                write_at(index)->absorb(*write_at(next_index));
+            }
+            else
+            {
+                // The last write of the variable is written in place of the first one
+                std::swap(batch[index], batch[next_index]);
+            }
+            batch[next_index].reset();
+            m_coalesced_writes++;
+        }
+    }
+}
+
+} // namespace ncdlgen
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "array_span_interface.h"
+#include "nd_array_interface.h"
+#include "netcdf_configuration.h"
+#include "netcdf_pipe.h"
+#include "schema.h"
+#include "spsc_queue.h"
+
+namespace ncdlgen
+{
+
+/**
+ * An operation queued to the writer thread of AsyncNetCDFPipe
+ */
+class AsyncNetCDFOperation
+{
+  public:
+    enum class Kind
+    {
+        Write,
+        BeginRecord,
+        EndRecord,
+        Task,
+    };
+
+    explicit AsyncNetCDFOperation(Kind kind) : kind(kind) {}
+    virtual ~AsyncNetCDFOperation() = default;
+
+    virtual void execute(NetCDFPipe& pipe)
+    {
+        if (kind == Kind::BeginRecord)
+        {
+            pipe.begin_record();
+        }
+        else if (kind == Kind::EndRecord)
+        {
+            pipe.end_record();
+        }
+    }
+
+    const Kind kind;
+};
+
+/**
+ * A queued write of a variable, owns the written data
+ */
+class AsyncNetCDFWriteOperation : public AsyncNetCDFOperation
+{
+  public:
+    AsyncNetCDFWriteOperation(const Field& field, bool append)
+        : AsyncNetCDFOperation(Kind::Write), path(field.path), id(field.id), append(append)
+    {
+    }
+
+    // The path is owned by the operation, the field passed to the write may not outlive it
+    Field field() const { return {id, path}; }
+
+    // Whether the write appends records to the variable
+    bool appends(NetCDFPipe& pipe) const { return append || pipe.appends(field()); }
+
+    /**
+     * Whether the records of the next append to the same variable can be
+     * combined with the records of this one, see absorb()
+     */
+    virtual bool can_absorb(AsyncNetCDFWriteOperation& next) = 0;
+
+    /**
+     * Take over the records of the next append, so that both are written
+     * with a single nc_put_vara
+     */
+    virtual void absorb(AsyncNetCDFWriteOperation& next) = 0;
+
+    const std::string path;
+    const std::uint32_t id;
+    const bool append;
+};
+
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+class AsyncNetCDFWrite : public AsyncNetCDFWriteOperation
+{
+  public:
+    AsyncNetCDFWrite(const Field& field, ContainerType&& data, bool append)
+        : AsyncNetCDFWriteOperation(field, append), m_data(std::move(data))
+    {
+    }
+
+    // The shape of the records is known only for the containers with a flattening interface
+    static constexpr bool can_flatten =
+        !std::is_arithmetic_v<ContainerType> &&
+        InterfaceTraits::has_prepare_from_container_v<ContainerInterface, ElementType, ContainerType>;
+
+    void execute(NetCDFPipe& pipe) override
+    {
+        if constexpr (std::is_arithmetic_v<ContainerType>)
+        {
+            pipe.write<ContainerType, ElementType, ContainerInterface>(field(), m_data);
+        }
+        else if (m_records)
+        {
+            pipe.append(field(), *m_records);
+        }
+        else if (append)
+        {
+            pipe.append<ContainerType, ElementType, ContainerInterface>(field(), m_data);
+        }
+        else
+        {
+            pipe.write<ContainerType, ElementType, ContainerInterface>(field(), m_data);
+        }
+    }
+
+    bool can_absorb(AsyncNetCDFWriteOperation& next) override
+    {
+        auto* typed_next = dynamic_cast<AsyncNetCDFWrite*>(&next);
+        if (!typed_next || typed_next->path != path)
+        {
+            return false;
+        }
+
+        if constexpr (can_flatten)
+        {
+            const auto& records = flat_records();
+            const auto& next_records = typed_next->flat_records();
+            return !records.dimension_sizes.empty() &&
+                   records.dimension_sizes.size() == next_records.dimension_sizes.size() &&
+                   std::equal(records.dimension_sizes.begin() + 1, records.dimension_sizes.end(),
+                              next_records.dimension_sizes.begin() + 1);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    void absorb(AsyncNetCDFWriteOperation& next) override
+    {
+        if constexpr (can_flatten)
+        {
+            auto& next_records = static_cast<AsyncNetCDFWrite&>(next).flat_records();
+            auto& records = flat_records();
+            records.data.insert(records.data.end(), next_records.data.begin(), next_records.data.end());
+            records.dimension_sizes.front() += next_records.dimension_sizes.front();
+        }
+    }
+
+  private:
+    // Flattened on the writer thread once the data is combined with other records
+    Data<ElementType>& flat_records()
+    {
+        if (!m_records)
+        {
+            m_records = ContainerInterface::template prepare<ElementType, ContainerType>(m_data);
+            m_data = ContainerType{};
+        }
+        return *m_records;
+    }
+
+    ContainerType m_data{};
+    std::optional<Data<ElementType>> m_records{};
+};
+
+/**
+ * A function run on the writer thread, the result or the error of which is
+ * handed back to the calling thread
+ */
+template <typename ResultType> class AsyncNetCDFTask : public AsyncNetCDFOperation
+{
+  public:
+    template <typename Function>
+    explicit AsyncNetCDFTask(Function&& function)
+        : AsyncNetCDFOperation(Kind::Task), m_task(std::forward<Function>(function))
+    {
+    }
+
+    std::future<ResultType> get_future() { return m_task.get_future(); }
+
+    void execute(NetCDFPipe& pipe) override { m_task(pipe); }
+
+  private:
+    std::packaged_task<ResultType(NetCDFPipe&)> m_task;
+};
+
+/**
+ * Counters of the writer thread, to size the queue
+ */
+struct AsyncNetCDFStatistics
+{
+    // The operations in the queue now, and the most there has been
+    std::size_t queue_depth{};
+    std::size_t max_queue_depth{};
+    // The writes done by the writer thread, and the writes combined to other writes
+    std::size_t written_operations{};
+    std::size_t coalesced_writes{};
+    std::size_t syncs{};
+    // The writes that found the queue full, and the total time they waited
+    std::size_t stalls{};
+    double stall_seconds{};
+};
+
+/**
+ * Write to NetCDF from a dedicated writer thread
+ *
+ * libnetcdf is not thread safe, so the NetCDFPipe and the file are owned by
+ * a single writer thread. The writes move or copy the data to a bounded queue
+ * and return, so that the latency of the disk does not stall the writing
+ * thread until the queue is full. The writer thread takes all the queued
+ * writes at once, and combines the consecutive records that append the same
+ * variables into a single write of each variable. The reads and the other
+ * calls wait for the queued writes and run on the writer thread.
+ *
+ * The pipe itself is not thread safe, the writes are expected from a single thread.
+ */
+class AsyncNetCDFPipe
+{
+  public:
+    AsyncNetCDFPipe(std::string_view file_path, const AsyncNetCDFConfiguration& config = {});
+    ~AsyncNetCDFPipe();
+
+    AsyncNetCDFPipe(const AsyncNetCDFPipe&) = delete;
+    AsyncNetCDFPipe& operator=(const AsyncNetCDFPipe&) = delete;
+
+    /**
+     * See NetCDFPipe, these wait for the queued writes and rethrow the error
+     * of a failed write
+     */
+    void open();
+    void close();
+    void create_from_schema(const RootGroup& root);
+    void use_schema(const Schema& schema);
+
+    /**
+     * Wait until the queued writes are written, and write them to the disk
+     * with the OnFlush sync policy
+     *
+     * Rethrows the error of a failed write.
+     */
+    void flush();
+
+    /**
+     * Wait until the queued writes are written, and write the changes of the file to the disk
+     */
+    void sync();
+
+    AsyncNetCDFStatistics statistics() const;
+
+    /**
+     * Queue the write of the data, the moved data is written without copying
+     *
+     * The elements viewed by an ArraySpan are copied to the queue, as the caller
+     * may reuse its memory before the writer thread writes them.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void write(const Field& field, ContainerType&& data)
+    {
+        if constexpr (ArraySpanOperations::is_array_span_v<ContainerType>)
+        {
+            write<OwnedArray<ContainerType>, ElementType, NDArrayInterface>(field, owned_copy(data));
+        }
+        else
+        {
+            push(std::make_unique<AsyncNetCDFWrite<ContainerType, ElementType, ContainerInterface>>(
+                field, std::move(data), false));
+        }
+    }
+
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void write(const Field& field, const ContainerType& data)
+    {
+        write<ContainerType, ElementType, ContainerInterface>(field, ContainerType{data});
+    }
+
+    /**
+     * Queue the append of the records of the data, see NetCDFPipe::append()
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void append(const Field& field, ContainerType&& data)
+    {
+        if constexpr (ArraySpanOperations::is_array_span_v<ContainerType>)
+        {
+            append<OwnedArray<ContainerType>, ElementType, NDArrayInterface>(field, owned_copy(data));
+        }
+        else
+        {
+            push(std::make_unique<AsyncNetCDFWrite<ContainerType, ElementType, ContainerInterface>>(
+                field, std::move(data), true));
+        }
+    }
+
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void append(const Field& field, const ContainerType& data)
+    {
+        append<ContainerType, ElementType, ContainerInterface>(field, ContainerType{data});
+    }
+
+    /**
+     * Mark the record boundaries of the generated interfaces, see NetCDFPipe::begin_record()
+     */
+    void begin_record();
+    void end_record();
+
+    /**
+     * Read the variable after the queued writes
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    ContainerType read(const Field& field)
+    {
+        return call([&](NetCDFPipe& pipe)
+                    { return pipe.read<ContainerType, ElementType, ContainerInterface>(field); });
+    }
+
+    /**
+     * Run the function with the NetCDFPipe on the writer thread after the queued
+     * writes, and return its result
+     */
+    template <typename Function> auto call(Function&& function)
+    {
+        using ResultType = std::invoke_result_t<Function&, NetCDFPipe&>;
+        auto task = std::make_unique<AsyncNetCDFTask<ResultType>>(std::forward<Function>(function));
+        auto result = task->get_future();
+        push(std::move(task));
+        return result.get();
+    }
+
+  private:
+    using Operations = std::vector<std::unique_ptr<AsyncNetCDFOperation>>;
+
+    // The queued copy of the elements viewed by a span
+    template <typename SpanType> using OwnedArray = NDArray<typename SpanType::value_type, SpanType::rank>;
+
+    template <typename SpanType> static OwnedArray<SpanType> owned_copy(const SpanType& span)
+    {
+        return {span.shape(), {span.begin(), span.end()}};
+    }
+
+    void push(std::unique_ptr<AsyncNetCDFOperation>&& operation);
+    void rethrow_error();
+
+    // The writer thread
+    void run();
+    void write_batch(Operations& batch);
+    void coalesce(Operations& batch);
+
+    AsyncNetCDFConfiguration m_config{};
+
+    // Only used by the writer thread
+    NetCDFPipe m_pipe;
+    std::size_t m_record_depth{};
+    std::size_t m_records_since_sync{};
+
+    SPSCQueue<std::unique_ptr<AsyncNetCDFOperation>> m_queue;
+    std::thread m_thread{};
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    bool m_stop{};
+    std::atomic<bool> m_waiting{};
+
+    // The error of a failed write, the following writes are skipped until it is rethrown
+    std::exception_ptr m_error{};
+    std::atomic<bool> m_failed{};
+
+    std::atomic<std::size_t> m_written_operations{};
+    std::atomic<std::size_t> m_coalesced_writes{};
+    std::atomic<std::size_t> m_syncs{};
+    std::size_t m_max_queue_depth{};
+    std::size_t m_stalls{};
+    double m_stall_seconds{};
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+namespace ncdlgen
+{
+
+/**
+ * Wait until the condition holds, first yielding and then sleeping between the checks.
+ * Returns false on timeout, a negative timeout waits indefinitely.
+ *
+ * For waiting on lock-free queues, where the other side does not notify the waiter.
+ */
+template <typename Condition> bool wait_until(Condition&& condition, int timeout_ms)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t attempt = 0; !condition(); attempt++)
+    {
+        if (timeout_ms >= 0 &&
+            std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(timeout_ms))
+        {
+            return false;
+        }
+
+        if (attempt < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    return true;
+}
+
+} // namespace ncdlgen
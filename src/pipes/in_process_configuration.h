@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include <cstddef>
+
+namespace ncdlgen
+{
+
+struct InProcessConfiguration
+{
+    // The number of values the writer can be ahead of the reader
+    std::size_t capacity{16};
+
+    // How long a read waits for the next value, and a write for space in the pipe,
+    // -1 waits indefinitely
+    int receive_timeout_ms{-1};
+    int send_timeout_ms{-1};
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,100 @@
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/core.h>
+
+#include "backoff.h"
+#include "spsc_queue.h"
+
+#include "in_process_configuration.h"
+
+namespace ncdlgen
+{
+
+/**
+ * Hand whole values, such as the generated structs, from a writing thread to a
+ * reading thread of the same process
+ *
+ * The values are moved through a bounded lock-free ring, without serialisation.
+ * The slots of the ring are allocated up front, and the writes and the reads
+ * exchange the values with the slots instead of moving them out. The value the
+ * reader had before a read is left in the slot and is handed back to the writer
+ * on a later write, so that steady streaming reuses the buffers of the values
+ * instead of allocating new ones.
+ *
+ * There can be a single writing and a single reading thread.
+ */
+template <typename ValueType> class InProcessPipe
+{
+  public:
+    InProcessPipe() : InProcessPipe(InProcessConfiguration{}) {}
+    InProcessPipe(const InProcessConfiguration& config) : m_config(config), m_queue(config.capacity) {}
+
+    InProcessPipe(const InProcessPipe&) = delete;
+    InProcessPipe& operator=(const InProcessPipe&) = delete;
+
+    /**
+     * Move the value to the pipe, waits for the reader when the pipe is full
+     *
+     * The moved from value receives a previously read value, or an empty value,
+     * whose buffers can be reused for the next write.
+     */
+    void write(ValueType&& value)
+    {
+        if (!wait_until([&] { return m_queue.try_swap_push(value); }, m_config.send_timeout_ms))
+        {
+            throw std::runtime_error(
+                fmt::format("InProcessPipe: timed out waiting for space, {} values queued.", m_queue.size()));
+        }
+    }
+
+    /**
+     * Copy the value to the pipe over a previously read value, reusing its buffers
+     */
+    void write(const ValueType& value)
+    {
+        if (!wait_until([&] { return m_queue.try_push(value); }, m_config.send_timeout_ms))
+        {
+            throw std::runtime_error(
+                fmt::format("InProcessPipe: timed out waiting for space, {} values queued.", m_queue.size()));
+        }
+    }
+
+    /**
+     * Move the next value out of the pipe, waits for the writer when the pipe is empty
+     *
+     * The previous contents of the value are handed back to the writer.
+     */
+    void read(ValueType& value)
+    {
+        if (!wait_until([&] { return m_queue.try_swap_pop(value); }, m_config.receive_timeout_ms))
+        {
+            throw std::runtime_error("InProcessPipe: timed out waiting for a value.");
+        }
+    }
+
+    ValueType read()
+    {
+        ValueType value{};
+        read(value);
+        return value;
+    }
+
+    /**
+     * Non-waiting variants, return false if the pipe is full or empty
+     */
+    bool try_write(ValueType&& value) { return m_queue.try_swap_push(value); }
+    bool try_read(ValueType& value) { return m_queue.try_swap_pop(value); }
+
+    std::size_t capacity() const { return m_queue.capacity(); }
+
+  private:
+    InProcessConfiguration m_config{};
+    SPSCQueue<ValueType> m_queue;
+};
+
+} // namespace ncdlgen
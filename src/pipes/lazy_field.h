@@ -0,0 +1,48 @@
+#pragma once
+
+#include <optional>
+
+#include "schema.h"
+
+namespace ncdlgen
+{
+
+/**
+ * A variable of a generated lazy struct, read from the pipe on the first access
+ *
+ * The read value is kept until it is released, so that the variables of a
+ * large file that are not used are never read. The pipe has to stay open
+ * while the field is used.
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface, typename PipeType>
+class LazyField
+{
+  public:
+    LazyField(PipeType& pipe, const Field& field) : m_pipe(&pipe), m_field(field) {}
+
+    const ContainerType& get()
+    {
+        if (!m_value)
+        {
+            m_value = m_pipe->template read<ContainerType, ElementType, ContainerInterface>(m_field);
+        }
+        return *m_value;
+    }
+
+    const ContainerType& operator*() { return get(); }
+    const ContainerType* operator->() { return &get(); }
+
+    bool is_loaded() const { return m_value.has_value(); }
+
+    /**
+     * Free the read value, the next access reads it again
+     */
+    void release() { m_value.reset(); }
+
+  private:
+    PipeType* m_pipe{};
+    Field m_field;
+    std::optional<ContainerType> m_value{};
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ncdlgen
+{
+
+enum class NetCDFWriteMode
+{
+    // Write the variables from the start, with the current sizes of the dimensions
+    Overwrite,
+    // Append the variables with an unlimited first dimension after the records
+    // already in the file, other variables are overwritten
+    Append,
+};
+
+enum class NetCDFTypeConversion
+{
+    // Reading or writing elements of another type than the type of the variable throws
+    Strict,
+    // The elements are converted to and from the numeric type of the variable by
+    // ncdlgen, in a single pass over a buffer of the type of the variable. A value
+    // out of the range of the type converted to throws
+    Convert,
+};
+
+enum class NetCDFStorage
+{
+    // The file on the disk
+    Disk,
+    // The file is kept in memory while it is open, an existing file is read
+    // when it is opened
+    Diskless,
+    // The file is a memory buffer, that is handed over when the file is closed,
+    // see NetCDFPipe::open_memory() and close_memory()
+    Memory,
+};
+
+struct NetCDFConfiguration
+{
+    NetCDFWriteMode write_mode{NetCDFWriteMode::Overwrite};
+    NetCDFTypeConversion type_conversion{NetCDFTypeConversion::Strict};
+
+    NetCDFStorage storage{NetCDFStorage::Disk};
+    // Write the diskless or in-memory file to the path when it is closed
+    bool persist{false};
+    // The initial size of a file created in memory, the buffer grows as needed
+    std::size_t initial_memory_size{1024 * 1024};
+};
+
+enum class NetCDFSyncPolicy
+{
+    // The changes are written to the disk by sync() and when the file is closed
+    Explicit,
+    // flush() also writes the changes to the disk
+    OnFlush,
+    // The writer thread writes the changes to the disk after every sync_interval records
+    Periodic,
+};
+
+struct AsyncNetCDFConfiguration
+{
+    // The configuration of the NetCDFPipe owned by the writer thread
+    NetCDFConfiguration netcdf{};
+
+    // The maximum number of queued writes, a full queue blocks the writes
+    std::size_t queue_depth{1024};
+    // How long a write waits for space in the queue, -1 waits indefinitely
+    int send_timeout_ms{-1};
+
+    // Combine the consecutive records of the same variables into a single
+    // write of each variable
+    bool coalesce_records{true};
+
+    NetCDFSyncPolicy sync_policy{NetCDFSyncPolicy::Explicit};
+    // The records between the syncs of the Periodic policy
+    std::size_t sync_interval{100};
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "netcdf.h"
+
+namespace ncdlgen
+{
+
+/**
+ * The NetCDF type of the elements of the element type, NC_NAT if there is none
+ *
+ * The integers map by their size and signedness, so that e.g. both long and
+ * long long are NC_INT64 on platforms where they are 8 bytes.
+ */
+template <typename ElementType> constexpr nc_type nc_type_of()
+{
+    if constexpr (std::is_same_v<ElementType, char>)
+    {
+        return NC_CHAR;
+    }
+    else if constexpr (std::is_same_v<ElementType, float>)
+    {
+        return NC_FLOAT;
+    }
+    else if constexpr (std::is_same_v<ElementType, double>)
+    {
+        return NC_DOUBLE;
+    }
+    else if constexpr (std::is_integral_v<ElementType> && !std::is_same_v<ElementType, bool>)
+    {
+        constexpr bool is_signed = std::is_signed_v<ElementType>;
+        switch (sizeof(ElementType))
+        {
+        case 1:
+            return is_signed ? NC_BYTE : NC_UBYTE;
+        case 2:
+            return is_signed ? NC_SHORT : NC_USHORT;
+        case 4:
+            return is_signed ? NC_INT : NC_UINT;
+        case 8:
+            return is_signed ? NC_INT64 : NC_UINT64;
+        }
+        return NC_NAT;
+    }
+    else
+    {
+        return NC_NAT;
+    }
+}
+
+/**
+ * Whether the elements of the element type are read and written to a variable
+ * of the NetCDF type as they are
+ *
+ * The 1 byte integers are also the characters of NC_CHAR variables.
+ */
+template <typename ElementType> constexpr bool is_nc_type_of(nc_type type)
+{
+    if (type == NC_CHAR)
+    {
+        return std::is_integral_v<ElementType> && !std::is_same_v<ElementType, bool> &&
+               sizeof(ElementType) == 1;
+    }
+    return nc_type_of<ElementType>() == type;
+}
+
+/**
+ * The typed nc_put_vars and nc_get_vars functions of the NetCDF types
+ *
+ * A null stride accesses consecutive elements, i.e. it is nc_put_vara and nc_get_vara.
+ */
+template <nc_type Type> struct NetCDFTypedIO;
+
+template <> struct NetCDFTypedIO<NC_CHAR>
+{
+    using type = char;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_text(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_text(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_BYTE>
+{
+    using type = signed char;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_schar(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_schar(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_UBYTE>
+{
+    using type = unsigned char;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_uchar(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_uchar(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_SHORT>
+{
+    using type = short;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_short(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_short(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_USHORT>
+{
+    using type = unsigned short;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_ushort(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_ushort(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_INT>
+{
+    using type = int;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_int(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_int(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_UINT>
+{
+    using type = unsigned int;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_uint(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_uint(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_INT64>
+{
+    using type = long long;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_longlong(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_longlong(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_UINT64>
+{
+    using type = unsigned long long;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_ulonglong(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_ulonglong(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_FLOAT>
+{
+    using type = float;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_float(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_float(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+template <> struct NetCDFTypedIO<NC_DOUBLE>
+{
+    using type = double;
+    static int put(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, const type* data)
+    {
+        return nc_put_vars_double(group_id, variable_id, start, count, stride, data);
+    }
+    static int get(int group_id, int variable_id, const std::size_t* start, const std::size_t* count,
+                   const std::ptrdiff_t* stride, type* data)
+    {
+        return nc_get_vars_double(group_id, variable_id, start, count, stride, data);
+    }
+};
+
+/**
+ * Whether the value is in the range of the output type, so that converting it
+ * is defined. The floating point values are truncated towards zero when
+ * converted to integers, NaN is not in the range of the integers. The
+ * infinities and NaN stay as they are between the floating point types.
+ */
+template <typename OutputType, typename InputType> constexpr bool is_in_range(InputType value)
+{
+    using Limits = std::numeric_limits<OutputType>;
+    if constexpr (std::is_floating_point_v<InputType> && std::is_floating_point_v<OutputType>)
+    {
+        return std::isinf(value) || !(std::abs(value) > Limits::max());
+    }
+    else if constexpr (std::is_floating_point_v<InputType>)
+    {
+        // The powers of two of the limits are exact in the floating point type
+        auto truncated = std::trunc(value);
+        return truncated >= static_cast<InputType>(Limits::min()) &&
+               truncated < static_cast<InputType>(Limits::max() / 2 + 1) * 2;
+    }
+    else if constexpr (std::is_floating_point_v<OutputType>)
+    {
+        return true;
+    }
+    else if constexpr (std::is_signed_v<InputType> == std::is_signed_v<OutputType>)
+    {
+        return value >= Limits::min() && value <= Limits::max();
+    }
+    else if constexpr (std::is_signed_v<InputType>)
+    {
+        return value >= 0 && static_cast<std::make_unsigned_t<InputType>>(value) <= Limits::max();
+    }
+    else
+    {
+        return value <= static_cast<std::make_unsigned_t<OutputType>>(Limits::max());
+    }
+}
+
+/**
+ * Whether all the values of the input type are in the range of the output type
+ */
+template <typename OutputType, typename InputType> constexpr bool is_range_preserving()
+{
+    if constexpr (std::is_floating_point_v<OutputType>)
+    {
+        return std::is_integral_v<InputType> || sizeof(OutputType) >= sizeof(InputType);
+    }
+    else if constexpr (std::is_floating_point_v<InputType>)
+    {
+        return false;
+    }
+    else
+    {
+        return is_in_range<OutputType>(std::numeric_limits<InputType>::min()) &&
+               is_in_range<OutputType>(std::numeric_limits<InputType>::max());
+    }
+}
+
+/**
+ * Convert the elements in a plain loop over contiguous memory, which the
+ * compiler vectorises for the widening and narrowing of the arithmetic types,
+ * e.g. double to float. When the output type cannot hold all the values of the
+ * input type, the values are first checked in a separate pass, returns false
+ * without converting if one is out of range.
+ */
+template <typename OutputType, typename InputType>
+bool convert_elements(const InputType* __restrict input, OutputType* __restrict output, std::size_t size)
+{
+    if constexpr (!is_range_preserving<OutputType, InputType>())
+    {
+        bool in_range = true;
+        for (std::size_t i = 0; i < size; i++)
+        {
+            in_range &= is_in_range<OutputType>(input[i]);
+        }
+        if (!in_range)
+        {
+            return false;
+        }
+    }
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        output[i] = static_cast<OutputType>(input[i]);
+    }
+    return true;
+}
+
+/**
+ * Call the function with a null pointer of the element type of the numeric NetCDF
+ * type, returns false for the other types
+ */
+template <typename Function> bool visit_numeric_nc_type(nc_type type, Function&& function)
+{
+    switch (type)
+    {
+    case NC_BYTE:
+        function(static_cast<NetCDFTypedIO<NC_BYTE>::type*>(nullptr));
+        return true;
+    case NC_UBYTE:
+        function(static_cast<NetCDFTypedIO<NC_UBYTE>::type*>(nullptr));
+        return true;
+    case NC_SHORT:
+        function(static_cast<NetCDFTypedIO<NC_SHORT>::type*>(nullptr));
+        return true;
+    case NC_USHORT:
+        function(static_cast<NetCDFTypedIO<NC_USHORT>::type*>(nullptr));
+        return true;
+    case NC_INT:
+        function(static_cast<NetCDFTypedIO<NC_INT>::type*>(nullptr));
+        return true;
+    case NC_UINT:
+        function(static_cast<NetCDFTypedIO<NC_UINT>::type*>(nullptr));
+        return true;
+    case NC_INT64:
+        function(static_cast<NetCDFTypedIO<NC_INT64>::type*>(nullptr));
+        return true;
+    case NC_UINT64:
+        function(static_cast<NetCDFTypedIO<NC_UINT64>::type*>(nullptr));
+        return true;
+    case NC_FLOAT:
+        function(static_cast<NetCDFTypedIO<NC_FLOAT>::type*>(nullptr));
+        return true;
+    case NC_DOUBLE:
+        function(static_cast<NetCDFTypedIO<NC_DOUBLE>::type*>(nullptr));
+        return true;
+    }
+    return false;
+}
+
+} // namespace ncdlgen
@@ -1,22 +1,604 @@
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <fmt/core.h>
+#include <fstream>
+#include <iterator>
 
 #include "netcdf.h"
 
 #include "netcdf_pipe.h"
+#include "syntax.h"
+#include "types.h"
 #include "utils.h"
 
 namespace ncdlgen
 {
 
-void NetCDFPipe::throw_error(std::string_view message, int error_code)
+static void throw_netcdf_error(std::string_view message, int error_code)
 {
     throw std::runtime_error(
         fmt::format("Error with NetCDF function {}: '{}'.", message, nc_strerror(error_code)));
 }
 
+void NetCDFPipe::throw_error(std::string_view message, int error_code)
+{
+    throw_netcdf_error(message, error_code);
+}
+
+static std::string_view nc_type_name(nc_type type)
+{
+    switch (type)
+    {
+    case NC_BYTE:
+        return "byte";
+    case NC_UBYTE:
+        return "ubyte";
+    case NC_CHAR:
+        return "char";
+    case NC_SHORT:
+        return "short";
+    case NC_USHORT:
+        return "ushort";
+    case NC_INT:
+        return "int";
+    case NC_UINT:
+        return "uint";
+    case NC_INT64:
+        return "int64";
+    case NC_UINT64:
+        return "uint64";
+    case NC_FLOAT:
+        return "float";
+    case NC_DOUBLE:
+        return "double";
+    case NC_STRING:
+        return "string";
+    }
+    return "user defined";
+}
+
+void NetCDFPipe::throw_type_error(const Field& field, const VariableInfo& variable_info, nc_type element_type)
+{
+    throw std::runtime_error(fmt::format("Cannot use elements of type {} for '{}' of type {}{}.",
+                                         nc_type_name(element_type), field.path,
+                                         nc_type_name(variable_info.nc_type),
+                                         m_config.type_conversion == NetCDFTypeConversion::Convert
+                                             ? ""
+                                             : ", see NetCDFTypeConversion::Convert"));
+}
+
+void NetCDFPipe::throw_range_error(const Field& field, const VariableInfo& variable_info,
+                                   nc_type element_type)
+{
+    throw std::runtime_error(
+        fmt::format("A value is out of range converting the elements of type {} for '{}' of type {}.",
+                    nc_type_name(element_type), field.path, nc_type_name(variable_info.nc_type)));
+}
+
+static nc_type nc_type_for(NetCDFElementaryType type)
+{
+    switch (type)
+    {
+    case NetCDFElementaryType::Char:
+        return NC_CHAR;
+    case NetCDFElementaryType::Byte:
+        return NC_BYTE;
+    case NetCDFElementaryType::Ubyte:
+        return NC_UBYTE;
+    case NetCDFElementaryType::Short:
+        return NC_SHORT;
+    case NetCDFElementaryType::Ushort:
+        return NC_USHORT;
+    // Long is the old name of int
+    case NetCDFElementaryType::Int:
+    case NetCDFElementaryType::Long:
+        return NC_INT;
+    case NetCDFElementaryType::Uint:
+        return NC_UINT;
+    case NetCDFElementaryType::Int64:
+        return NC_INT64;
+    case NetCDFElementaryType::Uint64:
+        return NC_UINT64;
+    // Real is the old name of float
+    case NetCDFElementaryType::Float:
+    case NetCDFElementaryType::Real:
+        return NC_FLOAT;
+    case NetCDFElementaryType::Double:
+        return NC_DOUBLE;
+    case NetCDFElementaryType::String:
+        return NC_STRING;
+    default:
+        throw std::runtime_error(
+            fmt::format("NetCDF type '{}' has no NetCDF type id.", name_for_type(type)));
+    }
+}
+
+/**
+ * Call the function with a value of the C type of the numeric NetCDF type
+ */
+template <typename Function> static void visit_numeric_type(NetCDFElementaryType type, Function&& function)
+{
+    switch (type)
+    {
+    case NetCDFElementaryType::Byte:
+        return function(std::int8_t{});
+    case NetCDFElementaryType::Ubyte:
+        return function(std::uint8_t{});
+    case NetCDFElementaryType::Short:
+        return function(std::int16_t{});
+    case NetCDFElementaryType::Ushort:
+        return function(std::uint16_t{});
+    case NetCDFElementaryType::Int:
+    case NetCDFElementaryType::Long:
+        return function(std::int32_t{});
+    case NetCDFElementaryType::Uint:
+        return function(std::uint32_t{});
+    case NetCDFElementaryType::Int64:
+        return function(std::int64_t{});
+    case NetCDFElementaryType::Uint64:
+        return function(std::uint64_t{});
+    case NetCDFElementaryType::Float:
+    case NetCDFElementaryType::Real:
+        return function(float{});
+    case NetCDFElementaryType::Double:
+        return function(double{});
+    default:
+        throw std::runtime_error(fmt::format("NetCDF type '{}' is not numeric.", name_for_type(type)));
+    }
+}
+
+static std::size_t size_of_type(NetCDFElementaryType type)
+{
+    switch (type)
+    {
+    case NetCDFElementaryType::Char:
+        return 1;
+    case NetCDFElementaryType::String:
+        return sizeof(char*);
+    default:
+    {
+        std::size_t size{};
+        visit_numeric_type(type, [&](auto value) { size = sizeof(value); });
+        return size;
+    }
+    }
+}
+
+// The in-memory layout of the elements of variable length types, nc_vlen_t
+struct VLenElement
+{
+    std::size_t length{};
+    void* data{};
+};
+
+/**
+ * A user defined type in the file, with the size and alignment of its
+ * in-memory elements for the compound types that contain it
+ */
+struct DefinedType
+{
+    nc_type id{};
+    std::size_t size{};
+    std::size_t alignment{1};
+};
+
+/**
+ * The special attributes of ncgen that set the storage of the file and the
+ * variables. The other attributes starting with an underscore, e.g. _FillValue,
+ * _Unsigned or _CoordinateAxisType, are stored as usual.
+ */
+static bool is_virtual_attribute(std::string_view name)
+{
+    static constexpr std::array<std::string_view, 11> virtual_attributes{
+        "_Storage", "_ChunkSizes", "_DeflateLevel", "_Shuffle",      "_Fletcher32",        "_Endianness",
+        "_NoFill",  "_Format",     "_IsNetcdf4",    "_NCProperties", "_SuperblockVersion"};
+    return std::find(virtual_attributes.begin(), virtual_attributes.end(), name) != virtual_attributes.end();
+}
+
+/**
+ * Define the contents of a new file from the parsed CDL tree
+ */
+class CDLDefinition
+{
+  public:
+    // The dimensions of the parent groups are visible to the sub groups
+    using Dimensions = std::map<std::string, int, std::less<>>;
+
+    void define_group(int group_id, const Group& group, Dimensions dimensions)
+    {
+        m_variables.clear();
+        for (auto& type : group.types())
+        {
+            define_type(group_id, type);
+        }
+
+        for (auto& dimension : group.dimensions())
+        {
+            // Unlimited dimensions are parsed with zero length
+            int dimension_id{};
+            auto length = dimension.length == 0 ? NC_UNLIMITED : dimension.length;
+            check(nc_def_dim(group_id, dimension.name.c_str(), length, &dimension_id),
+                  fmt::format("nc_def_dim ({})", dimension.name));
+            dimensions[dimension.name] = dimension_id;
+        }
+
+        for (auto& variable : group.variables())
+        {
+            define_variable(group_id, variable, dimensions);
+        }
+
+        for (auto& attribute : group.attributes())
+        {
+            define_attribute(group_id, attribute);
+        }
+
+        for (auto& sub_group : group.groups())
+        {
+            int sub_group_id{};
+            std::string name{sub_group.name()};
+            check(nc_def_grp(group_id, name.c_str(), &sub_group_id), fmt::format("nc_def_grp ({})", name));
+            define_group(sub_group_id, sub_group, dimensions);
+        }
+    }
+
+  private:
+    static void check(int error_code, std::string_view message)
+    {
+        if (error_code)
+        {
+            throw_netcdf_error(message, error_code);
+        }
+    }
+
+    static std::size_t align(std::size_t offset, std::size_t alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * The user defined types are found by the name, the types of the other
+     * groups are referred to with the name of the type
+     */
+    const DefinedType& defined_type(const std::string& name) const
+    {
+        auto found = m_types.find(name);
+        if (found == m_types.end())
+        {
+            throw std::runtime_error(fmt::format("Type '{}' is used before it is defined.", name));
+        }
+        return found->second;
+    }
+
+    nc_type type_id(const NetCDFType& type) const
+    {
+        if (auto complex_type = type.as_complex_type())
+        {
+            return defined_type(complex_type->name()).id;
+        }
+        return nc_type_for(std::get<NetCDFElementaryType>(type.type));
+    }
+
+    void define_type(int group_id, const ComplexType& type)
+    {
+        DefinedType defined{};
+        std::visit(
+            [&](auto&& arg)
+            {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, OpaqueType>)
+                {
+                    check(nc_def_opaque(group_id, arg.length, arg.name.c_str(), &defined.id),
+                          fmt::format("nc_def_opaque ({})", arg.name));
+                    defined.size = arg.length;
+                }
+                else if constexpr (std::is_same_v<T, EnumType>)
+                {
+                    check(nc_def_enum(group_id, nc_type_for(arg.type), arg.name.c_str(), &defined.id),
+                          fmt::format("nc_def_enum ({})", arg.name));
+                    for (auto& enum_value : arg.enum_values)
+                    {
+                        visit_numeric_type(arg.type,
+                                           [&](auto value)
+                                           {
+                                               value = static_cast<decltype(value)>(enum_value.value);
+                                               check(nc_insert_enum(group_id, defined.id,
+                                                                    enum_value.name.c_str(), &value),
+                                                     fmt::format("nc_insert_enum ({})", enum_value.name));
+                                           });
+                    }
+                    defined.size = size_of_type(arg.type);
+                    defined.alignment = defined.size;
+                }
+                else if constexpr (std::is_same_v<T, VLenType>)
+                {
+                    check(nc_def_vlen(group_id, arg.name.c_str(), nc_type_for(arg.type), &defined.id),
+                          fmt::format("nc_def_vlen ({})", arg.name));
+                    defined.size = sizeof(VLenElement);
+                    defined.alignment = alignof(VLenElement);
+                }
+                else if constexpr (std::is_same_v<T, CompoundType>)
+                {
+                    defined = define_compound(group_id, arg);
+                }
+                else if constexpr (std::is_same_v<T, ArrayType>)
+                {
+                    throw std::runtime_error(
+                        fmt::format("Array type '{}' is only supported within compound types.", arg.name));
+                }
+                else
+                {
+                    static_assert(always_false_v<T>, "Visiting unsupported type!");
+                }
+            },
+            type.type);
+        m_types[type.name()] = defined;
+    }
+
+    /**
+     * The members are laid out as in a C struct with the same members
+     */
+    DefinedType define_compound(int group_id, const CompoundType& type)
+    {
+        struct Member
+        {
+            std::size_t offset{};
+            const ComplexType* type{};
+        };
+        std::vector<Member> members{};
+
+        DefinedType defined{};
+        for (auto& member_type : type.types)
+        {
+            std::size_t size{};
+            std::size_t alignment{};
+            if (auto* array_type = std::get_if<ArrayType>(&member_type.type))
+            {
+                size = size_of_type(array_type->type);
+                alignment = size;
+                for (auto& dimension : array_type->dimensions.dimensions)
+                {
+                    size *= dimension.length;
+                }
+            }
+            else
+            {
+                auto& member_defined = defined_type(member_type.name());
+                size = member_defined.size;
+                alignment = member_defined.alignment;
+            }
+            auto offset = align(defined.size, alignment);
+            members.push_back({offset, &member_type});
+            defined.size = offset + size;
+            defined.alignment = std::max(defined.alignment, alignment);
+        }
+        defined.size = align(defined.size, defined.alignment);
+
+        check(nc_def_compound(group_id, defined.size, type.name.c_str(), &defined.id),
+              fmt::format("nc_def_compound ({})", type.name));
+        for (std::size_t i = 0; i < members.size(); i++)
+        {
+            auto& name = type.type_names.at(i);
+            auto& member = members[i];
+            if (auto* array_type = std::get_if<ArrayType>(&member.type->type))
+            {
+                std::vector<int> sizes{};
+                for (auto& dimension : array_type->dimensions.dimensions)
+                {
+                    sizes.push_back(static_cast<int>(dimension.length));
+                }
+                check(nc_insert_array_compound(group_id, defined.id, name.c_str(), member.offset,
+                                               nc_type_for(array_type->type), static_cast<int>(sizes.size()),
+                                               sizes.data()),
+                      fmt::format("nc_insert_array_compound ({})", name));
+            }
+            else
+            {
+                check(nc_insert_compound(group_id, defined.id, name.c_str(), member.offset,
+                                         defined_type(member.type->name()).id),
+                      fmt::format("nc_insert_compound ({})", name));
+            }
+        }
+        return defined;
+    }
+
+    void define_variable(int group_id, const Variable& variable, const Dimensions& dimensions)
+    {
+        std::string name{variable.name()};
+        std::vector<int> dimension_ids{};
+        for (auto& dimension : variable.dimensions())
+        {
+            auto found = dimensions.find(dimension.name());
+            if (found == dimensions.end())
+            {
+                throw std::runtime_error(
+                    fmt::format("Variable '{}' has undefined dimension '{}'.", name, dimension.name()));
+            }
+            dimension_ids.push_back(found->second);
+        }
+
+        int variable_id{};
+        check(nc_def_var(group_id, name.c_str(), type_id(variable.type()),
+                         static_cast<int>(dimension_ids.size()), dimension_ids.data(), &variable_id),
+              fmt::format("nc_def_var ({})", name));
+        define_storage(group_id, variable_id, name, variable.storage(), dimension_ids.size());
+        m_variables[name] = variable_id;
+    }
+
+    static void define_storage(int group_id, int variable_id, const std::string& name,
+                               const VariableStorage& storage, std::size_t rank)
+    {
+        if (storage.has_layout())
+        {
+            // The chunk sizes imply the chunked layout
+            auto layout = storage.layout.value_or(StorageLayout::Chunked);
+            const std::size_t* chunk_sizes{};
+            if (layout == StorageLayout::Chunked && !storage.chunk_sizes.empty())
+            {
+                if (storage.chunk_sizes.size() != rank)
+                {
+                    throw std::runtime_error(
+                        fmt::format("Variable '{}' of {} dimensions has {} chunk sizes.", name, rank,
+                                    storage.chunk_sizes.size()));
+                }
+                chunk_sizes = storage.chunk_sizes.data();
+            }
+
+            int nc_layout{NC_CHUNKED};
+            if (layout == StorageLayout::Contiguous)
+            {
+                nc_layout = NC_CONTIGUOUS;
+            }
+            else if (layout == StorageLayout::Compact)
+            {
+                nc_layout = NC_COMPACT;
+            }
+            check(nc_def_var_chunking(group_id, variable_id, nc_layout, chunk_sizes),
+                  fmt::format("nc_def_var_chunking ({})", name));
+        }
+
+        if (storage.has_filters())
+        {
+            check(nc_def_var_deflate(group_id, variable_id, storage.shuffle.value_or(false),
+                                     storage.deflate_level.has_value(), storage.deflate_level.value_or(0)),
+                  fmt::format("nc_def_var_deflate ({})", name));
+        }
+    }
+
+    void define_attribute(int group_id, const Attribute& attribute)
+    {
+        std::string name{attribute.name()};
+
+        // The virtual attributes describe the storage and are not stored as attributes
+        if (is_virtual_attribute(name))
+        {
+            return;
+        }
+
+        // The attributes are parsed after the variables of their group
+        int variable_id{NC_GLOBAL};
+        if (!attribute.variable_name().empty())
+        {
+            auto found = m_variables.find(attribute.variable_name());
+            if (found == m_variables.end())
+            {
+                throw std::runtime_error(fmt::format("Attribute '{}' of undefined variable '{}'.", name,
+                                                     attribute.variable_name()));
+            }
+            variable_id = found->second;
+        }
+
+        auto type = attribute.type();
+        // The numbers are put as a single element of the variable length type
+        std::optional<VLenType> vlen_type{};
+        if (auto complex_type = type ? type->as_complex_type() : std::nullopt)
+        {
+            if (auto* vlen = std::get_if<VLenType>(&complex_type->type))
+            {
+                vlen_type = *vlen;
+            }
+            else
+            {
+                throw std::runtime_error(
+                    fmt::format("Attribute '{}' of type '{}' is not supported.", name, complex_type->name()));
+            }
+        }
+
+        auto put_numbers = [&](NetCDFElementaryType number_type, const std::vector<Number>& numbers)
+        {
+            visit_numeric_type(
+                vlen_type ? vlen_type->type : number_type,
+                [&](auto value)
+                {
+                    using ValueType = decltype(value);
+                    std::vector<ValueType> values{};
+                    for (auto& number : numbers)
+                    {
+                        values.push_back(std::visit([](auto number_value)
+                                                    { return static_cast<ValueType>(number_value); },
+                                                    number.value));
+                    }
+
+                    if (vlen_type)
+                    {
+                        VLenElement element{values.size(), values.data()};
+                        auto vlen_id = defined_type(vlen_type->name).id;
+                        check(nc_put_att(group_id, variable_id, name.c_str(), vlen_id, 1, &element),
+                              fmt::format("nc_put_att ({})", name));
+                    }
+                    else
+                    {
+                        check(nc_put_att(group_id, variable_id, name.c_str(), nc_type_for(number_type),
+                                         values.size(), values.data()),
+                              fmt::format("nc_put_att ({})", name));
+                    }
+                });
+        };
+        auto put_text = [&](std::string_view value)
+        {
+            // Unparsed values keep the quotes of the CDL
+            auto text = unquoted(value);
+            check(nc_put_att_text(group_id, variable_id, name.c_str(), text.size(), text.data()),
+                  fmt::format("nc_put_att_text ({})", name));
+        };
+        auto number_type = [&](const Number& number)
+        {
+            if (type && !vlen_type && std::holds_alternative<NetCDFElementaryType>(type->type))
+            {
+                return std::get<NetCDFElementaryType>(type->type);
+            }
+            return number.netcdf_type;
+        };
+
+        std::visit(
+            [&](auto&& arg)
+            {
+                using T = std::decay_t<decltype(arg)>;
+                if constexpr (std::is_same_v<T, std::string>)
+                {
+                    put_text(arg);
+                }
+                else if constexpr (std::is_same_v<T, ValidRangeValue>)
+                {
+                    put_numbers(number_type(arg.start), {arg.start, arg.end});
+                }
+                else if constexpr (std::is_same_v<T, FillValueAttributeValue>)
+                {
+                    put_numbers(number_type(arg), {arg});
+                }
+                else if constexpr (std::is_same_v<T, VariableData>)
+                {
+                    if (auto* number = std::get_if<Number>(&arg.data))
+                    {
+                        put_numbers(number_type(*number), {*number});
+                    }
+                    else if (auto* string = std::get_if<String>(&arg.data))
+                    {
+                        put_text(string->value);
+                    }
+                    else if (auto& array = std::get<Array>(arg.data); !array.data.empty())
+                    {
+                        put_numbers(number_type(array.data.front()), array.data);
+                    }
+                }
+                else
+                {
+                    static_assert(always_false_v<T>, "Visiting unsupported attribute value!");
+                }
+            },
+            attribute.value());
+    }
+
+    std::map<std::string, DefinedType, std::less<>> m_types{};
+    // The variables of the group being defined, by the name
+    std::map<std::string, int, std::less<>> m_variables{};
+};
+
 void NetCDFPipe::assert_open()
 {
     if (root_id < 0)
@@ -25,12 +607,300 @@ void NetCDFPipe::assert_open()
     }
 }
 
+void NetCDFPipe::check_slab(const Field& field, const VariableInfo& variable_info,
+                            const std::vector<std::size_t>& start, const std::vector<std::size_t>& count,
+                            const std::vector<std::ptrdiff_t>& stride)
+{
+    const auto rank = variable_info.dimension_ids.size();
+    if (start.size() != rank || count.size() != rank || (!stride.empty() && stride.size() != rank))
+    {
+        throw std::runtime_error(
+            fmt::format("Slab of '{}' with {} start, {} count and {} stride indices, the variable has {} "
+                        "dimensions.",
+                        field.path, start.size(), count.size(), stride.size(), rank));
+    }
+}
+
+void NetCDFPipe::check_records(const Field& field, const VariableInfo& variable_info,
+                               const std::vector<std::size_t>& dimension_sizes)
+{
+    const auto rank = variable_info.dimension_sizes.size();
+    if (dimension_sizes.size() != rank)
+    {
+        throw std::runtime_error(fmt::format("Appending records of {} dimensions to '{}' of {} dimensions.",
+                                             dimension_sizes.size(), field.path, rank));
+    }
+    for (std::size_t i = 1; i < rank; i++)
+    {
+        if (dimension_sizes[i] != variable_info.dimension_sizes[i])
+        {
+            throw std::runtime_error(
+                fmt::format("Appending records of size {} to '{}', the records have size {} in dimension {}.",
+                            dimension_sizes[i], field.path, variable_info.dimension_sizes[i], i));
+        }
+    }
+}
+
+void NetCDFPipe::check_shape(const Field& field, const VariableInfo& variable_info,
+                             const std::size_t* dimension_sizes, std::size_t rank)
+{
+    if (rank != variable_info.dimension_sizes.size())
+    {
+        throw std::runtime_error(fmt::format("Writing data of {} dimensions to '{}' of {} dimensions.", rank,
+                                             field.path, variable_info.dimension_sizes.size()));
+    }
+    for (std::size_t i = 0; i < rank; i++)
+    {
+        if (dimension_sizes[i] != variable_info.dimension_sizes[i])
+        {
+            throw std::runtime_error(
+                fmt::format("Writing data of size {} to '{}', the variable has size {} in dimension {}.",
+                            dimension_sizes[i], field.path, variable_info.dimension_sizes[i], i));
+        }
+    }
+}
+
+std::size_t NetCDFPipe::number_of_records(const Field& field, const VariableInfo& variable_info,
+                                          std::size_t number_of_elements)
+{
+    std::size_t record_size{1};
+    for (std::size_t i = 1; i < variable_info.dimension_sizes.size(); i++)
+    {
+        record_size *= variable_info.dimension_sizes[i];
+    }
+    if (record_size == 0 || number_of_elements % record_size != 0)
+    {
+        throw std::runtime_error(fmt::format("Appending {} elements to '{}' with records of {} elements.",
+                                             number_of_elements, field.path, record_size));
+    }
+    return number_of_elements / record_size;
+}
+
+bool NetCDFPipe::is_record_variable(const VariableInfo& variable_info) const
+{
+    return !variable_info.unlimited_dimensions.empty() && variable_info.unlimited_dimensions.front();
+}
+
+std::size_t NetCDFPipe::record_index(const VariableInfo& variable_info)
+{
+    // The first append continues after the records already in the file
+    auto [records, inserted] = m_records.try_emplace(variable_info.dimension_ids.front());
+    if (inserted)
+    {
+        records->second.next = variable_info.dimension_sizes.front();
+    }
+    return records->second.next;
+}
+
+void NetCDFPipe::add_records(const VariableInfo& variable_info, std::size_t count)
+{
+    auto& records = m_records.at(variable_info.dimension_ids.front());
+    records.pending = std::max(records.pending, count);
+    if (m_record_depth == 0)
+    {
+        advance_records();
+    }
+}
+
+void NetCDFPipe::advance_records()
+{
+    for (auto& [dimension_id, records] : m_records)
+    {
+        records.next += records.pending;
+        records.pending = 0;
+    }
+}
+
+bool NetCDFPipe::appends(const Field& field)
+{
+    return m_config.write_mode == NetCDFWriteMode::Append && is_record_variable(variable(field));
+}
+
+std::size_t NetCDFPipe::next_record(const Field& field)
+{
+    const auto& variable_info = variable(field);
+    if (!is_record_variable(variable_info))
+    {
+        throw std::runtime_error(
+            fmt::format("Variable '{}' has no records, its first dimension is not unlimited.", field.path));
+    }
+    return record_index(variable_info);
+}
+
+void NetCDFPipe::begin_record() { m_record_depth++; }
+
+void NetCDFPipe::end_record()
+{
+    if (m_record_depth > 0 && --m_record_depth == 0)
+    {
+        advance_records();
+    }
+}
+
+void NetCDFPipe::discard_record()
+{
+    m_record_depth = 0;
+    for (auto& [dimension_id, records] : m_records)
+    {
+        records.pending = 0;
+    }
+}
+
 void NetCDFPipe::open()
 {
-    if (auto res = nc_open(path.c_str(), NC_WRITE, &root_id))
+    if (m_config.storage == NetCDFStorage::Memory)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file)
+        {
+            throw std::runtime_error(fmt::format("Cannot read '{}' to memory.", path.string()));
+        }
+        open_memory(std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), {}));
+        return;
+    }
+
+    clear_cache();
+    m_records.clear();
+    m_record_depth = 0;
+    m_in_memory = false;
+
+    int mode = NC_WRITE;
+    if (m_config.storage == NetCDFStorage::Diskless)
+    {
+        mode |= NC_DISKLESS | (m_config.persist ? NC_PERSIST : 0);
+    }
+    // The files the library created in memory are only opened for reading, see open_memory
+    auto res = nc_open(path.c_str(), mode, &root_id);
+    if (res == NC_ECANTWRITE)
+    {
+        res = nc_open(path.c_str(), mode & ~NC_WRITE, &root_id);
+    }
+    if (res)
+    {
+        throw_error("nc_open", res);
+    }
+    resolve_schema();
+}
+
+void NetCDFPipe::open_memory(const std::vector<std::uint8_t>& buffer)
+{
+    close();
+    clear_cache();
+    m_records.clear();
+    m_record_depth = 0;
+
+    // The library takes the ownership of the memory, and reallocates it when the file grows.
+    // It also releases the memory when the file cannot be opened
+    auto open_copy = [&](int mode)
+    {
+        NC_memio memio{};
+        memio.size = buffer.size();
+        memio.memory = std::malloc(buffer.size());
+        if (!memio.memory)
+        {
+            throw std::bad_alloc();
+        }
+        std::memcpy(memio.memory, buffer.data(), buffer.size());
+        return nc_open_memio(path.c_str(), mode, &memio, &root_id);
+    };
+
+    // The library does not open the files it created in memory for writing, their
+    // superblock does not track the creation order of the links. They are opened
+    // read-only instead
+    auto res = open_copy(NC_WRITE);
+    if (res == NC_ECANTWRITE)
+    {
+        res = open_copy(NC_NOWRITE);
+    }
+    if (res)
+    {
+        root_id = -1;
+        throw_error("nc_open_memio", res);
+    }
+    m_in_memory = true;
+    resolve_schema();
+}
+
+std::vector<std::uint8_t> NetCDFPipe::close_memory()
+{
+    assert_open();
+    if (!m_in_memory)
+    {
+        throw std::runtime_error(fmt::format("Cannot close '{}' to memory, it is not in memory.", path.string()));
+    }
+
+    // The ids are not valid after closing the file
+    clear_cache();
+    m_records.clear();
+    m_record_depth = 0;
+    m_in_memory = false;
+
+    // The final memory of the file is handed over to us
+    NC_memio memio{};
+    auto res = nc_close_memio(root_id, &memio);
+    root_id = -1;
+    if (res)
+    {
+        throw_error("nc_close_memio", res);
+    }
+
+    auto* memory = static_cast<const std::uint8_t*>(memio.memory);
+    std::vector<std::uint8_t> buffer(memory, memory + memio.size);
+    std::free(memio.memory);
+    return buffer;
+}
+
+void NetCDFPipe::create_from_schema(const RootGroup& root)
+{
+    if (!root.group)
+    {
+        throw std::runtime_error(fmt::format("Creating '{}' from an empty CDL tree.", path.string()));
+    }
+
+    close();
+    clear_cache();
+    m_records.clear();
+    m_record_depth = 0;
+
+    int res{};
+    m_in_memory = m_config.storage == NetCDFStorage::Memory;
+    if (m_in_memory)
+    {
+        res = nc_create_mem(path.c_str(), NC_NETCDF4, m_config.initial_memory_size, &root_id);
+    }
+    else
     {
+        int mode = NC_NETCDF4 | NC_CLOBBER;
+        if (m_config.storage == NetCDFStorage::Diskless)
+        {
+            mode |= NC_DISKLESS | (m_config.persist ? NC_PERSIST : 0);
+        }
+        res = nc_create(path.c_str(), mode, &root_id);
+    }
+    if (res)
+    {
+        root_id = -1;
+        m_in_memory = false;
         throw_error("nc_create", res);
     }
+
+    try
+    {
+        CDLDefinition definition{};
+        definition.define_group(root_id, *root.group, {});
+        if (auto res = nc_enddef(root_id))
+        {
+            throw_error("nc_enddef", res);
+        }
+    }
+    catch (...)
+    {
+        nc_close(root_id);
+        root_id = -1;
+        m_in_memory = false;
+        throw;
+    }
+    resolve_schema();
 }
 
 void NetCDFPipe::close()
@@ -40,12 +910,194 @@ void NetCDFPipe::close()
         return;
     }
 
-    if (auto res = nc_close(root_id))
+    // The memory buffer is discarded, unless it is persisted to the path
+    if (m_in_memory)
+    {
+        auto buffer = close_memory();
+        if (m_config.persist)
+        {
+            std::ofstream file{path, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            if (!file)
+            {
+                throw std::runtime_error(fmt::format("Cannot persist '{}' from memory.", path.string()));
+            }
+        }
+        return;
+    }
+
+    // The ids are not valid after closing the file
+    clear_cache();
+    m_records.clear();
+    m_record_depth = 0;
+    auto res = nc_close(root_id);
+    root_id = -1;
+    if (res)
     {
         throw_error("nc_close", res);
     }
 }
 
+void NetCDFPipe::sync()
+{
+    assert_open();
+    if (auto res = nc_sync(root_id))
+    {
+        throw_error("nc_sync", res);
+    }
+}
+
+void NetCDFPipe::redef()
+{
+    assert_open();
+
+    // Defining can change the variables and dimensions
+    clear_cache();
+    if (auto res = nc_redef(root_id))
+    {
+        throw_error("nc_redef", res);
+    }
+}
+
+void NetCDFPipe::enddef()
+{
+    assert_open();
+    if (auto res = nc_enddef(root_id))
+    {
+        throw_error("nc_enddef", res);
+    }
+    resolve_schema();
+}
+
+void NetCDFPipe::clear_cache()
+{
+    m_schema_variables.clear();
+    m_variables.clear();
+}
+
+void NetCDFPipe::use_schema(const Schema& schema)
+{
+    m_schema = schema;
+    m_schema_variables.clear();
+    if (root_id >= 0)
+    {
+        resolve_schema();
+    }
+}
+
+void NetCDFPipe::resolve_schema()
+{
+    if (!m_schema)
+    {
+        return;
+    }
+
+    m_schema_variables.assign(m_schema->paths.size(), {});
+    for (std::size_t id = 0; id < m_schema->paths.size(); id++)
+    {
+        try
+        {
+            // The cached variables are not moved by later insertions
+            m_schema_variables[id].variable = &find_variable(m_schema->paths[id]);
+        }
+        catch (const std::runtime_error&)
+        {
+            // Not in the file, resolved by the path when used
+        }
+    }
+}
+
+NetCDFCacheStatistics NetCDFPipe::cache_statistics() const { return m_cache_statistics; }
+
+void NetCDFPipe::set_chunk_cache(const Field& field, const NetCDFChunkCache& cache)
+{
+    const auto& variable_info = variable(field);
+    if (auto res = nc_set_var_chunk_cache(variable_info.group_id, variable_info.variable_id, cache.size,
+                                          cache.slots, cache.preemption))
+    {
+        throw_error(fmt::format("nc_set_var_chunk_cache ({})", field.path), res);
+    }
+}
+
+NetCDFChunkCache NetCDFPipe::chunk_cache(const Field& field)
+{
+    const auto& variable_info = variable(field);
+    NetCDFChunkCache cache{};
+    if (auto res = nc_get_var_chunk_cache(variable_info.group_id, variable_info.variable_id, &cache.size,
+                                          &cache.slots, &cache.preemption))
+    {
+        throw_error(fmt::format("nc_get_var_chunk_cache ({})", field.path), res);
+    }
+    return cache;
+}
+
+NetCDFPipe::VariableInfo& NetCDFPipe::find_variable(const std::string_view path)
+{
+    assert_open();
+
+    if (auto found = m_variables.find(path); found != m_variables.end())
+    {
+        m_cache_statistics.hits++;
+
+        auto& variable_info = found->second;
+        update_unlimited_dimensions(variable_info);
+        return variable_info;
+    }
+
+    m_cache_statistics.misses++;
+    auto variable_info = get_variable_info(resolve_path(path));
+
+    // Unlimited dimensions
+    auto unlimited_dimension_ids = get_unlimited_dimension_ids(path);
+    for (auto& dimension_id : variable_info.dimension_ids)
+    {
+        variable_info.unlimited_dimensions.push_back(
+            std::find(unlimited_dimension_ids.begin(), unlimited_dimension_ids.end(), dimension_id) !=
+            unlimited_dimension_ids.end());
+    }
+    return m_variables.emplace(std::string{path}, std::move(variable_info)).first->second;
+}
+
+const NetCDFPipe::VariableInfo& NetCDFPipe::variable(const Field& field)
+{
+    if (field.has_id() && field.id < m_schema_variables.size() && m_schema_variables[field.id].variable)
+    {
+        // An id of another schema would write to the wrong variable. The path is
+        // compared only when the field passes another string than the last time
+        auto& schema_variable = m_schema_variables[field.id];
+        if (field.path.data() != schema_variable.checked_path.data() ||
+            field.path.size() != schema_variable.checked_path.size())
+        {
+            if (m_schema->paths[field.id] != field.path)
+            {
+                throw std::runtime_error(
+                    fmt::format("NetCDFPipe: field id {} is '{}' in the schema, not '{}'.", field.id,
+                                m_schema->paths[field.id], field.path));
+            }
+            schema_variable.checked_path = field.path;
+        }
+        m_cache_statistics.hits++;
+
+        auto& variable_info = *schema_variable.variable;
+        update_unlimited_dimensions(variable_info);
+        return variable_info;
+    }
+    return find_variable(field.path);
+}
+
+void NetCDFPipe::update_unlimited_dimensions(VariableInfo& variable_info)
+{
+    // Writing can grow the unlimited dimensions
+    for (std::size_t i = 0; i < variable_info.dimension_ids.size(); i++)
+    {
+        if (variable_info.unlimited_dimensions[i])
+        {
+            variable_info.dimension_sizes[i] =
+                get_dimension_size(Path{variable_info.group_id, variable_info.dimension_ids[i]});
+        }
+    }
+}
+
 NetCDFPipe::Path NetCDFPipe::resolve_path(const std::string_view path)
 {
     assert_open();
@@ -145,4 +1197,37 @@ std::size_t NetCDFPipe::get_dimension_size(const Path& path)
     return dimension_length;
 }
 
+std::vector<int> NetCDFPipe::get_unlimited_dimension_ids(const std::string_view path)
+{
+    assert_open();
+
+    // The variable can use the unlimited dimensions of its group and the parent groups
+    auto split_path = split_string(path, '/');
+    assert(split_path.size() > 0);
+
+    std::vector<int> dimension_ids{};
+    int group_id{root_id};
+    for (size_t i = 0; i < split_path.size(); i++)
+    {
+        int count{};
+        if (auto ret = nc_inq_unlimdims(group_id, &count, nullptr))
+        {
+            throw_error("nc_inq_unlimdims", ret);
+        }
+
+        auto offset = dimension_ids.size();
+        dimension_ids.resize(offset + static_cast<std::size_t>(count));
+        if (auto ret = nc_inq_unlimdims(group_id, &count, dimension_ids.data() + offset))
+        {
+            throw_error("nc_inq_unlimdims", ret);
+        }
+
+        if (i + 1 < split_path.size())
+        {
+            group_id = get_group_id(group_id, split_path.at(i));
+        }
+    }
+    return dimension_ids;
+}
+
 } // namespace ncdlgen
\ No newline at end of file
@@ -2,18 +2,53 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "netcdf.h"
 #include <fmt/core.h>
 
+#include "array_span_interface.h"
+#include "netcdf_configuration.h"
+#include "netcdf_element_type.h"
+#include "pipe_data.h"
+#include "record_scope.h"
+#include "schema.h"
 #include "utils.h"
 #include "vector_interface.h"
 
 namespace ncdlgen
 {
 
+struct RootGroup;
+
+struct NetCDFCacheStatistics
+{
+    // Reads and writes that found the variable in the cache
+    std::size_t hits{};
+    // Reads and writes that resolved the variable from the file
+    std::size_t misses{};
+};
+
+/**
+ * The chunk cache of a chunked variable, see nc_set_var_chunk_cache
+ */
+struct NetCDFChunkCache
+{
+    // The size of the cache in bytes
+    std::size_t size{};
+    // The number of chunks the cache can hold
+    std::size_t slots{};
+    // How readily the fully read or written chunks are evicted, between 0 and 1
+    float preemption{};
+};
+
 /**
  * Write and read data from netcdf.
  *
@@ -25,12 +60,50 @@ namespace ncdlgen
 class NetCDFPipe
 {
   public:
-    NetCDFPipe(std::string_view file_path) : path(file_path) {}
+    NetCDFPipe(std::string_view file_path, const NetCDFConfiguration& config = {})
+        : path(file_path), m_config(config)
+    {
+    }
 
     virtual ~NetCDFPipe() = default;
 
+    /**
+     * Open the file of the path, for the Memory storage the file is read to a
+     * memory buffer
+     */
     void open();
     void close();
+    bool is_open() const { return root_id >= 0; }
+
+    /**
+     * Open the contents of a NetCDF file from a memory buffer, e.g. a file
+     * received as a single message, for reading and writing
+     *
+     * The path only names the file, unless it is persisted when closed.
+     */
+    void open_memory(const std::vector<std::uint8_t>& buffer);
+
+    /**
+     * Close the file opened or created in memory and return its contents
+     */
+    std::vector<std::uint8_t> close_memory();
+
+    /**
+     * Create the file from the parsed CDL, replacing an existing file
+     *
+     * The user defined types, dimensions, variables, attributes and groups of
+     * the tree are defined in a single define mode pass, without a file made
+     * by ncgen. The storage of the variables follows the special attributes
+     * _Storage, _ChunkSizes, _DeflateLevel and _Shuffle. The file is left open
+     * for reading and writing. The data section is not applied. With the Diskless
+     * and Memory storage the file is created in memory.
+     */
+    void create_from_schema(const RootGroup& root);
+
+    /**
+     * Write the changes of the open file to the disk
+     */
+    void sync();
 
     struct Path
     {
@@ -58,41 +131,115 @@ class NetCDFPipe
         std::vector<int32_t> dimension_ids{};
         std::vector<std::size_t> dimension_sizes{};
         int32_t nc_type{};
+        // Whether each dimension is unlimited, the size of which can grow,
+        // resolved by variable()
+        std::vector<bool> unlimited_dimensions{};
     };
 
     VariableInfo get_variable_info(const Path& path);
 
+    /**
+     * Resolve the variable of the field, e.g. /group/variable
+     *
+     * The resolved variables are cached by the path until the file is closed
+     * or put to define mode. Only the sizes of the unlimited dimensions are
+     * queried again for a cached variable. When a schema is in use, the
+     * variables of fields with an id are found by the id.
+     */
+    const VariableInfo& variable(const Field& field);
+
+    /**
+     * Use the schema of a generated interface
+     *
+     * All the variables of the schema are resolved when the file is opened, and
+     * the reads and writes of the generated interface find the variables by the
+     * field id from a table, without looking up the paths. The variables missing
+     * from the file are resolved by the path when they are used. A field whose
+     * path does not match the path of its id in the schema is an error.
+     */
+    void use_schema(const Schema& schema);
+
+    /**
+     * Put the open file to define mode and back to data mode, entering
+     * the define mode clears the variable cache
+     */
+    void redef();
+    void enddef();
+
+    void clear_cache();
+    NetCDFCacheStatistics cache_statistics() const;
+
+    /**
+     * Set the chunk cache of a chunked variable of the open file, e.g. a cache
+     * of a few chunks for appending records, or one that holds a row of tiles
+     * for reading them. The setting lasts until the file is closed.
+     */
+    void set_chunk_cache(const Field& field, const NetCDFChunkCache& cache);
+    NetCDFChunkCache chunk_cache(const Field& field);
+
     /**
      * Main inteface for writing data to netcdf
      */
     template <typename ContainerType, typename ElementType, typename ContainerInterface>
-    void write(const std::string_view full_path, const ContainerType& data)
+    void write(const Field& field, const ContainerType& data)
     {
-        auto path = resolve_path(full_path);
-
         // Get all information about the variable
-        auto variable_info = get_variable_info(path);
-
-        // TODO: Make sure resolved variable type and dimensions match
+        const auto& variable_info = variable(field);
 
         if constexpr (std::is_arithmetic_v<ContainerType>)
         {
-            if (auto ret = nc_put_var(path.group_id, path.variable_id, &data))
-            {
-                throw_error(fmt::format("nc_put_var ({})", full_path), ret);
-            }
+            put_elements(field, variable_info, nullptr, nullptr, nullptr, &data, 1);
         }
         // 1D container
         else if constexpr (ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>())
         {
+            if (m_config.write_mode == NetCDFWriteMode::Append && is_record_variable(variable_info))
+            {
+                append_records<ContainerType, ElementType, ContainerInterface>(field, variable_info, data);
+                return;
+            }
+
             std::vector<std::size_t> count = variable_info.dimension_sizes;
             std::vector<std::size_t> start(count.size(), 0);
 
-            if (auto ret =
-                    nc_put_vara(path.group_id, path.variable_id, start.data(), count.data(), data.data()))
+            // Contiguous containers are written without flattening
+            const ElementType* output{};
+            Data<ElementType> flat_data{};
+            if constexpr (InterfaceTraits::has_prepare_from_container_v<ContainerInterface, ElementType,
+                                                                        ContainerType> &&
+                          !InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType>)
+            {
+                flat_data = ContainerInterface::template prepare<ElementType, ContainerType>(data);
+                check_shape(field, variable_info, flat_data.dimension_sizes);
+                output = flat_data.data.data();
+            }
+            else
             {
-                throw_error(fmt::format("nc_put_var ({})", full_path), ret);
+                // The elements are read straight from the container, e.g. the buffer of a span,
+                // which has to have the shape of the variable
+                if constexpr (InterfaceTraits::has_static_shape_v<ContainerType>)
+                {
+                    check_shape(field, variable_info, ContainerType::shape.data(),
+                                ContainerType::shape.size());
+                }
+                else if constexpr (InterfaceTraits::has_dimension_sizes_v<ContainerInterface, ElementType,
+                                                                          ContainerType>)
+                {
+                    const auto dimension_sizes =
+                        ContainerInterface::template dimension_sizes<ElementType, ContainerType>(data);
+                    check_shape(field, variable_info, dimension_sizes);
+                }
+                else if (data.size() != VectorOperations::number_of_elements(count))
+                {
+                    throw std::runtime_error(fmt::format("Cannot write {} elements to '{}' of {} elements.",
+                                                         data.size(), field.path,
+                                                         VectorOperations::number_of_elements(count)));
+                }
+                output = data.data();
             }
+
+            put_elements(field, variable_info, start.data(), count.data(), nullptr, output,
+                         VectorOperations::number_of_elements(count));
         }
         else
         {
@@ -101,65 +248,503 @@ class NetCDFPipe
     }
 
     /**
-     * Main inteface for reading data from netcdf
+     * Write the elements of caller-owned memory, without copying them to a
+     * container first, see ArraySpan
+     */
+    template <typename ElementType, std::size_t Rank>
+    void write(const Field& field, const ArraySpan<ElementType, Rank>& data)
+    {
+        write<ArraySpan<ElementType, Rank>, ElementType, ArraySpanInterface>(field, data);
+    }
+
+    /**
+     * Append the records of the data after the records of the unlimited first
+     * dimension of the variable
+     *
+     * The first dimension of the data is the number of appended records, the
+     * other dimensions have to match the variable. The variables appended within
+     * a record, see begin_record(), are written at the same record index.
      */
     template <typename ContainerType, typename ElementType, typename ContainerInterface>
-    ContainerType read(const std::string_view full_path)
+    void append(const Field& field, const ContainerType& data)
     {
-        auto path = resolve_path(full_path);
+        static_assert(ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>(),
+                      "Unsupported type for appending to NetCDF");
 
-        ContainerType data;
+        const auto& variable_info = variable(field);
+        if (!is_record_variable(variable_info))
+        {
+            throw std::runtime_error(
+                fmt::format("Cannot append to '{}', its first dimension is not unlimited.", field.path));
+        }
+        append_records<ContainerType, ElementType, ContainerInterface>(field, variable_info, data);
+    }
 
-        // Get all information about the variable
-        auto variable_info = get_variable_info(path);
+    /**
+     * Append the records of flat data, e.g. the records of several writes
+     * collected to a single buffer, see append()
+     */
+    template <typename ElementType> void append(const Field& field, const Data<ElementType>& data)
+    {
+        const auto& variable_info = variable(field);
+        if (!is_record_variable(variable_info))
+        {
+            throw std::runtime_error(
+                fmt::format("Cannot append to '{}', its first dimension is not unlimited.", field.path));
+        }
+        check_records(field, variable_info, data.dimension_sizes);
+        put_records(field, variable_info, data.data.data(), data.data.size());
+    }
+
+    /**
+     * Whether write() appends to the variable, i.e. the pipe is in the append
+     * mode and the first dimension of the variable is unlimited
+     */
+    bool appends(const Field& field);
+
+    /**
+     * The index of the next appended record of the unlimited first dimension of the variable
+     */
+    std::size_t next_record(const Field& field);
+
+    /**
+     * The fields of a record are written directly to the file, the record
+     * boundaries are marked for the generated interfaces
+     *
+     * The records appended between the outermost begin_record() and end_record()
+     * share the record index, which advances when the record ends.
+     */
+    void begin_record();
+    void end_record();
+
+    /**
+     * Leave the record after a failed write without advancing the record index.
+     * The next record is written over the records appended within the discarded one.
+     */
+    void discard_record();
+
+    /**
+     * Main inteface for reading data from netcdf
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    ContainerType read(const Field& field)
+    {
+        ContainerType data{};
+        read_into<ContainerType, ElementType, ContainerInterface>(field, data);
+        return data;
+    }
 
-        // TODO: Make sure resolved variable type and dimensions match
+    /**
+     * Read the variable to an existing container
+     *
+     * The existing capacity of the container is reused, and containers that are
+     * not contiguous are read through a buffer owned by the pipe. Reading the
+     * same variable repeatedly to the same container does not allocate once the
+     * container and the buffer have grown to size. Allocator-aware containers,
+     * e.g. std::pmr::vector, grow from their own memory resource.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void read_into(const Field& field, ContainerType& data)
+    {
+        // Get all information about the variable
+        const auto& variable_info = variable(field);
 
         if constexpr (std::is_arithmetic_v<ContainerType>)
         {
-            if (auto ret = nc_get_var(path.group_id, path.variable_id, &data))
-            {
-                throw_error(fmt::format("nc_get_var ({})", full_path), ret);
-            }
+            get_elements(field, variable_info, nullptr, nullptr, nullptr, &data, 1);
         }
         else if constexpr (ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>())
         {
-            std::vector<std::size_t> count = variable_info.dimension_sizes;
-            std::vector<std::size_t> start(count.size(), 0);
+            m_read_start.assign(variable_info.dimension_sizes.size(), 0);
+            get_container<ContainerType, ElementType, ContainerInterface>(
+                field, variable_info, data, m_read_start, variable_info.dimension_sizes, {});
+        }
+        else
+        {
+            static_assert(always_false_v<ContainerType>, "Unsupported type for reading from NetCDF");
+        }
+    }
 
-            // see https://stackoverflow.com/a/613132
-            // Let the compiler know that prepare is a template
-            auto interface = ContainerInterface::template prepare<ElementType, ContainerType>(
-                variable_info.dimension_sizes);
+    /**
+     * Read a hyperslab of the variable
+     *
+     * The slab starts at the start index and has count elements along each
+     * dimension, taken every stride elements. An empty stride reads consecutive
+     * elements. The container is sized to the count of the slab.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    ContainerType read_slab(const Field& field, const std::vector<std::size_t>& start,
+                            const std::vector<std::size_t>& count,
+                            const std::vector<std::ptrdiff_t>& stride = {})
+    {
+        static_assert(ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>(),
+                      "Unsupported type for reading a slab from NetCDF");
+
+        const auto& variable_info = variable(field);
+        check_slab(field, variable_info, start, count, stride);
+
+        ContainerType data{};
+        get_container<ContainerType, ElementType, ContainerInterface>(field, variable_info, data, start,
+                                                                      count, stride);
+        return data;
+    }
+
+    /**
+     * Write a hyperslab of the variable, see read_slab()
+     *
+     * The data has to have as many elements as the slab, the shape of the
+     * container is not checked against the count.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void write_slab(const Field& field, const ContainerType& data, const std::vector<std::size_t>& start,
+                    const std::vector<std::size_t>& count, const std::vector<std::ptrdiff_t>& stride = {})
+    {
+        static_assert(ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>(),
+                      "Unsupported type for writing a slab to NetCDF");
+
+        const auto& variable_info = variable(field);
+        check_slab(field, variable_info, start, count, stride);
+
+        auto dimension_sizes =
+            container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data);
+        auto number_of_elements = VectorOperations::number_of_elements(dimension_sizes);
+        if (number_of_elements != VectorOperations::number_of_elements(count))
+        {
+            throw std::runtime_error(fmt::format("Writing {} elements to a slab of {} elements of '{}'.",
+                                                 number_of_elements,
+                                                 VectorOperations::number_of_elements(count), field.path));
+        }
+
+        // Contiguous containers are written without flattening
+        const ElementType* output{};
+        std::vector<ElementType> flat_data{};
+        if constexpr (InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType>)
+        {
+            output = data.data();
+        }
+        else
+        {
+            flat_data.resize(number_of_elements);
+            copy_data<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes,
+                                                                      flat_data.data());
+            output = flat_data.data();
+        }
 
-            if (auto ret = nc_get_vara(path.group_id, path.variable_id, start.data(), count.data(),
-                                       interface.data.data()))
+        put_elements(field, variable_info, start.data(), count.data(), stride.empty() ? nullptr : stride.data(),
+                     output, number_of_elements);
+    }
+
+    /**
+     * Read count records starting from the record index start, i.e. a slab along
+     * the first dimension with all the elements of the other dimensions
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    ContainerType read_records(const Field& field, std::size_t start, std::size_t count)
+    {
+        const auto& variable_info = variable(field);
+        if (variable_info.dimension_sizes.empty())
+        {
+            throw std::runtime_error(fmt::format("Cannot read records of scalar '{}'.", field.path));
+        }
+
+        std::vector<std::size_t> slab_start(variable_info.dimension_sizes.size(), 0);
+        std::vector<std::size_t> slab_count = variable_info.dimension_sizes;
+        slab_start[0] = start;
+        slab_count[0] = count;
+        return read_slab<ContainerType, ElementType, ContainerInterface>(field, slab_start, slab_count);
+    }
+
+  private:
+    /**
+     * Containers with a flattening interface are checked against the shape of the
+     * records, other contiguous containers are appended as whole records
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void append_records(const Field& field, const VariableInfo& variable_info, const ContainerType& data)
+    {
+        const ElementType* output{};
+        std::size_t number_of_elements{};
+        Data<ElementType> flat_data{};
+        if constexpr (InterfaceTraits::has_prepare_from_container_v<ContainerInterface, ElementType,
+                                                                    ContainerType>)
+        {
+            flat_data = ContainerInterface::template prepare<ElementType, ContainerType>(data);
+            check_records(field, variable_info, flat_data.dimension_sizes);
+            output = flat_data.data.data();
+            number_of_elements = flat_data.data.size();
+        }
+        else
+        {
+            if constexpr (InterfaceTraits::has_dimension_sizes_v<ContainerInterface, ElementType,
+                                                                 ContainerType>)
             {
-                throw_error(fmt::format("nc_get_vara ({})", full_path), ret);
+                check_records(field, variable_info,
+                              ContainerInterface::template dimension_sizes<ElementType, ContainerType>(data));
             }
+            output = data.data();
+            number_of_elements = data.size();
+        }
 
+        put_records(field, variable_info, output, number_of_elements);
+    }
+
+    /**
+     * Read the slab to the container. Contiguous containers that can be
+     * reshaped are read directly to their buffer, containers that can be copied
+     * from a flat buffer through the read buffer of the pipe, and other
+     * containers through the intermediate Data of the interface.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void get_container(const Field& field, const VariableInfo& variable_info, ContainerType& data,
+                       const std::vector<std::size_t>& start, const std::vector<std::size_t>& count,
+                       const std::vector<std::ptrdiff_t>& stride)
+    {
+        if constexpr (InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType> &&
+                      InterfaceTraits::has_reshape_v<ContainerInterface, ElementType, ContainerType>)
+        {
+            ContainerInterface::template reshape<ElementType, ContainerType>(data, count);
+            get_elements(field, variable_info, start.data(), count.data(),
+                         stride.empty() ? nullptr : stride.data(), data.data(), data.size());
+        }
+        else if constexpr (InterfaceTraits::has_copy_from_v<ContainerInterface, ElementType, ContainerType>)
+        {
+            const auto number_of_elements = VectorOperations::number_of_elements(count);
+            auto* buffer = read_buffer<ElementType>(number_of_elements);
+            get_elements(field, variable_info, start.data(), count.data(),
+                         stride.empty() ? nullptr : stride.data(), buffer, number_of_elements);
+            ContainerInterface::template copy_from<ElementType, ContainerType>(data, buffer, count);
+        }
+        else
+        {
             // see https://stackoverflow.com/a/613132
-            // Let the compiler know that finalise is a template
+            // Let the compiler know that prepare and finalise are templates
+            auto interface = ContainerInterface::template prepare<ElementType, ContainerType>(count);
+            get_elements(field, variable_info, start.data(), count.data(),
+                         stride.empty() ? nullptr : stride.data(), interface.data.data(),
+                         interface.data.size());
             ContainerInterface::template finalise<ElementType, ContainerType>(data, interface);
         }
+    }
+
+    /**
+     * The read buffer for number_of_elements elements, grown as needed and
+     * reused between the reads. The buffer is allocated with the alignment
+     * of operator new, which is enough for all the NetCDF element types.
+     */
+    template <typename ElementType> ElementType* read_buffer(std::size_t number_of_elements)
+    {
+        return reuse_buffer<ElementType>(m_read_buffer, number_of_elements);
+    }
+
+    /**
+     * The buffer of the elements converted to or from the type of the variable
+     * in the Convert mode, separate from the read buffer it is converted to
+     */
+    template <typename ElementType> ElementType* conversion_buffer(std::size_t number_of_elements)
+    {
+        return reuse_buffer<ElementType>(m_conversion_buffer, number_of_elements);
+    }
+
+    template <typename ElementType>
+    static ElementType* reuse_buffer(std::vector<std::byte>& buffer, std::size_t number_of_elements)
+    {
+        const auto size = number_of_elements * sizeof(ElementType);
+        if (buffer.size() < size)
+        {
+            buffer.resize(size);
+        }
+        return reinterpret_cast<ElementType*>(buffer.data());
+    }
+
+    template <typename ElementType>
+    void put_records(const Field& field, const VariableInfo& variable_info, const ElementType* output,
+                     std::size_t number_of_elements)
+    {
+        std::vector<std::size_t> count = variable_info.dimension_sizes;
+        count.front() = number_of_records(field, variable_info, number_of_elements);
+        if (count.front() == 0)
+        {
+            return;
+        }
+
+        std::vector<std::size_t> start(count.size(), 0);
+        start.front() = record_index(variable_info);
+        put_elements(field, variable_info, start.data(), count.data(), nullptr, output,
+                     VectorOperations::number_of_elements(count));
+        add_records(variable_info, count.front());
+    }
+
+    /**
+     * Write the elements of the slab with the typed nc_put_vars of the element type
+     *
+     * The element type is checked once against the type of the variable. In the
+     * Convert mode, the elements of another numeric type are first converted to
+     * a buffer of the type of the variable, a value out of its range throws.
+     */
+    template <typename ElementType>
+    void put_elements(const Field& field, const VariableInfo& variable_info, const std::size_t* start,
+                      const std::size_t* count, const std::ptrdiff_t* stride, const ElementType* data,
+                      std::size_t number_of_elements)
+    {
+        static_assert(nc_type_of<ElementType>() != NC_NAT, "Unsupported element type for NetCDF");
+
+        int ret{};
+        if (is_nc_type_of<ElementType>(variable_info.nc_type))
+        {
+            // The 1 byte integers of NC_CHAR variables are written as text
+            using IO = NetCDFTypedIO<nc_type_of<ElementType>()>;
+            ret = variable_info.nc_type == NC_CHAR
+                      ? NetCDFTypedIO<NC_CHAR>::put(variable_info.group_id, variable_info.variable_id, start,
+                                                    count, stride, reinterpret_cast<const char*>(data))
+                      : IO::put(variable_info.group_id, variable_info.variable_id, start, count, stride,
+                                reinterpret_cast<const typename IO::type*>(data));
+        }
         else
         {
-            static_assert(always_false_v<ContainerType>, "Unsupported type for writing to NetCDF");
+            auto put_converted = [&](auto* variable_type)
+            {
+                using VariableType = std::remove_pointer_t<decltype(variable_type)>;
+                auto* converted = conversion_buffer<VariableType>(number_of_elements);
+                if (!convert_elements(data, converted, number_of_elements))
+                {
+                    throw_range_error(field, variable_info, nc_type_of<ElementType>());
+                }
+                ret = NetCDFTypedIO<nc_type_of<VariableType>()>::put(
+                    variable_info.group_id, variable_info.variable_id, start, count, stride, converted);
+            };
+            if (m_config.type_conversion != NetCDFTypeConversion::Convert ||
+                !visit_numeric_nc_type(variable_info.nc_type, put_converted))
+            {
+                throw_type_error(field, variable_info, nc_type_of<ElementType>());
+            }
         }
 
-        return data;
+        if (ret)
+        {
+            throw_error(fmt::format("nc_put_vars ({})", field.path), ret);
+        }
     }
 
-  private:
+    /**
+     * Read the elements of the slab with the typed nc_get_vars of the element type,
+     * see put_elements()
+     */
+    template <typename ElementType>
+    void get_elements(const Field& field, const VariableInfo& variable_info, const std::size_t* start,
+                      const std::size_t* count, const std::ptrdiff_t* stride, ElementType* data,
+                      std::size_t number_of_elements)
+    {
+        static_assert(nc_type_of<ElementType>() != NC_NAT, "Unsupported element type for NetCDF");
+
+        int ret{};
+        if (is_nc_type_of<ElementType>(variable_info.nc_type))
+        {
+            using IO = NetCDFTypedIO<nc_type_of<ElementType>()>;
+            ret = variable_info.nc_type == NC_CHAR
+                      ? NetCDFTypedIO<NC_CHAR>::get(variable_info.group_id, variable_info.variable_id, start,
+                                                    count, stride, reinterpret_cast<char*>(data))
+                      : IO::get(variable_info.group_id, variable_info.variable_id, start, count, stride,
+                                reinterpret_cast<typename IO::type*>(data));
+        }
+        else
+        {
+            auto get_converted = [&](auto* variable_type)
+            {
+                using VariableType = std::remove_pointer_t<decltype(variable_type)>;
+                auto* converted = conversion_buffer<VariableType>(number_of_elements);
+                ret = NetCDFTypedIO<nc_type_of<VariableType>()>::get(
+                    variable_info.group_id, variable_info.variable_id, start, count, stride, converted);
+                if (!ret && !convert_elements(converted, data, number_of_elements))
+                {
+                    throw_range_error(field, variable_info, nc_type_of<ElementType>());
+                }
+            };
+            if (m_config.type_conversion != NetCDFTypeConversion::Convert ||
+                !visit_numeric_nc_type(variable_info.nc_type, get_converted))
+            {
+                throw_type_error(field, variable_info, nc_type_of<ElementType>());
+            }
+        }
+
+        if (ret)
+        {
+            throw_error(fmt::format("nc_get_vars ({})", field.path), ret);
+        }
+    }
+
+    bool is_record_variable(const VariableInfo& variable_info) const;
+    void check_records(const Field& field, const VariableInfo& variable_info,
+                       const std::vector<std::size_t>& dimension_sizes);
+    void check_shape(const Field& field, const VariableInfo& variable_info,
+                     const std::vector<std::size_t>& dimension_sizes)
+    {
+        check_shape(field, variable_info, dimension_sizes.data(), dimension_sizes.size());
+    }
+    void check_shape(const Field& field, const VariableInfo& variable_info,
+                     const std::size_t* dimension_sizes, std::size_t rank);
+    std::size_t number_of_records(const Field& field, const VariableInfo& variable_info,
+                                  std::size_t number_of_elements);
+    std::size_t record_index(const VariableInfo& variable_info);
+    void add_records(const VariableInfo& variable_info, std::size_t count);
+    void advance_records();
+
     void assert_open();
+    void check_slab(const Field& field, const VariableInfo& variable_info,
+                    const std::vector<std::size_t>& start, const std::vector<std::size_t>& count,
+                    const std::vector<std::ptrdiff_t>& stride);
     void throw_error(std::string_view message, int error_code);
+    void throw_type_error(const Field& field, const VariableInfo& variable_info, nc_type element_type);
+    void throw_range_error(const Field& field, const VariableInfo& variable_info, nc_type element_type);
 
     int get_group_id(const int parent_group_id, const std::string_view variable_name);
     int get_variable_id(const int group_id, std::string_view path);
     std::size_t get_dimension_size(const Path& path);
+    std::vector<int> get_unlimited_dimension_ids(const std::string_view path);
+    VariableInfo& find_variable(const std::string_view path);
+    void update_unlimited_dimensions(VariableInfo& variable_info);
+
+    // Resolve the variables of the schema in use
+    void resolve_schema();
 
     std::filesystem::path path{};
+    NetCDFConfiguration m_config{};
     int root_id{-1};
+    // The open file is a memory buffer, closed with nc_close_memio
+    bool m_in_memory{};
+
+    // The resolved variables of the open file by the path
+    std::map<std::string, VariableInfo, std::less<>> m_variables{};
+    NetCDFCacheStatistics m_cache_statistics{};
+
+    // The schema in use, and its resolved variables in m_variables by the field id
+    std::optional<Schema> m_schema{};
+    struct SchemaVariable
+    {
+        VariableInfo* variable{};
+        // The path of the last field of the id checked against the schema, the
+        // generated interfaces pass the same string for each write
+        std::string_view checked_path{};
+    };
+    std::vector<SchemaVariable> m_schema_variables{};
+
+    // The appended records of the unlimited dimensions by the dimension id, the ids
+    // are unique within the file
+    struct Records
+    {
+        std::size_t next{};
+        // The most records appended to the dimension in the current record
+        std::size_t pending{};
+    };
+    std::map<int, Records> m_records{};
+    int m_record_depth{};
+
+    // The start of the whole variable reads, and the buffer of the reads of
+    // the containers that are not contiguous, reused between the reads
+    std::vector<std::size_t> m_read_start{};
+    std::vector<std::byte> m_read_buffer{};
+
+    // The elements converted in the Convert mode, reused between the reads and writes
+    std::vector<std::byte> m_conversion_buffer{};
 };
 
 } // namespace ncdlgen
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "interface.h"
+#include "utils.h"
+#include "vector_interface.h"
+
+namespace ncdlgen
+{
+
+/**
+ * The element type of the written data, used to validate the read data
+ */
+enum class PipeElementType : std::uint8_t
+{
+    Unknown,
+    Int8,
+    Uint8,
+    Int16,
+    Uint16,
+    Int32,
+    Uint32,
+    Int64,
+    Uint64,
+    Float,
+    Double,
+};
+
+template <typename ElementType> constexpr PipeElementType pipe_element_type()
+{
+    if constexpr (std::is_floating_point_v<ElementType>)
+    {
+        return sizeof(ElementType) == 4 ? PipeElementType::Float : PipeElementType::Double;
+    }
+    else if constexpr (std::is_integral_v<ElementType>)
+    {
+        constexpr bool is_signed = std::is_signed_v<ElementType>;
+        switch (sizeof(ElementType))
+        {
+        case 1:
+            return is_signed ? PipeElementType::Int8 : PipeElementType::Uint8;
+        case 2:
+            return is_signed ? PipeElementType::Int16 : PipeElementType::Uint16;
+        case 4:
+            return is_signed ? PipeElementType::Int32 : PipeElementType::Uint32;
+        case 8:
+            return is_signed ? PipeElementType::Int64 : PipeElementType::Uint64;
+        }
+    }
+    return PipeElementType::Unknown;
+}
+
+/**
+ * The dimension sizes of the data, from the interface when the container
+ * knows its shape, otherwise by walking the nested containers
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+std::vector<std::size_t> container_dimension_sizes(const ContainerType& data)
+{
+    if constexpr (!std::is_fundamental_v<ContainerType> &&
+                  InterfaceTraits::has_dimension_sizes_v<ContainerInterface, ElementType, ContainerType>)
+    {
+        return ContainerInterface::template dimension_sizes<ElementType, ContainerType>(data);
+    }
+    else
+    {
+        return VectorOperations::template container_dimension_sizes<ElementType, ContainerType>(data);
+    }
+}
+
+/**
+ * Set the dimension sizes of the data to dimension_sizes, reusing its capacity
+ * for the containers with a static shape, e.g. FixedArray
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+void container_dimension_sizes(const ContainerType& data, std::vector<std::size_t>& dimension_sizes)
+{
+    if constexpr (InterfaceTraits::has_static_shape_v<ContainerType>)
+    {
+        dimension_sizes.assign(ContainerType::shape.begin(), ContainerType::shape.end());
+    }
+    else
+    {
+        dimension_sizes = container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data);
+    }
+}
+
+/**
+ * The size of the flat data in bytes
+ */
+template <typename ContainerType, typename ElementType>
+std::size_t data_size(const std::vector<std::size_t>& dimension_sizes)
+{
+    if constexpr (std::is_fundamental_v<ContainerType>)
+    {
+        return sizeof(ElementType);
+    }
+    else
+    {
+        return VectorOperations::number_of_elements(dimension_sizes) * sizeof(ElementType);
+    }
+}
+
+/**
+ * Copy the data flat to output, that has space for data_size() bytes
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+void copy_data(const ContainerType& data, const std::vector<std::size_t>& dimension_sizes, void* output)
+{
+    if constexpr (std::is_fundamental_v<ContainerType>)
+    {
+        std::memcpy(output, &data, sizeof(ElementType));
+    }
+    // Contiguous containers are copied once, directly to the output. The buffer of
+    // an empty container may be null, which memcpy does not accept
+    else if constexpr (InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType>)
+    {
+        if (data.size() > 0)
+        {
+            std::memcpy(output, data.data(), data.size() * sizeof(ElementType));
+        }
+    }
+    // ND containers are flattened directly to the output
+    else if constexpr (InterfaceTraits::has_copy_to_v<ContainerInterface, ElementType, ContainerType>)
+    {
+        ContainerInterface::template copy_to<ElementType, ContainerType>(
+            data, static_cast<ElementType*>(output), dimension_sizes);
+    }
+    else if constexpr (ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>())
+    {
+        auto flat_data = ContainerInterface::template prepare<ElementType, ContainerType>(data);
+
+        if (flat_data.data.size() != VectorOperations::number_of_elements(dimension_sizes))
+        {
+            throw std::runtime_error(fmt::format("Incorrect size of flattened data, expected {}, received {}",
+                                                 VectorOperations::number_of_elements(dimension_sizes),
+                                                 flat_data.data.size()));
+        }
+        if (!flat_data.data.empty())
+        {
+            std::memcpy(output, flat_data.data.data(), flat_data.data.size() * sizeof(ElementType));
+        }
+    }
+    else
+    {
+        static_assert(always_false_v<ElementType>, "unsupported type");
+    }
+}
+
+/**
+ * Decode the flat data straight to the output container
+ */
+template <typename ContainerType, typename ElementType, typename ContainerInterface>
+void data_from_buffer(ContainerType& output, const void* data, std::size_t size,
+                      const std::vector<std::size_t>& dimension_sizes)
+{
+    if constexpr (std::is_fundamental_v<ContainerType>)
+    {
+        if (size != sizeof(ElementType))
+        {
+            throw std::runtime_error(
+                fmt::format("Incorrect size of input scalar message, expected size {}, received size {}",
+                            sizeof(ElementType), size));
+        }
+        std::memcpy(&output, data, sizeof(ElementType));
+    }
+    // Copy each innermost row from the message to the final container
+    else if constexpr (InterfaceTraits::has_copy_from_v<ContainerInterface, ElementType, ContainerType>)
+    {
+        auto number_of_elements = VectorOperations::number_of_elements(dimension_sizes);
+        if (size != sizeof(ElementType) * number_of_elements)
+        {
+            throw std::runtime_error(
+                fmt::format("Incorrect size of input vector message, expected size {}, received size {}",
+                            sizeof(ElementType) * number_of_elements, size));
+        }
+
+        ContainerInterface::template copy_from<ElementType, ContainerType>(
+            output, static_cast<const ElementType*>(data), dimension_sizes);
+    }
+    else if constexpr (ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>())
+    {
+        auto flat_data =
+            ContainerInterface::template prepare<ElementType, ContainerType>(dimension_sizes);
+
+        if (size != sizeof(ElementType) * flat_data.data.size())
+        {
+            throw std::runtime_error(
+                fmt::format("Incorrect size of input vector message, expected size {}, received size {}",
+                            sizeof(ElementType) * flat_data.data.size(), size));
+        }
+        auto data_ptr = static_cast<const ElementType*>(data);
+        flat_data.data.assign(data_ptr, data_ptr + flat_data.data.size());
+
+        // Format data from buffer to final container
+        ContainerInterface::template finalise<ElementType, ContainerType>(output, flat_data);
+    }
+    else
+    {
+        static_assert(always_false_v<ElementType>, "unsupported type");
+    }
+}
+
+} // namespace ncdlgen
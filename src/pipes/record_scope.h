@@ -0,0 +1,41 @@
+#pragma once
+
+namespace ncdlgen
+{
+
+/**
+ * The fields written between begin_record() and end() of a pipe, used by the
+ * generated write functions
+ *
+ * When a write throws before end(), the destructor discards the record, so the
+ * pipe does not stay within the failed record and the later records are written
+ * as usual.
+ */
+template <typename PipeType> class RecordScope
+{
+  public:
+    explicit RecordScope(PipeType& pipe) : m_pipe(pipe) { m_pipe.begin_record(); }
+
+    ~RecordScope()
+    {
+        if (!m_ended)
+        {
+            m_pipe.discard_record();
+        }
+    }
+
+    RecordScope(const RecordScope&) = delete;
+    RecordScope& operator=(const RecordScope&) = delete;
+
+    void end()
+    {
+        m_ended = true;
+        m_pipe.end_record();
+    }
+
+  private:
+    PipeType& m_pipe;
+    bool m_ended{};
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,29 @@
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ncdlgen
+{
+
+struct SharedMemoryConfiguration
+{
+    // The POSIX shared memory object, shared by the writing and the reading pipe
+    std::string name{"/ncdlgen"};
+
+    // The size of the ring buffer in bytes, each written field has to fit to the ring.
+    // The pipe that creates the shared memory object decides the size.
+    std::size_t capacity{64 * 1024 * 1024};
+
+    // How long a read waits for the next field, and a write for space in the ring,
+    // -1 waits indefinitely
+    int receive_timeout_ms{-1};
+    int send_timeout_ms{-1};
+
+    // Remove an existing shared memory object of the name before creating the ring,
+    // e.g. one left by a crashed run. Only the pipe that should create the ring sets it.
+    bool recreate{false};
+};
+
+} // namespace ncdlgen
@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pipes/backoff.h"
+#include "pipes/shared_memory_pipe.h"
+
+namespace ncdlgen
+{
+
+/**
+ * The start of the shared memory object, followed by the ring data
+ *
+ * The positions count the bytes written to and read from the ring since its
+ * creation, the location in the ring is the position modulo the capacity.
+ */
+struct SharedMemoryRing
+{
+    // Set by the creating pipe once the ring is initialised
+    static constexpr std::uint64_t ready_magic{0x316e6567'6c64636e};
+    std::atomic<std::uint64_t> magic{};
+    std::uint64_t capacity{};
+
+    // The process of the creating pipe, which removes the object when it closes
+    std::int64_t creator_pid{};
+
+    // Written by different processes, keep them on separate cache lines
+    alignas(64) std::atomic<std::uint64_t> read_position{};
+    alignas(64) std::atomic<std::uint64_t> write_position{};
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "The ring positions are shared between processes and cannot use locks");
+
+static constexpr std::size_t ring_data_offset{(sizeof(SharedMemoryRing) + 63) / 64 * 64};
+static constexpr std::size_t frame_alignment{16};
+static constexpr std::size_t frame_header_size{16};
+static constexpr std::size_t field_header_fixed_size{8};
+static constexpr std::uint32_t field_frame{0};
+static constexpr std::uint32_t skip_frame{1};
+
+// How long opening an existing ring waits for its creator to initialise it
+static constexpr int initialise_timeout_ms{1000};
+
+/**
+ * A process that has exited is not found, a process of another user is
+ */
+static bool is_process_alive(std::int64_t pid)
+{
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+}
+
+static std::size_t align_frame(std::size_t offset)
+{
+    return (offset + frame_alignment - 1) / frame_alignment * frame_alignment;
+}
+
+/**
+ * The writer and the reader run on the same host, the frames are in the native byte order
+ */
+template <typename IntegerType> static std::uint8_t* store(std::uint8_t* output, IntegerType value)
+{
+    std::memcpy(output, &value, sizeof(IntegerType));
+    return output + sizeof(IntegerType);
+}
+
+template <typename IntegerType> static const std::uint8_t* load(const std::uint8_t* input, IntegerType& value)
+{
+    std::memcpy(&value, input, sizeof(IntegerType));
+    return input + sizeof(IntegerType);
+}
+
+SharedMemoryPipe::SharedMemoryPipe() : SharedMemoryPipe(SharedMemoryConfiguration{}) {}
+
+SharedMemoryPipe::SharedMemoryPipe(const SharedMemoryConfiguration& config) : m_config(config)
+{
+    if (m_config.recreate)
+    {
+        shm_unlink(m_config.name.c_str());
+    }
+    if (!open_ring())
+    {
+        // The creator of the existing object exited without removing it
+        shm_unlink(m_config.name.c_str());
+        if (!open_ring())
+        {
+            throw std::runtime_error(
+                fmt::format("SharedMemoryPipe: cannot replace stale shared memory '{}'.", m_config.name));
+        }
+    }
+    m_data = static_cast<std::uint8_t*>(m_mapping) + ring_data_offset;
+}
+
+bool SharedMemoryPipe::open_ring()
+{
+    // The first pipe creates the shared memory object, the other one opens it
+    m_descriptor = shm_open(m_config.name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    m_owner = m_descriptor >= 0;
+    if (!m_owner && errno == EEXIST)
+    {
+        m_descriptor = shm_open(m_config.name.c_str(), O_RDWR, 0600);
+    }
+    if (m_descriptor < 0)
+    {
+        throw std::runtime_error(fmt::format("SharedMemoryPipe: cannot open shared memory '{}', errno {}.",
+                                             m_config.name, errno));
+    }
+
+    try
+    {
+        if (m_owner)
+        {
+            m_capacity = align_frame(std::max(m_config.capacity, frame_alignment));
+            m_mapping_size = ring_data_offset + m_capacity;
+            if (ftruncate(m_descriptor, static_cast<off_t>(m_mapping_size)) != 0)
+            {
+                throw std::runtime_error(
+                    fmt::format("SharedMemoryPipe: cannot resize shared memory '{}' to {} bytes, errno {}.",
+                                m_config.name, m_mapping_size, errno));
+            }
+        }
+        else
+        {
+            // The creator sizes the object before initialising the ring
+            struct stat status
+            {
+            };
+            auto is_sized = [&]
+            {
+                return fstat(m_descriptor, &status) == 0 &&
+                       status.st_size > static_cast<off_t>(ring_data_offset);
+            };
+            if (!wait_until(is_sized, initialise_timeout_ms))
+            {
+                throw std::runtime_error(
+                    fmt::format("SharedMemoryPipe: shared memory '{}' was not initialised.", m_config.name));
+            }
+            m_mapping_size = static_cast<std::size_t>(status.st_size);
+        }
+
+        m_mapping = mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_descriptor, 0);
+        if (m_mapping == MAP_FAILED)
+        {
+            m_mapping = nullptr;
+            throw std::runtime_error(fmt::format("SharedMemoryPipe: cannot map shared memory '{}', errno {}.",
+                                                 m_config.name, errno));
+        }
+
+        if (m_owner)
+        {
+            m_ring = new (m_mapping) SharedMemoryRing{};
+            m_ring->capacity = m_capacity;
+            m_ring->creator_pid = getpid();
+            m_ring->magic.store(SharedMemoryRing::ready_magic, std::memory_order_release);
+        }
+        else
+        {
+            m_ring = static_cast<SharedMemoryRing*>(m_mapping);
+            auto is_ready = [&]
+            { return m_ring->magic.load(std::memory_order_acquire) == SharedMemoryRing::ready_magic; };
+            auto ready = wait_until(is_ready, initialise_timeout_ms);
+            if (m_ring->creator_pid != 0 && !is_process_alive(m_ring->creator_pid))
+            {
+                close();
+                return false;
+            }
+            if (!ready || ring_data_offset + m_ring->capacity > m_mapping_size)
+            {
+                throw std::runtime_error(
+                    fmt::format("SharedMemoryPipe: shared memory '{}' was not initialised.", m_config.name));
+            }
+            m_capacity = m_ring->capacity;
+        }
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
+    return true;
+}
+
+SharedMemoryPipe::~SharedMemoryPipe() { close(); }
+
+void SharedMemoryPipe::close()
+{
+    // The name is removed right away, the other pipe keeps its mapping until it closes.
+    // A ring recreated under the name by another pipe is left to that pipe
+    if (m_owner && is_named_object())
+    {
+        shm_unlink(m_config.name.c_str());
+    }
+    m_owner = false;
+
+    if (m_mapping)
+    {
+        munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+    }
+    if (m_descriptor >= 0)
+    {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+    }
+}
+
+bool SharedMemoryPipe::is_named_object() const
+{
+    struct stat own_status
+    {
+    };
+    if (m_descriptor < 0 || fstat(m_descriptor, &own_status) != 0)
+    {
+        return false;
+    }
+
+    auto descriptor = shm_open(m_config.name.c_str(), O_RDONLY, 0);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    struct stat named_status
+    {
+    };
+    auto is_same = fstat(descriptor, &named_status) == 0 && named_status.st_dev == own_status.st_dev &&
+                   named_status.st_ino == own_status.st_ino;
+    ::close(descriptor);
+    return is_same;
+}
+
+std::size_t SharedMemoryPipe::capacity() const { return m_capacity; }
+
+std::uint8_t* SharedMemoryPipe::begin_write(const Field& field, PipeElementType element_type,
+                                            const std::vector<std::size_t>& dimension_sizes,
+                                            std::size_t data_size)
+{
+    const auto header_size =
+        field_header_fixed_size + dimension_sizes.size() * sizeof(std::uint64_t) + field.path.size();
+    const auto frame_size = frame_header_size + align_frame(header_size) + align_frame(data_size);
+    if (frame_size > m_capacity)
+    {
+        throw std::runtime_error(
+            fmt::format("SharedMemoryPipe: field '{}' of {} bytes does not fit to the ring of {} bytes.",
+                        field.path, frame_size, m_capacity));
+    }
+
+    // Only this pipe writes the write position
+    auto position = m_ring->write_position.load(std::memory_order_relaxed);
+    auto offset = position % m_capacity;
+    const std::size_t skip_size = offset + frame_size > m_capacity ? m_capacity - offset : 0;
+
+    auto has_space = [&]
+    {
+        auto read_position = m_ring->read_position.load(std::memory_order_acquire);
+        return position + skip_size + frame_size - read_position <= m_capacity;
+    };
+    if (!wait_until(has_space, m_config.send_timeout_ms))
+    {
+        throw std::runtime_error(
+            fmt::format("SharedMemoryPipe: timed out waiting for space to write '{}'.", field.path));
+    }
+
+    // The rest of the ring is at least a frame header, as the frames are aligned
+    if (skip_size > 0)
+    {
+        auto* skip = m_data + offset;
+        skip = store(skip, std::uint32_t{0});
+        skip = store(skip, skip_frame);
+        store(skip, std::uint64_t{0});
+        position += skip_size;
+        offset = 0;
+    }
+
+    auto* cursor = m_data + offset;
+    cursor = store(cursor, static_cast<std::uint32_t>(header_size));
+    cursor = store(cursor, field_frame);
+    cursor = store(cursor, static_cast<std::uint64_t>(data_size));
+    cursor = store(cursor, static_cast<std::uint8_t>(element_type));
+    cursor = store(cursor, std::uint8_t{0});
+    cursor = store(cursor, static_cast<std::uint16_t>(dimension_sizes.size()));
+    cursor = store(cursor, static_cast<std::uint32_t>(field.path.size()));
+    for (auto dimension_size : dimension_sizes)
+    {
+        cursor = store(cursor, static_cast<std::uint64_t>(dimension_size));
+    }
+    std::memcpy(cursor, field.path.data(), field.path.size());
+
+    m_write_end = position + frame_size;
+    return m_data + offset + frame_header_size + align_frame(header_size);
+}
+
+void SharedMemoryPipe::end_write() { m_ring->write_position.store(m_write_end, std::memory_order_release); }
+
+const std::uint8_t* SharedMemoryPipe::begin_read(const Field& field, PipeElementType element_type)
+{
+    // Only this pipe writes the read position
+    auto position = m_ring->read_position.load(std::memory_order_relaxed);
+
+    std::uint32_t header_size{};
+    std::uint32_t frame_type{};
+    std::uint64_t data_size{};
+    const std::uint8_t* frame{};
+    while (true)
+    {
+        auto has_field = [&] { return m_ring->write_position.load(std::memory_order_acquire) != position; };
+        if (!wait_until(has_field, m_config.receive_timeout_ms))
+        {
+            throw std::runtime_error(
+                fmt::format("SharedMemoryPipe: timed out waiting for '{}'.", field.path));
+        }
+
+        auto offset = position % m_capacity;
+        frame = m_data + offset;
+        frame = load(frame, header_size);
+        frame = load(frame, frame_type);
+        frame = load(frame, data_size);
+        if (frame_type != skip_frame)
+        {
+            break;
+        }
+        position += m_capacity - offset;
+    }
+
+    const auto frame_size = frame_header_size + align_frame(header_size) + align_frame(data_size);
+    m_read_end = position + frame_size;
+    if (frame_type != field_frame || header_size < field_header_fixed_size ||
+        frame_size > m_capacity - position % m_capacity)
+    {
+        throw std::runtime_error(
+            fmt::format("SharedMemoryPipe: invalid frame in the ring while reading '{}'.", field.path));
+    }
+
+    std::uint8_t type{};
+    std::uint8_t reserved{};
+    std::uint16_t rank{};
+    std::uint32_t path_size{};
+    const auto* header = frame;
+    header = load(header, type);
+    header = load(header, reserved);
+    header = load(header, rank);
+    header = load(header, path_size);
+    if (header_size != field_header_fixed_size + rank * sizeof(std::uint64_t) + path_size)
+    {
+        end_read();
+        throw std::runtime_error(
+            fmt::format("SharedMemoryPipe: invalid frame in the ring while reading '{}'.", field.path));
+    }
+
+    m_read_dimension_sizes.resize(rank);
+    for (auto& dimension_size : m_read_dimension_sizes)
+    {
+        std::uint64_t size{};
+        header = load(header, size);
+        dimension_size = size;
+    }
+    auto path = std::string_view(reinterpret_cast<const char*>(header), path_size);
+
+    // The fields are read in order, a mismatching field is left in the ring for the matching read
+    if (path != field.path)
+    {
+        throw std::runtime_error(
+            fmt::format("SharedMemoryPipe: trying to read '{}', the next field is '{}'.", field.path, path));
+    }
+    if (static_cast<PipeElementType>(type) != element_type)
+    {
+        throw std::runtime_error(fmt::format("Read '{}' with element type {}, expected element type {}.",
+                                             field.path, static_cast<int>(type),
+                                             static_cast<int>(element_type)));
+    }
+
+    m_read_size = data_size;
+    return frame + align_frame(header_size);
+}
+
+void SharedMemoryPipe::end_read() { m_ring->read_position.store(m_read_end, std::memory_order_release); }
+
+} // namespace ncdlgen
@@ -0,0 +1,178 @@
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "pipe_data.h"
+#include "record_scope.h"
+#include "schema.h"
+#include "utils.h"
+#include "vector_interface.h"
+
+#include "shared_memory_configuration.h"
+
+namespace ncdlgen
+{
+
+struct SharedMemoryRing;
+
+/**
+ * Write and read data through a ring buffer in POSIX shared memory, for a writer
+ * and a reader on the same host
+ *
+ * The writer flattens the data directly to the ring and the reader decodes it
+ * directly from the ring to the output container, so the data is copied once on
+ * each side. The writer and the reader share only the write and the read position
+ * of the ring. A field is published by advancing the write position after it has
+ * been written, and its space is released by advancing the read position after it
+ * has been read. There can be a single writing and a single reading pipe.
+ *
+ * Each field is a frame in the ring
+ *
+ *   u32 header size
+ *   u32 frame type
+ *   u64 data size
+ *   header
+ *   data
+ *
+ * with the header
+ *
+ *   u8  element type
+ *   u8  reserved
+ *   u16 rank
+ *   u32 path length
+ *   u64 dimension sizes [rank]
+ *   path
+ *
+ * The header and the data start at 16 byte boundaries. A frame is not split at
+ * the end of the ring, instead the rest of the ring is skipped.
+ */
+class SharedMemoryPipe
+{
+  public:
+    SharedMemoryPipe();
+    SharedMemoryPipe(const SharedMemoryConfiguration& config);
+
+    ~SharedMemoryPipe();
+
+    SharedMemoryPipe(const SharedMemoryPipe&) = delete;
+    SharedMemoryPipe& operator=(const SharedMemoryPipe&) = delete;
+
+    /**
+     * Main interface for writing data to the ring, waits for the reader to make
+     * space when the ring is full
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void write(const Field& field, const ContainerType& data)
+    {
+        auto& dimension_sizes = m_write_dimension_sizes;
+        container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes);
+
+        auto* output = begin_write(field, pipe_element_type<ElementType>(), dimension_sizes,
+                                   data_size<ContainerType, ElementType>(dimension_sizes));
+        copy_data<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes, output);
+        end_write();
+    }
+
+    /**
+     * Main interface for reading data from the ring
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    ContainerType read(const Field& field)
+    {
+        ContainerType data{};
+        read_into<ContainerType, ElementType, ContainerInterface>(field, data);
+        return data;
+    }
+
+    /**
+     * Read data from the ring to an existing container, reusing its capacity
+     *
+     * The fields are read in the order they were written.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void read_into(const Field& field, ContainerType& data)
+    {
+        auto* input = begin_read(field, pipe_element_type<ElementType>());
+        try
+        {
+            data_from_buffer<ContainerType, ElementType, ContainerInterface>(data, input, m_read_size,
+                                                                             m_read_dimension_sizes);
+        }
+        catch (...)
+        {
+            end_read();
+            throw;
+        }
+        end_read();
+    }
+
+    /**
+     * Each field is published separately, the records are not batched
+     */
+    void begin_record() {}
+    void end_record() {}
+    void discard_record() {}
+
+    /**
+     * The size of the ring in bytes
+     */
+    std::size_t capacity() const;
+
+  private:
+    /**
+     * Create or open the shared memory object and map the ring, returns false
+     * when the existing object is stale, i.e. its creator has exited
+     */
+    bool open_ring();
+
+    /**
+     * Reserve the frame for the field and write its header, returns the location for the data
+     */
+    std::uint8_t* begin_write(const Field& field, PipeElementType element_type,
+                              const std::vector<std::size_t>& dimension_sizes, std::size_t data_size);
+    void end_write();
+
+    /**
+     * Wait for the next field and check it is the requested one, returns the location of the data
+     *
+     * A field that is not the requested one is not consumed.
+     */
+    const std::uint8_t* begin_read(const Field& field, PipeElementType element_type);
+    void end_read();
+
+    void close();
+
+    /**
+     * Whether the name still refers to the object of the open descriptor, and not to
+     * an object created under the name after it was removed
+     */
+    bool is_named_object() const;
+
+    SharedMemoryConfiguration m_config{};
+
+    // The mapped shared memory object, the ring positions followed by the ring data
+    int m_descriptor{-1};
+    bool m_owner{};
+    void* m_mapping{};
+    std::size_t m_mapping_size{};
+    SharedMemoryRing* m_ring{};
+    std::uint8_t* m_data{};
+    std::size_t m_capacity{};
+
+    // The end of the field being written, published by end_write()
+    std::uint64_t m_write_end{};
+    // The dimension sizes of the written field, reused between the writes
+    std::vector<std::size_t> m_write_dimension_sizes{};
+
+    // The field being read, released by end_read()
+    std::uint64_t m_read_end{};
+    std::size_t m_read_size{};
+    std::vector<std::size_t> m_read_dimension_sizes{};
+};
+
+} // namespace ncdlgen
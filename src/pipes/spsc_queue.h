@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ncdlgen
+{
+
+/**
+ * Bounded lock-free queue for one producer thread and one consumer thread
+ *
+ * The slots are allocated up front, pushing and popping only move the values.
+ * A popped slot is reset so that the queue does not keep resources of the
+ * popped values alive.
+ */
+template <typename ValueType> class SPSCQueue
+{
+  public:
+    // One slot is kept free to tell a full queue from an empty one
+    explicit SPSCQueue(std::size_t capacity) : m_slots(capacity + 1) {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /**
+     * Push from the producer thread, returns false if the queue is full
+     */
+    bool try_push(ValueType&& value)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        m_slots[tail] = std::move(value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Push a copy from the producer thread, returns false if the queue is full
+     *
+     * The value is copied over the value left in the slot, reusing its resources.
+     */
+    bool try_push(const ValueType& value)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        m_slots[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Push from the producer thread by exchanging the value with the slot,
+     * returns false if the queue is full
+     *
+     * The value receives the value left in the slot by try_swap_pop(), so the
+     * resources of the popped values are recycled back to the producer.
+     */
+    bool try_swap_push(ValueType& value)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        using std::swap;
+        swap(m_slots[tail], value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pop from the consumer thread, returns false if the queue is empty
+     */
+    bool try_pop(ValueType& value)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        value = std::move(m_slots[head]);
+        m_slots[head] = ValueType{};
+        m_head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pop from the consumer thread by exchanging the value with the slot,
+     * returns false if the queue is empty
+     *
+     * The previous contents of the value are left in the slot for try_swap_push().
+     */
+    bool try_swap_pop(ValueType& value)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        using std::swap;
+        swap(value, m_slots[head]);
+        m_head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * The number of queued values, exact only when called from either of the threads
+     * while the other one is idle
+     */
+    std::size_t size() const
+    {
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + m_slots.size() - head;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    std::size_t capacity() const { return m_slots.size() - 1; }
+
+  private:
+    std::size_t increment(std::size_t index) const { return index + 1 == m_slots.size() ? 0 : index + 1; }
+
+    std::vector<ValueType> m_slots{};
+
+    // Keep the indices on separate cache lines, written by different threads
+    alignas(64) std::atomic<std::size_t> m_head{};
+    alignas(64) std::atomic<std::size_t> m_tail{};
+};
+
+} // namespace ncdlgen
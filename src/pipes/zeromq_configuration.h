@@ -2,11 +2,28 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace ncdlgen
 {
 
+enum class ZeroMQHeaderEncoding
+{
+    // Compact fixed layout header
+    Binary,
+    // Human readable "name;dim1,dim2" header for debugging
+    Text,
+};
+
+enum class ZeroMQQueueFullPolicy
+{
+    // Wait for the sender thread to make space
+    Block,
+    // Drop the message that does not fit to the queue
+    Drop,
+};
+
 struct ZeroMQConfiguration
 {
     // By default, pick an explicit socket on random
@@ -15,6 +32,35 @@ struct ZeroMQConfiguration
     // To allow listening to right socket by default
     std::string outbound_socket{"tcp://127.0.0.1:42042"};
     std::string incoming_socket{"tcp://127.0.0.1:42042"};
+
+    // The encoding of the sent headers, the received headers are decoded
+    // from either encoding
+    ZeroMQHeaderEncoding header_encoding{ZeroMQHeaderEncoding::Binary};
+
+    // Send the fields written between begin_record() and end_record()
+    // as a single message
+    bool record_batching{true};
+
+    // Send the messages from a background thread, the writes only
+    // queue the prepared messages
+    bool asynchronous_send{false};
+    // The maximum number of queued messages in the asynchronous mode
+    std::size_t send_queue_depth{1024};
+    ZeroMQQueueFullPolicy queue_full_policy{ZeroMQQueueFullPolicy::Block};
+    // How long a blocked write waits for space in the queue or for a chunk buffer, and
+    // flush() for the queued messages to be sent, -1 waits indefinitely
+    int send_timeout_ms{-1};
+
+    // Stream the arrays larger than chunk_size bytes in messages of chunk_size bytes
+    // while flattening them, 0 sends each array in a single message
+    std::size_t chunk_size{0};
+    // The chunks sent but not yet released by zeromq, bounds the memory used by a stream
+    std::size_t max_chunks_in_flight{4};
+
+    // How long a read waits for the next message, -1 waits indefinitely
+    int receive_timeout_ms{-1};
+    // The fields of other variables kept while waiting for the read variable
+    std::size_t max_pending_fields{4096};
 };
 
 } // namespace ncdlgen
\ No newline at end of file
@@ -1,7 +1,15 @@
 
 
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <zmq.hpp>
 
+#include "pipes/backoff.h"
+#include "pipes/spsc_queue.h"
 #include "pipes/zeromq_pipe.h"
 
 namespace ncdlgen
@@ -23,31 +31,464 @@ std::string ZeroMQVariableInfo::to_string()
 ZeroMQVariableInfo ZeroMQVariableInfo::from_string_view(const std::string_view field_message)
 {
     ZeroMQVariableInfo variable_info{};
+    variable_info.parse(field_message);
+    return variable_info;
+}
 
-    auto split = split_string(field_message, ';');
-    if (split.size() > 2 || split.size() == 0)
+void ZeroMQVariableInfo::parse(const std::string_view field_message)
+{
+    auto separator = field_message.find(';');
+    if (field_message.empty() || separator == 0 ||
+        (separator != std::string_view::npos && field_message.find(';', separator + 1) != std::string_view::npos))
     {
         throw std::runtime_error(fmt::format("ZeroMQVariableInfo: cannot create variable info from message "
-                                             "{}. Expected exactly 1 ';', found {}.",
-                                             field_message, split.size()));
+                                             "{}. Expected a name and exactly 1 ';'.",
+                                             field_message));
     }
 
-    variable_info.name = split[0];
+    name.assign(field_message.substr(0, separator));
+    dimension_sizes.clear();
+
     // If no dimension info available, assume scalar and set dimensions to 0
-    if (split.size() == 1)
+    if (separator == std::string_view::npos)
     {
         // NOTE: push back 1 to dimension info?
-        return variable_info;
+        return;
     }
 
-    auto numbers = split_string(split[1], ',');
-    for (auto number : numbers)
+    auto numbers = field_message.substr(separator + 1);
+    while (!numbers.empty())
     {
-        variable_info.dimension_sizes.push_back(std::stoi(std::string(number)));
+        auto comma = numbers.find(',');
+        auto number = numbers.substr(0, comma);
+        if (!number.empty())
+        {
+            std::size_t dimension_size{};
+            auto result = std::from_chars(number.data(), number.data() + number.size(), dimension_size);
+            if (result.ec != std::errc{} || result.ptr != number.data() + number.size())
+            {
+                throw std::runtime_error(fmt::format(
+                    "ZeroMQVariableInfo: cannot parse dimension size '{}' in message {}.", number, field_message));
+            }
+            dimension_sizes.push_back(dimension_size);
+        }
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        numbers = numbers.substr(comma + 1);
     }
-    return variable_info;
 }
 
+/**
+ * Little-endian encoding of the binary header integers
+ */
+template <typename IntegerType>
+static std::uint8_t* write_little_endian(std::uint8_t* output, IntegerType value)
+{
+    for (std::size_t i = 0; i < sizeof(IntegerType); i++)
+    {
+        output[i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i));
+    }
+    return output + sizeof(IntegerType);
+}
+
+template <typename IntegerType>
+static const std::uint8_t* read_little_endian(const std::uint8_t* input, IntegerType& value)
+{
+    std::uint64_t result{};
+    for (std::size_t i = 0; i < sizeof(IntegerType); i++)
+    {
+        result |= static_cast<std::uint64_t>(input[i]) << (8 * i);
+    }
+    value = static_cast<IntegerType>(result);
+    return input + sizeof(IntegerType);
+}
+
+static constexpr std::size_t binary_fixed_size =
+    sizeof(std::uint8_t) + sizeof(std::uint8_t) + sizeof(std::uint16_t) + sizeof(std::uint32_t);
+
+std::size_t ZeroMQVariableInfo::binary_size(const std::string_view name, std::size_t rank)
+{
+    return binary_fixed_size + rank * sizeof(std::uint64_t) + name.size();
+}
+
+void ZeroMQVariableInfo::to_binary(const std::string_view name, ZeroMQElementType element_type,
+                                   const std::vector<std::size_t>& dimension_sizes, void* output)
+{
+    auto* cursor = static_cast<std::uint8_t*>(output);
+    cursor = write_little_endian(cursor, binary_version);
+    cursor = write_little_endian(cursor, static_cast<std::uint8_t>(element_type));
+    cursor = write_little_endian(cursor, static_cast<std::uint16_t>(dimension_sizes.size()));
+    cursor = write_little_endian(cursor, static_cast<std::uint32_t>(name.size()));
+    for (auto dimension_size : dimension_sizes)
+    {
+        cursor = write_little_endian(cursor, static_cast<std::uint64_t>(dimension_size));
+    }
+    std::memcpy(cursor, name.data(), name.size());
+}
+
+std::string ZeroMQVariableInfo::to_binary() const
+{
+    std::string output(binary_size(name, dimension_sizes.size()), '\0');
+    to_binary(name, element_type, dimension_sizes, output.data());
+    return output;
+}
+
+std::size_t ZeroMQVariableInfo::binary_id_size(std::size_t rank)
+{
+    return binary_fixed_size + rank * sizeof(std::uint64_t);
+}
+
+void ZeroMQVariableInfo::to_binary_id(std::uint32_t field_id, ZeroMQElementType element_type,
+                                      const std::vector<std::size_t>& dimension_sizes, void* output)
+{
+    auto* cursor = static_cast<std::uint8_t*>(output);
+    cursor = write_little_endian(cursor, binary_id_version);
+    cursor = write_little_endian(cursor, static_cast<std::uint8_t>(element_type));
+    cursor = write_little_endian(cursor, static_cast<std::uint16_t>(dimension_sizes.size()));
+    cursor = write_little_endian(cursor, field_id);
+    for (auto dimension_size : dimension_sizes)
+    {
+        cursor = write_little_endian(cursor, static_cast<std::uint64_t>(dimension_size));
+    }
+}
+
+void ZeroMQVariableInfo::parse_binary(const std::string_view field_message)
+{
+    if (field_message.size() < binary_fixed_size)
+    {
+        throw std::runtime_error(fmt::format(
+            "ZeroMQVariableInfo: binary header of {} bytes is too short.", field_message.size()));
+    }
+
+    const auto* cursor = reinterpret_cast<const std::uint8_t*>(field_message.data());
+    std::uint8_t version{};
+    std::uint8_t type{};
+    std::uint16_t rank{};
+    std::uint32_t name_size{};
+    cursor = read_little_endian(cursor, version);
+    cursor = read_little_endian(cursor, type);
+    cursor = read_little_endian(cursor, rank);
+    cursor = read_little_endian(cursor, name_size);
+
+    // The name length is the field id in the headers without the name
+    field_id = Field::no_id;
+    if (version == binary_id_version)
+    {
+        field_id = name_size;
+        name_size = 0;
+    }
+    else if (version != binary_version)
+    {
+        throw std::runtime_error(fmt::format("ZeroMQVariableInfo: unsupported binary header version {}.", version));
+    }
+    if (field_message.size() != binary_fixed_size + rank * sizeof(std::uint64_t) + name_size)
+    {
+        throw std::runtime_error(fmt::format(
+            "ZeroMQVariableInfo: binary header of {} bytes does not match rank {} and name length {}.",
+            field_message.size(), rank, name_size));
+    }
+
+    element_type = static_cast<ZeroMQElementType>(type);
+    dimension_sizes.resize(rank);
+    for (auto& dimension_size : dimension_sizes)
+    {
+        std::uint64_t size{};
+        cursor = read_little_endian(cursor, size);
+        dimension_size = size;
+    }
+    name.assign(reinterpret_cast<const char*>(cursor), name_size);
+}
+
+void ZeroMQVariableInfo::decode(const std::string_view field_message)
+{
+    auto version = field_message.empty() ? 0 : static_cast<std::uint8_t>(field_message.front());
+    if (version == binary_version || version == binary_id_version)
+    {
+        parse_binary(field_message);
+    }
+    else
+    {
+        parse(field_message);
+        element_type = ZeroMQElementType::Unknown;
+        field_id = Field::no_id;
+    }
+}
+
+/**
+ * The prepared message waiting in the send queue
+ */
+struct ZeroMQOutgoingMessage
+{
+    // Two part field message, or a record in a single data message
+    zmq::message_t id_message{};
+    zmq::message_t data_message{};
+    bool is_record{};
+};
+
+/**
+ * Sends the queued messages from a background thread
+ *
+ * The pipe is the only producer, so the queue needs to support only a
+ * single producer and a single consumer. The sender thread sleeps while
+ * the queue is empty.
+ */
+class ZeroMQSender
+{
+  public:
+    ZeroMQSender(zmq::socket_t& socket, const ZeroMQConfiguration& config)
+        : m_socket(socket), m_queue(config.send_queue_depth), m_policy(config.queue_full_policy),
+          m_send_timeout_ms(config.send_timeout_ms)
+    {
+        m_thread = std::thread([this] { run(); });
+    }
+
+    ~ZeroMQSender()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stop = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+    /**
+     * Queue the message, the messages of a stream are not dropped as the
+     * receiver needs all of them
+     */
+    void push(ZeroMQOutgoingMessage&& message, bool may_drop = true)
+    {
+        rethrow_error();
+
+        if (!m_queue.try_push(std::move(message)))
+        {
+            if (may_drop && m_policy == ZeroMQQueueFullPolicy::Drop)
+            {
+                m_dropped_messages++;
+                return;
+            }
+
+            auto stall_start = std::chrono::steady_clock::now();
+            if (!wait_until([&] { return m_queue.try_push(std::move(message)); }, m_send_timeout_ms))
+            {
+                throw std::runtime_error(fmt::format(
+                    "ZeroMQPipe: timed out waiting for space, {} messages queued.", m_queue.size()));
+            }
+            m_stalls++;
+            m_stall_seconds +=
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - stall_start).count();
+        }
+
+        m_queued_messages++;
+        m_max_queue_depth = std::max(m_max_queue_depth, m_queue.size());
+
+        if (m_waiting.load())
+        {
+            std::lock_guard lock{m_mutex};
+            m_condition.notify_one();
+        }
+    }
+
+    void flush()
+    {
+        if (!wait_until([&] { return m_completed_messages.load() == m_queued_messages; }, m_send_timeout_ms))
+        {
+            rethrow_error();
+            throw std::runtime_error(
+                fmt::format("ZeroMQPipe: timed out waiting for {} queued messages to be sent.",
+                            m_queued_messages - m_completed_messages.load()));
+        }
+        rethrow_error();
+    }
+
+    ZeroMQSendStatistics statistics() const
+    {
+        return ZeroMQSendStatistics{.queue_depth = m_queue.size(),
+                                    .max_queue_depth = m_max_queue_depth,
+                                    .sent_messages = m_completed_messages.load(),
+                                    .dropped_messages = m_dropped_messages,
+                                    .stalls = m_stalls,
+                                    .stall_seconds = m_stall_seconds};
+    }
+
+  private:
+    void run()
+    {
+        ZeroMQOutgoingMessage message{};
+        while (true)
+        {
+            if (m_queue.try_pop(message))
+            {
+                send(message);
+                message = ZeroMQOutgoingMessage{};
+                m_completed_messages++;
+                continue;
+            }
+
+            std::unique_lock lock{m_mutex};
+            if (m_stop)
+            {
+                break;
+            }
+            // The timeout guards against missing a push between the flag and the wait
+            m_waiting = true;
+            m_condition.wait_for(lock, std::chrono::milliseconds(1),
+                                 [this] { return m_stop || !m_queue.empty(); });
+            m_waiting = false;
+        }
+    }
+
+    void send(ZeroMQOutgoingMessage& message)
+    {
+        // Keep draining the queue after a failure so that flush() returns
+        if (m_failed.load())
+        {
+            return;
+        }
+
+        try
+        {
+            if (!message.is_record && !m_socket.send(message.id_message, zmq::send_flags::sndmore))
+            {
+                throw std::runtime_error("Error sending an id message with zeromq.");
+            }
+            if (!m_socket.send(message.data_message, zmq::send_flags::none))
+            {
+                throw std::runtime_error("Error sending a data message with zeromq.");
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard lock{m_mutex};
+            m_error = std::current_exception();
+            m_failed = true;
+        }
+    }
+
+    void rethrow_error()
+    {
+        if (!m_failed.load())
+        {
+            return;
+        }
+
+        std::exception_ptr error{};
+        {
+            std::lock_guard lock{m_mutex};
+            std::swap(error, m_error);
+            m_failed = false;
+        }
+        std::rethrow_exception(error);
+    }
+
+    zmq::socket_t& m_socket;
+    SPSCQueue<ZeroMQOutgoingMessage> m_queue;
+    ZeroMQQueueFullPolicy m_policy{};
+    int m_send_timeout_ms{};
+
+    std::thread m_thread{};
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    bool m_stop{};
+    std::atomic<bool> m_waiting{};
+
+    // Written by the sender thread
+    std::atomic<std::size_t> m_completed_messages{};
+    std::atomic<bool> m_failed{};
+    std::exception_ptr m_error{};
+
+    // Written by the writing thread
+    std::size_t m_queued_messages{};
+    std::size_t m_max_queue_depth{};
+    std::size_t m_dropped_messages{};
+    std::size_t m_stalls{};
+    double m_stall_seconds{};
+};
+
+/**
+ * Reused buffers for the chunks of the streamed arrays
+ *
+ * The buffers are handed to zeromq without copying and zeromq returns them to
+ * the pool once the chunk has been sent. Waiting for a free buffer bounds the
+ * memory used by a stream to the buffers of the pool. The sent chunks keep the
+ * pool alive.
+ */
+class ZeroMQChunkPool : public std::enable_shared_from_this<ZeroMQChunkPool>
+{
+  public:
+    ZeroMQChunkPool(std::size_t buffer_size, std::size_t max_buffers, int timeout_ms)
+        : m_buffer_size(buffer_size), m_max_buffers(std::max<std::size_t>(max_buffers, 1)),
+          m_timeout_ms(timeout_ms)
+    {
+    }
+
+    std::size_t buffer_size() const { return m_buffer_size; }
+
+    /**
+     * Take a free buffer, waiting for zeromq to release one when all are in flight.
+     * Throws when none is released in timeout_ms, a negative timeout waits indefinitely
+     */
+    std::uint8_t* acquire()
+    {
+        std::unique_lock lock{m_mutex};
+        if (m_free_buffers.empty() && m_buffers.size() < m_max_buffers)
+        {
+            m_buffers.push_back(std::make_unique<std::uint8_t[]>(m_buffer_size));
+            return m_buffers.back().get();
+        }
+
+        auto is_released = [this] { return !m_free_buffers.empty(); };
+        if (m_timeout_ms < 0)
+        {
+            m_condition.wait(lock, is_released);
+        }
+        else if (!m_condition.wait_for(lock, std::chrono::milliseconds(m_timeout_ms), is_released))
+        {
+            throw std::runtime_error(fmt::format(
+                "ZeroMQPipe: timed out waiting for one of the {} chunks in flight to be sent.",
+                m_buffers.size()));
+        }
+        auto* buffer = m_free_buffers.back();
+        m_free_buffers.pop_back();
+        return buffer;
+    }
+
+    /**
+     * Message of the first size bytes of the buffer, the buffer returns to the pool
+     * when zeromq releases the message
+     */
+    zmq::message_t message(std::uint8_t* buffer, std::size_t size)
+    {
+        auto* owner = new std::shared_ptr<ZeroMQChunkPool>(shared_from_this());
+        return zmq::message_t(buffer, size, release, owner);
+    }
+
+  private:
+    // Called by zeromq, possibly from its I/O thread
+    static void release(void* data, void* hint)
+    {
+        auto* owner = static_cast<std::shared_ptr<ZeroMQChunkPool>*>(hint);
+        auto& pool = **owner;
+        {
+            std::lock_guard lock{pool.m_mutex};
+            pool.m_free_buffers.push_back(static_cast<std::uint8_t*>(data));
+        }
+        pool.m_condition.notify_one();
+        delete owner;
+    }
+
+    std::size_t m_buffer_size{};
+    std::size_t m_max_buffers{};
+    int m_timeout_ms{};
+
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    std::vector<std::unique_ptr<std::uint8_t[]>> m_buffers{};
+    std::vector<std::uint8_t*> m_free_buffers{};
+};
+
 ZeroMQPipe::ZeroMQPipe()
 {
     // If the incoming socket is not yet created at the time
@@ -72,6 +513,31 @@ ZeroMQPipe::ZeroMQPipe(const ZeroMQConfiguration& config) : m_config(config)
     // This behaviour should likely be revisited
     get_outbound_socket();
     get_incoming_socket();
+
+    if (m_config.asynchronous_send)
+    {
+        m_sender = std::make_unique<ZeroMQSender>(get_outbound_socket(), m_config);
+    }
+}
+
+// The sender thread is stopped before the sockets are closed
+ZeroMQPipe::~ZeroMQPipe() { m_sender.reset(); }
+
+void ZeroMQPipe::flush()
+{
+    if (m_sender)
+    {
+        m_sender->flush();
+    }
+}
+
+ZeroMQSendStatistics ZeroMQPipe::send_statistics() const
+{
+    if (m_sender)
+    {
+        return m_sender->statistics();
+    }
+    return ZeroMQSendStatistics{};
 }
 
 zmq::context_t& ZeroMQPipe::get_context()
@@ -101,11 +567,800 @@ zmq::socket_t& ZeroMQPipe::get_incoming_socket()
     if (!m_incoming_socket)
     {
         m_incoming_socket = std::make_unique<zmq::socket_t>(context, zmq::socket_type::pull);
+        m_incoming_socket->set(zmq::sockopt::rcvtimeo, m_config.receive_timeout_ms);
         m_incoming_socket->connect(m_config.incoming_socket);
     }
     return *m_incoming_socket;
 }
 
+zmq::message_t ZeroMQPipe::header_message(const Field& field, ZeroMQElementType element_type,
+                                          const std::vector<std::size_t>& dimension_sizes)
+{
+    if (m_config.header_encoding == ZeroMQHeaderEncoding::Text)
+    {
+        validate_name(field.path);
+        ZeroMQVariableInfo variable_info{std::string(field.path), dimension_sizes};
+        auto info_string = variable_info.to_string();
+        return zmq::message_t(info_string.data(), info_string.size());
+    }
+
+    if (m_schema && field.has_id())
+    {
+        auto message = zmq::message_t(ZeroMQVariableInfo::binary_id_size(dimension_sizes.size()));
+        ZeroMQVariableInfo::to_binary_id(field.id, element_type, dimension_sizes, message.data());
+        return message;
+    }
+
+    validate_name(field.path);
+    auto message = zmq::message_t(ZeroMQVariableInfo::binary_size(field.path, dimension_sizes.size()));
+    ZeroMQVariableInfo::to_binary(field.path, element_type, dimension_sizes, message.data());
+    return message;
+}
+
+void ZeroMQPipe::send(const Field& field, ZeroMQElementType element_type,
+                      const std::vector<std::size_t>& dimension_sizes, zmq::message_t& data_message)
+{
+    send_pending_schema();
+
+    // Get a socket for writing
+    auto& socket = get_outbound_socket();
+
+    auto id_message = header_message(field, element_type, dimension_sizes);
+
+    if (m_sender)
+    {
+        m_sender->push(ZeroMQOutgoingMessage{std::move(id_message), std::move(data_message)});
+        return;
+    }
+
+    if (!socket.send(id_message, zmq::send_flags::sndmore))
+    {
+        throw std::runtime_error(fmt::format("Error sending a message with id {} with zeromq.", field.path));
+    }
+    if (!socket.send(data_message, zmq::send_flags::none))
+    {
+        throw std::runtime_error(
+            fmt::format("Error sending a data message with id {} with zeromq.", field.path));
+    }
+}
+
+/**
+ * The record is sent as a single message
+ *
+ *   u8  record marker
+ *   u8  reserved [3]
+ *   u32 field count
+ *
+ * followed by each field
+ *
+ *   u32 header size
+ *   u32 reserved
+ *   u64 data size
+ *   header
+ *   data
+ *
+ * with the header and the data starting at 8 byte boundaries.
+ */
+static constexpr std::uint8_t record_marker{0x80};
+static constexpr std::size_t record_header_size{8};
+static constexpr std::size_t record_field_header_size{16};
+static constexpr std::size_t record_alignment{8};
+
+static std::size_t align_record_offset(std::size_t offset)
+{
+    return (offset + record_alignment - 1) / record_alignment * record_alignment;
+}
+
+/**
+ * The schema is sent as a single message
+ *
+ *   u8  schema marker
+ *   u8  reserved [3]
+ *   u32 path count
+ *   u64 fingerprint
+ *
+ * followed by each path
+ *
+ *   u32 path length
+ *   path
+ */
+static constexpr std::uint8_t schema_marker{0x81};
+static constexpr std::size_t schema_header_size{16};
+
+void ZeroMQPipe::use_schema(const Schema& schema)
+{
+    m_schema = schema;
+    m_schema_pending = true;
+}
+
+void ZeroMQPipe::send_pending_schema()
+{
+    if (!m_schema_pending)
+    {
+        return;
+    }
+    m_schema_pending = false;
+
+    std::size_t size{schema_header_size};
+    for (auto& path : m_schema->paths)
+    {
+        size += sizeof(std::uint32_t) + path.size();
+    }
+
+    auto message = zmq::message_t(size);
+    auto* cursor = message.data<std::uint8_t>();
+    cursor = write_little_endian(cursor, schema_marker);
+    cursor = write_little_endian(cursor, std::uint8_t{0});
+    cursor = write_little_endian(cursor, std::uint16_t{0});
+    cursor = write_little_endian(cursor, static_cast<std::uint32_t>(m_schema->paths.size()));
+    cursor = write_little_endian(cursor, m_schema->fingerprint);
+    for (auto& path : m_schema->paths)
+    {
+        cursor = write_little_endian(cursor, static_cast<std::uint32_t>(path.size()));
+        std::memcpy(cursor, path.data(), path.size());
+        cursor += path.size();
+    }
+
+    // The receiver needs the schema to resolve the ids, it is never dropped
+    if (m_sender)
+    {
+        m_sender->push(ZeroMQOutgoingMessage{{}, std::move(message), true}, false);
+        return;
+    }
+
+    if (!get_outbound_socket().send(message, zmq::send_flags::none))
+    {
+        throw std::runtime_error("Error sending the schema with zeromq.");
+    }
+}
+
+void ZeroMQPipe::receive_schema(const zmq::message_t& message)
+{
+    auto* schema = message.data<std::uint8_t>();
+    auto size = message.size();
+    if (size < schema_header_size)
+    {
+        throw std::runtime_error("ZeroMQPipe: received schema is truncated.");
+    }
+
+    std::uint32_t path_count{};
+    std::uint64_t fingerprint{};
+    read_little_endian(schema + 4, path_count);
+    read_little_endian(schema + 8, fingerprint);
+
+    if (m_schema)
+    {
+        if (m_schema->fingerprint != fingerprint || m_schema->paths.size() != path_count)
+        {
+            throw std::runtime_error(
+                fmt::format("ZeroMQPipe: received schema {:016x} with {} fields, expected schema {:016x} "
+                            "with {} fields.",
+                            fingerprint, path_count, m_schema->fingerprint, m_schema->paths.size()));
+        }
+        return;
+    }
+
+    // Without a schema of our own, the received paths are used for the received ids
+    Schema received{fingerprint, {}};
+    std::size_t offset{schema_header_size};
+    for (std::uint32_t i = 0; i < path_count; i++)
+    {
+        std::uint32_t path_size{};
+        if (offset + sizeof(path_size) > size)
+        {
+            throw std::runtime_error("ZeroMQPipe: received schema is truncated.");
+        }
+        read_little_endian(schema + offset, path_size);
+        offset += sizeof(path_size);
+        if (path_size > size - offset)
+        {
+            throw std::runtime_error("ZeroMQPipe: received schema is truncated.");
+        }
+        received.paths.emplace_back(reinterpret_cast<const char*>(schema + offset), path_size);
+        offset += path_size;
+    }
+    m_schema = std::move(received);
+}
+
+bool ZeroMQPipe::incoming_matches(const Field& field) const
+{
+    if (m_incoming_info.field_id == Field::no_id)
+    {
+        return m_incoming_info.name == field.path;
+    }
+    // Both ends use the same schema, so the ids can be compared directly
+    if (field.has_id())
+    {
+        return m_incoming_info.field_id == field.id;
+    }
+    return incoming_path() == field.path;
+}
+
+std::string_view ZeroMQPipe::incoming_path() const
+{
+    if (m_incoming_info.field_id == Field::no_id)
+    {
+        return m_incoming_info.name;
+    }
+    if (!m_schema || m_incoming_info.field_id >= m_schema->paths.size())
+    {
+        throw std::runtime_error(
+            fmt::format("ZeroMQPipe: received field id {} that is not in the schema.", m_incoming_info.field_id));
+    }
+    return m_schema->paths[m_incoming_info.field_id];
+}
+
+void ZeroMQPipe::begin_record()
+{
+    if (!m_config.record_batching)
+    {
+        return;
+    }
+
+    if (m_record_depth == 0)
+    {
+        // Keeps the capacity from the previous records
+        m_record_buffer.assign(record_header_size, 0);
+        m_record_buffer[0] = record_marker;
+        m_record_field_count = 0;
+    }
+    m_record_depth++;
+}
+
+void ZeroMQPipe::end_record()
+{
+    if (!m_config.record_batching)
+    {
+        return;
+    }
+
+    if (m_record_depth == 0)
+    {
+        throw std::runtime_error("ZeroMQPipe: end_record() called without matching begin_record().");
+    }
+
+    m_record_depth--;
+    if (m_record_depth > 0)
+    {
+        return;
+    }
+
+    send_record();
+}
+
+void ZeroMQPipe::send_record()
+{
+    if (m_record_field_count == 0)
+    {
+        return;
+    }
+
+    write_little_endian(m_record_buffer.data() + 4, m_record_field_count);
+
+    send_pending_schema();
+
+    auto& socket = get_outbound_socket();
+    auto record_message = zmq::message_t(m_record_buffer.data(), m_record_buffer.size());
+    auto field_count = m_record_field_count;
+
+    // Start collecting the next fields, keeping the capacity
+    m_record_buffer.resize(record_header_size);
+    m_record_field_count = 0;
+
+    if (m_sender)
+    {
+        m_sender->push(ZeroMQOutgoingMessage{{}, std::move(record_message), true});
+        return;
+    }
+
+    if (!socket.send(record_message, zmq::send_flags::none))
+    {
+        throw std::runtime_error(
+            fmt::format("Error sending a record of {} fields with zeromq.", field_count));
+    }
+}
+
+/**
+ * The array larger than the chunk size is streamed as a start message
+ *
+ *   u8  stream marker
+ *   u8  reserved [3]
+ *   u32 header size
+ *   u64 data size
+ *   header
+ *
+ * followed by the chunks of the flat data, each in its own message
+ *
+ *   u8  chunk marker
+ *   u8  reserved [7]
+ *   data
+ *
+ * The chunks of a stream follow the start message without other messages in between.
+ */
+static constexpr std::uint8_t stream_marker{0x82};
+static constexpr std::uint8_t chunk_marker{0x83};
+static constexpr std::size_t stream_header_size{16};
+static constexpr std::size_t chunk_header_size{8};
+
+void ZeroMQPipe::begin_stream(const Field& field, ZeroMQElementType element_type,
+                              const std::vector<std::size_t>& dimension_sizes, std::size_t size)
+{
+    // The fields written to the record before the stream are sent first to keep the order
+    if (m_record_depth > 0)
+    {
+        send_record();
+    }
+
+    send_pending_schema();
+
+    auto header = header_message(field, element_type, dimension_sizes);
+    auto start_message = zmq::message_t(stream_header_size + header.size());
+    auto* cursor = start_message.data<std::uint8_t>();
+    cursor = write_little_endian(cursor, stream_marker);
+    cursor = write_little_endian(cursor, std::uint8_t{0});
+    cursor = write_little_endian(cursor, std::uint16_t{0});
+    cursor = write_little_endian(cursor, static_cast<std::uint32_t>(header.size()));
+    cursor = write_little_endian(cursor, static_cast<std::uint64_t>(size));
+    std::memcpy(cursor, header.data(), header.size());
+
+    if (!m_chunk_pool)
+    {
+        m_chunk_pool = std::make_shared<ZeroMQChunkPool>(
+            chunk_header_size + m_config.chunk_size, m_config.max_chunks_in_flight, m_config.send_timeout_ms);
+    }
+    // A chunk left over from a failed stream is reused
+    m_outgoing_chunk_size = chunk_header_size;
+    m_outgoing_stream_left = size;
+
+    if (m_sender)
+    {
+        m_sender->push(ZeroMQOutgoingMessage{{}, std::move(start_message), true}, false);
+        return;
+    }
+
+    if (!get_outbound_socket().send(start_message, zmq::send_flags::none))
+    {
+        throw std::runtime_error(
+            fmt::format("Error sending the start of a stream {} with zeromq.", field.path));
+    }
+}
+
+void ZeroMQPipe::append_stream(const void* data, std::size_t size)
+{
+    if (size > m_outgoing_stream_left)
+    {
+        throw std::runtime_error(
+            fmt::format("ZeroMQPipe: Trying to stream {} bytes, when {} bytes are left in the stream.", size,
+                        m_outgoing_stream_left));
+    }
+    m_outgoing_stream_left -= size;
+
+    const auto capacity = m_chunk_pool->buffer_size();
+    auto* input = static_cast<const std::uint8_t*>(data);
+    while (size > 0)
+    {
+        if (!m_outgoing_chunk)
+        {
+            m_outgoing_chunk = m_chunk_pool->acquire();
+            std::memset(m_outgoing_chunk, 0, chunk_header_size);
+            m_outgoing_chunk[0] = chunk_marker;
+        }
+
+        auto copy_size = std::min(size, capacity - m_outgoing_chunk_size);
+        std::memcpy(m_outgoing_chunk + m_outgoing_chunk_size, input, copy_size);
+        m_outgoing_chunk_size += copy_size;
+        input += copy_size;
+        size -= copy_size;
+
+        if (m_outgoing_chunk_size == capacity)
+        {
+            send_chunk();
+            m_outgoing_chunk_size = chunk_header_size;
+        }
+    }
+}
+
+void ZeroMQPipe::end_stream()
+{
+    if (m_outgoing_stream_left > 0)
+    {
+        throw std::runtime_error(
+            fmt::format("ZeroMQPipe: Stream ended with {} bytes not written.", m_outgoing_stream_left));
+    }
+    if (m_outgoing_chunk && m_outgoing_chunk_size > chunk_header_size)
+    {
+        send_chunk();
+    }
+}
+
+void ZeroMQPipe::send_chunk()
+{
+    auto chunk_message = m_chunk_pool->message(m_outgoing_chunk, m_outgoing_chunk_size);
+    m_outgoing_chunk = nullptr;
+
+    if (m_sender)
+    {
+        m_sender->push(ZeroMQOutgoingMessage{{}, std::move(chunk_message), true}, false);
+        return;
+    }
+
+    if (!get_outbound_socket().send(chunk_message, zmq::send_flags::none))
+    {
+        throw std::runtime_error("Error sending a chunk of a stream with zeromq.");
+    }
+}
+
+void ZeroMQPipe::discard_record()
+{
+    m_record_depth = 0;
+    m_record_field_count = 0;
+    m_record_buffer.clear();
+}
+
+std::uint8_t* ZeroMQPipe::append_record_field(const Field& field,
+                                              ZeroMQElementType element_type,
+                                              const std::vector<std::size_t>& dimension_sizes,
+                                              std::size_t data_size)
+{
+    const bool use_id = m_schema && field.has_id();
+    if (!use_id)
+    {
+        validate_name(field.path);
+    }
+
+    std::string text_header{};
+    std::size_t header_size{};
+    if (m_config.header_encoding == ZeroMQHeaderEncoding::Text)
+    {
+        ZeroMQVariableInfo variable_info{std::string(field.path), dimension_sizes};
+        text_header = variable_info.to_string();
+        header_size = text_header.size();
+    }
+    else if (use_id)
+    {
+        header_size = ZeroMQVariableInfo::binary_id_size(dimension_sizes.size());
+    }
+    else
+    {
+        header_size = ZeroMQVariableInfo::binary_size(field.path, dimension_sizes.size());
+    }
+
+    auto field_offset = m_record_buffer.size();
+    auto header_offset = field_offset + record_field_header_size;
+    auto data_offset = align_record_offset(header_offset + header_size);
+    m_record_buffer.resize(align_record_offset(data_offset + data_size));
+
+    auto* field_header = m_record_buffer.data() + field_offset;
+    field_header = write_little_endian(field_header, static_cast<std::uint32_t>(header_size));
+    field_header = write_little_endian(field_header, std::uint32_t{0});
+    write_little_endian(field_header, static_cast<std::uint64_t>(data_size));
+
+    if (m_config.header_encoding == ZeroMQHeaderEncoding::Text)
+    {
+        std::memcpy(m_record_buffer.data() + header_offset, text_header.data(), header_size);
+    }
+    else if (use_id)
+    {
+        ZeroMQVariableInfo::to_binary_id(field.id, element_type, dimension_sizes,
+                                         m_record_buffer.data() + header_offset);
+    }
+    else
+    {
+        ZeroMQVariableInfo::to_binary(field.path, element_type, dimension_sizes,
+                                      m_record_buffer.data() + header_offset);
+    }
+
+    m_record_field_count++;
+    return m_record_buffer.data() + data_offset;
+}
+
+void ZeroMQPipe::remove_record_field(std::size_t record_size)
+{
+    m_record_buffer.resize(record_size);
+    m_record_field_count--;
+}
+
+void ZeroMQPipe::receive(const Field& field, ZeroMQElementType element_type)
+{
+    const auto full_path = field.path;
+
+    // Release the frame of the previously read field
+    m_incoming_frame.reset();
+
+    if (m_pending_field_count == 0 || !take_pending_field(full_path))
+    {
+        // Keep the fields of the other variables until they are read
+        while (true)
+        {
+            receive_next_field(full_path);
+            if (incoming_matches(field))
+            {
+                break;
+            }
+            keep_pending_field(full_path);
+        }
+    }
+
+    // Text headers do not carry the element type
+    if (m_incoming_info.element_type != ZeroMQElementType::Unknown &&
+        m_incoming_info.element_type != element_type)
+    {
+        skip_stream();
+        throw std::runtime_error(fmt::format("Received '{}' with element type {}, expected element type {}.",
+                                             full_path, static_cast<int>(m_incoming_info.element_type),
+                                             static_cast<int>(element_type)));
+    }
+}
+
+bool ZeroMQPipe::take_pending_field(const std::string_view full_path)
+{
+    auto pending = m_pending_fields.find(full_path);
+    if (pending == m_pending_fields.end() || pending->second.empty())
+    {
+        return false;
+    }
+
+    auto& field = pending->second.front();
+    std::swap(m_incoming_info, field.info);
+    m_incoming_frame = std::move(field.frame);
+    m_incoming_data = m_incoming_frame->data<std::uint8_t>() + field.offset;
+    m_incoming_size = field.size;
+    m_incoming_streamed = false;
+
+    pending->second.pop_front();
+    m_pending_field_count--;
+    return true;
+}
+
+void ZeroMQPipe::keep_pending_field(const std::string_view full_path)
+{
+    if (m_pending_field_count >= m_config.max_pending_fields)
+    {
+        throw std::runtime_error(
+            fmt::format("ZeroMQPipe: received {} fields of other variables while waiting for '{}', last "
+                        "received '{}'.",
+                        m_pending_field_count, full_path, incoming_path()));
+    }
+
+    // Streams are kept whole
+    if (m_incoming_streamed)
+    {
+        assemble_stream();
+    }
+
+    // The payload stays in the received frame, which is shared with the pending field.
+    // Small messages are stored within the message object, so the payload is
+    // located by the offset from the start of the frame.
+    PendingField field{};
+    if (m_incoming_from_record)
+    {
+        field.frame = m_record_message;
+        field.offset =
+            static_cast<const std::uint8_t*>(m_incoming_data) - m_record_message->data<std::uint8_t>();
+    }
+    else
+    {
+        field.frame = std::make_shared<zmq::message_t>(std::move(m_data_message));
+    }
+    field.size = m_incoming_size;
+    auto& pending = m_pending_fields[std::string(incoming_path())];
+    std::swap(field.info, m_incoming_info);
+
+    pending.push_back(std::move(field));
+    m_pending_field_count++;
+}
+
+void ZeroMQPipe::receive_next_field(const std::string_view full_path)
+{
+    if (m_record_fields_left == 0)
+    {
+        receive_messages(full_path);
+    }
+    if (m_record_fields_left > 0)
+    {
+        next_record_field();
+    }
+}
+
+void ZeroMQPipe::receive_messages(const std::string_view full_path)
+{
+    // get socket for reading
+    auto& socket = get_incoming_socket();
+
+    if (!socket.recv(m_id_message, zmq::recv_flags::none))
+    {
+        throw std::runtime_error(fmt::format("ZeroMQPipe: timed out waiting for '{}'.", full_path));
+    }
+
+    // The schema precedes the fields that use it
+    while (!m_id_message.more() && m_id_message.size() > 0 &&
+           m_id_message.data<std::uint8_t>()[0] == schema_marker)
+    {
+        receive_schema(m_id_message);
+        if (!socket.recv(m_id_message, zmq::recv_flags::none))
+        {
+            throw std::runtime_error(fmt::format("ZeroMQPipe: timed out waiting for '{}'.", full_path));
+        }
+    }
+
+    if (!m_id_message.more() && m_id_message.size() >= stream_header_size &&
+        m_id_message.data<std::uint8_t>()[0] == stream_marker)
+    {
+        auto* stream = m_id_message.data<std::uint8_t>();
+        std::uint32_t header_size{};
+        std::uint64_t data_size{};
+        read_little_endian(stream + 4, header_size);
+        read_little_endian(stream + 8, data_size);
+        if (header_size > m_id_message.size() - stream_header_size)
+        {
+            throw std::runtime_error("ZeroMQPipe: received stream header is truncated.");
+        }
+
+        m_incoming_info.decode(
+            std::string_view(reinterpret_cast<const char*>(stream + stream_header_size), header_size));
+        m_incoming_data = nullptr;
+        m_incoming_size = data_size;
+        m_incoming_from_record = false;
+        m_incoming_streamed = true;
+        m_incoming_stream_left = data_size;
+        m_incoming_chunk_left = 0;
+        return;
+    }
+
+    // Other single part messages are records
+    if (!m_id_message.more())
+    {
+        auto* record = m_id_message.data<std::uint8_t>();
+        if (m_id_message.size() < record_header_size || record[0] != record_marker)
+        {
+            throw std::runtime_error(
+                fmt::format("Error receiving a message with id {} with zeromq.", full_path));
+        }
+
+        std::uint32_t field_count{};
+        read_little_endian(record + 4, field_count);
+
+        // Reuse the record frame, unless pending fields still refer to it
+        if (!m_record_message || m_record_message.use_count() > 1)
+        {
+            m_record_message = std::make_shared<zmq::message_t>();
+        }
+        std::swap(*m_record_message, m_id_message);
+        m_record_offset = record_header_size;
+        m_record_fields_left = field_count;
+        return;
+    }
+
+    // The rest of a multipart message is always available
+    auto data_res = socket.recv(m_data_message, zmq::recv_flags::none);
+
+    m_incoming_info.decode(m_id_message.to_string_view());
+    m_incoming_data = m_data_message.data();
+    m_incoming_size = m_data_message.size();
+    m_incoming_from_record = false;
+    m_incoming_streamed = false;
+}
+
+void ZeroMQPipe::receive_stream(void* output, std::size_t size)
+{
+    auto* cursor = static_cast<std::uint8_t*>(output);
+    while (size > 0)
+    {
+        if (m_incoming_chunk_left == 0)
+        {
+            if (m_incoming_stream_left == 0)
+            {
+                throw std::runtime_error("ZeroMQPipe: Trying to read past the end of the received stream.");
+            }
+
+            if (!get_incoming_socket().recv(m_data_message, zmq::recv_flags::none))
+            {
+                throw std::runtime_error("ZeroMQPipe: timed out waiting for a chunk of a stream.");
+            }
+            auto* chunk = m_data_message.data<std::uint8_t>();
+            auto chunk_size = m_data_message.size();
+            if (m_data_message.more() || chunk_size <= chunk_header_size || chunk[0] != chunk_marker ||
+                chunk_size - chunk_header_size > m_incoming_stream_left)
+            {
+                m_incoming_stream_left = 0;
+                throw std::runtime_error("ZeroMQPipe: received an invalid chunk of a stream.");
+            }
+            m_incoming_chunk = chunk + chunk_header_size;
+            m_incoming_chunk_left = chunk_size - chunk_header_size;
+            m_incoming_stream_left -= m_incoming_chunk_left;
+        }
+
+        auto copy_size = std::min(size, m_incoming_chunk_left);
+        std::memcpy(cursor, m_incoming_chunk, copy_size);
+        m_incoming_chunk += copy_size;
+        m_incoming_chunk_left -= copy_size;
+        cursor += copy_size;
+        size -= copy_size;
+    }
+}
+
+void ZeroMQPipe::end_receive_stream()
+{
+    m_incoming_streamed = false;
+    if (m_incoming_stream_left > 0 || m_incoming_chunk_left > 0)
+    {
+        auto left = m_incoming_stream_left + m_incoming_chunk_left;
+        skip_stream();
+        throw std::runtime_error(fmt::format("ZeroMQPipe: {} bytes of the received stream not read.", left));
+    }
+}
+
+void ZeroMQPipe::skip_stream()
+{
+    if (!m_incoming_streamed)
+    {
+        return;
+    }
+    m_incoming_streamed = false;
+    m_incoming_chunk_left = 0;
+
+    while (m_incoming_stream_left > 0)
+    {
+        if (!get_incoming_socket().recv(m_data_message, zmq::recv_flags::none) ||
+            m_data_message.size() <= chunk_header_size ||
+            m_data_message.data<std::uint8_t>()[0] != chunk_marker ||
+            m_data_message.size() - chunk_header_size > m_incoming_stream_left)
+        {
+            m_incoming_stream_left = 0;
+            throw std::runtime_error("ZeroMQPipe: received an invalid chunk of a stream.");
+        }
+        m_incoming_stream_left -= m_data_message.size() - chunk_header_size;
+    }
+}
+
+void ZeroMQPipe::assemble_stream()
+{
+    auto assembled = zmq::message_t(m_incoming_size);
+    receive_stream(assembled.data(), assembled.size());
+    end_receive_stream();
+
+    m_data_message = std::move(assembled);
+    m_incoming_data = m_data_message.data();
+}
+
+void ZeroMQPipe::next_record_field()
+{
+    auto* record = m_record_message->data<std::uint8_t>();
+    auto record_size = m_record_message->size();
+
+    if (m_record_offset + record_field_header_size > record_size)
+    {
+        m_record_fields_left = 0;
+        throw std::runtime_error("ZeroMQPipe: received record is truncated.");
+    }
+
+    std::uint32_t header_size{};
+    std::uint32_t reserved{};
+    std::uint64_t data_size{};
+    const auto* field = record + m_record_offset;
+    field = read_little_endian(field, header_size);
+    field = read_little_endian(field, reserved);
+    read_little_endian(field, data_size);
+
+    auto header_offset = m_record_offset + record_field_header_size;
+    auto data_offset = align_record_offset(header_offset + header_size);
+    if (data_offset > record_size || data_size > record_size - data_offset)
+    {
+        m_record_fields_left = 0;
+        throw std::runtime_error("ZeroMQPipe: received record is truncated.");
+    }
+
+    m_incoming_info.decode(
+        std::string_view(reinterpret_cast<const char*>(record + header_offset), header_size));
+    m_incoming_data = record + data_offset;
+    m_incoming_size = data_size;
+    m_incoming_from_record = true;
+    m_incoming_streamed = false;
+
+    m_record_offset = align_record_offset(data_offset + data_size);
+    m_record_fields_left--;
+}
+
 void ZeroMQPipe::validate_name(std::string_view name) const
 {
     if (name.find(';') != std::string_view::npos)
@@ -1,11 +1,20 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
 #include <memory>
+#include <optional>
 
 #include <fmt/core.h>
 #include <zmq.hpp>
 
+#include "array_span_interface.h"
+#include "pipe_data.h"
+#include "record_scope.h"
+#include "schema.h"
 #include "utils.h"
 #include "vector_interface.h"
 
@@ -14,76 +23,141 @@
 namespace ncdlgen
 {
 
+/**
+ * The element type of the sent data, used to validate the received data
+ */
+using ZeroMQElementType = PipeElementType;
+
+template <typename ElementType> constexpr ZeroMQElementType zeromq_element_type()
+{
+    return pipe_element_type<ElementType>();
+}
+
 /**
  * The metadata that is required to reconstruct ND arrays after receiving them
+ *
+ * The metadata is sent in a compact binary header
+ *
+ *   u8  version
+ *   u8  element type
+ *   u16 rank
+ *   u32 name length
+ *   u64 dimension sizes [rank]
+ *   name
+ *
+ * with all the integers in little-endian. Once the schema has been sent, the
+ * generated interfaces send the field id instead of the name
+ *
+ *   u8  version
+ *   u8  element type
+ *   u16 rank
+ *   u32 field id
+ *   u64 dimension sizes [rank]
+ *
+ * The text header "name;dim1,dim2" is available for debugging.
  */
 struct ZeroMQVariableInfo
 {
     std::string name{};
     std::vector<std::size_t> dimension_sizes{};
+    ZeroMQElementType element_type{ZeroMQElementType::Unknown};
+    std::uint32_t field_id{Field::no_id};
+
+    static constexpr std::uint8_t binary_version{1};
+    static constexpr std::uint8_t binary_id_version{2};
 
     std::string to_string();
     static ZeroMQVariableInfo from_string_view(const std::string_view);
+
+    /**
+     * Parse the contents of the text field message to this info, reusing the storage
+     */
+    void parse(const std::string_view);
+
+    /**
+     * Encode the binary header to output, that has space for binary_size() bytes
+     */
+    static std::size_t binary_size(const std::string_view name, std::size_t rank);
+    static void to_binary(const std::string_view name, ZeroMQElementType element_type,
+                          const std::vector<std::size_t>& dimension_sizes, void* output);
+    std::string to_binary() const;
+
+    /**
+     * Encode the binary header with the field id to output, that has space for
+     * binary_id_size() bytes
+     */
+    static std::size_t binary_id_size(std::size_t rank);
+    static void to_binary_id(std::uint32_t field_id, ZeroMQElementType element_type,
+                             const std::vector<std::size_t>& dimension_sizes, void* output);
+
+    /**
+     * Decode the binary header to this info, reusing the storage
+     */
+    void parse_binary(const std::string_view);
+
+    /**
+     * Decode either a binary or a text header, binary headers start with the version.
+     * The name is empty for the headers with a field id.
+     */
+    void decode(const std::string_view);
 };
 
 template <typename ContainerType, typename ElementType, typename ContainerInterface>
-zmq::message_t message_for_type(const ContainerType& data)
+zmq::message_t message_for_type(const ContainerType& data, const std::vector<std::size_t>& dimension_sizes)
 {
-    if constexpr (std::is_fundamental_v<ContainerType>)
-    {
-        auto msg = zmq::message_t(&data, sizeof(ElementType));
-        return msg;
-    }
-    else if constexpr (ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>())
-    {
-        auto flat_data = ContainerInterface::template prepare<ElementType, ContainerType>(data);
+    auto msg = zmq::message_t(data_size<ContainerType, ElementType>(dimension_sizes));
+    copy_data<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes, msg.data());
+    return msg;
+}
 
-        auto msg = zmq::message_t(flat_data.data.data(), flat_data.data.size() * sizeof(ElementType));
-        return msg;
-    }
-    else
+/**
+ * Hand the ownership of the object holding the data to zeromq without copying
+ * the data. Zeromq deletes the owner after the message has been sent.
+ */
+template <typename OwnerType>
+zmq::message_t message_for_owner(std::unique_ptr<OwnerType> owner, const void* data, std::size_t size)
+{
+    // zeromq does not take empty buffers with a free function
+    if (size == 0)
     {
-        static_assert(always_false_v<ElementType>, "unsupported type");
+        return zmq::message_t{};
     }
+
+    auto release = [](void*, void* hint) { delete static_cast<OwnerType*>(hint); };
+    auto msg = zmq::message_t(const_cast<void*>(data), size, release, owner.get());
+    owner.release();
+    return msg;
 }
 
+/**
+ * Decode the received payload straight to the output container
+ */
 template <typename ContainerType, typename ElementType, typename ContainerInterface>
-ContainerType data_from_message(const zmq::message_t& message, const ZeroMQVariableInfo& variable_info)
+void data_from_buffer(ContainerType& output, const void* data, std::size_t size,
+                      const ZeroMQVariableInfo& variable_info)
 {
-    if constexpr (std::is_fundamental_v<ContainerType>)
-    {
-        if (message.size() != sizeof(ElementType))
-        {
-            throw std::runtime_error(
-                fmt::format("Incorrect size of input scalar message, expected size {}, received size {}",
-                            sizeof(ElementType), message.size()));
-        }
-        return *message.data<ElementType>();
-    }
-    else if constexpr (ContainerInterface::template is_supported_ndarray<ElementType, ContainerType>())
-    {
-        auto flat_data =
-            ContainerInterface::template prepare<ElementType, ContainerType>(variable_info.dimension_sizes);
+    data_from_buffer<ContainerType, ElementType, ContainerInterface>(output, data, size,
+                                                                     variable_info.dimension_sizes);
+}
 
-        if (message.size() != sizeof(ElementType) * flat_data.data.size())
-        {
-            throw std::runtime_error(
-                fmt::format("Incorrect size of input vector message, expected size {}, received size {}",
-                            sizeof(ElementType) * flat_data.data.size(), message.size()));
-        }
-        auto data_ptr = message.data<ElementType>();
-        flat_data.data.assign(data_ptr, data_ptr + message.size());
+/**
+ * Counters of the asynchronous sending, to size the send queue
+ */
+struct ZeroMQSendStatistics
+{
+    // The messages in the queue now, and the most there has been
+    std::size_t queue_depth{};
+    std::size_t max_queue_depth{};
+    // The messages handed to zeromq by the sender thread
+    std::size_t sent_messages{};
+    std::size_t dropped_messages{};
+    // The writes that found the queue full, and the total time they waited
+    std::size_t stalls{};
+    double stall_seconds{};
+};
 
-        // Format data from buffer to final container
-        ContainerType data{};
-        ContainerInterface::template finalise<ElementType, ContainerType>(data, flat_data);
-        return data;
-    }
-    else
-    {
-        static_assert(always_false_v<ElementType>, "unsupported type");
-    }
-}
+class ZeroMQSender;
+class ZeroMQChunkPool;
 
 /**
  * Write and read data from zeromq.
@@ -97,7 +171,7 @@ class ZeroMQPipe
     ZeroMQPipe();
     ZeroMQPipe(const ZeroMQConfiguration& config);
 
-    virtual ~ZeroMQPipe() = default;
+    virtual ~ZeroMQPipe();
 
     /**
      * Main inteface for writing data to socket
@@ -111,67 +185,199 @@ class ZeroMQPipe
      * Use the cdl full variable path as the id.
      */
     template <typename ContainerType, typename ElementType, typename ContainerInterface>
-    void write(const std::string_view full_path, const ContainerType& data)
+    void write(const Field& field, const ContainerType& data)
     {
-        validate_name(full_path);
+        auto dimension_sizes =
+            container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data);
+        auto size = data_size<ContainerType, ElementType>(dimension_sizes);
+
+        // Large arrays are streamed in chunks while they are flattened
+        if (m_config.chunk_size > 0 && size > m_config.chunk_size)
+        {
+            write_chunks<ContainerType, ElementType, ContainerInterface>(field, data, dimension_sizes, size);
+            return;
+        }
 
-        // Get a socket for writing
-        auto& socket = get_outbound_socket();
+        // Within a record, the data is flattened directly to the record message
+        if (m_record_depth > 0)
+        {
+            const auto record_size = m_record_buffer.size();
+            auto* output =
+                append_record_field(field, zeromq_element_type<ElementType>(), dimension_sizes, size);
+            try
+            {
+                copy_data<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes, output);
+            }
+            catch (...)
+            {
+                // A ragged container is found while it is copied, the record keeps its previous fields
+                remove_record_field(record_size);
+                throw;
+            }
+            return;
+        }
 
-        auto data_size =
-            VectorOperations::template container_dimension_sizes<ElementType, ContainerType>(data);
-        ZeroMQVariableInfo variable_info{std::string(full_path), data_size};
-        auto info_string = variable_info.to_string();
+        auto data_message =
+            message_for_type<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes);
 
-        auto id_message = zmq::message_t(info_string.data(), info_string.size());
-        auto data_message = message_for_type<ContainerType, ElementType, ContainerInterface>(data);
+        send(field, zeromq_element_type<ElementType>(), dimension_sizes, data_message);
+    }
 
-        if (!socket.send(id_message, zmq::send_flags::sndmore))
+    /**
+     * Write a container that is moved in. Contiguous containers are sent without
+     * copying, zeromq releases the container once the message is sent.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void write(const Field& field, ContainerType&& data)
+    {
+        // Records are sent as a single message, the data is copied to it
+        if (m_record_depth > 0)
         {
-            throw std::runtime_error(
-                fmt::format("Error sending a message with id {} with zeromq.", full_path));
+            write<ContainerType, ElementType, ContainerInterface>(field,
+                                                                  static_cast<const ContainerType&>(data));
         }
-        if (!socket.send(data_message, zmq::send_flags::none))
+        // The spans do not own the viewed memory, the elements are copied to the message
+        else if constexpr (InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType> &&
+                           !ArraySpanOperations::is_array_span_v<ContainerType>)
         {
-            throw std::runtime_error(
-                fmt::format("Error sending a data message with id {} with zeromq.", full_path));
+            auto dimension_sizes =
+                container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(data);
+            auto owner = std::make_unique<ContainerType>(std::move(data));
+            auto size = owner->size() * sizeof(ElementType);
+            auto* buffer = owner->data();
+            auto data_message = message_for_owner(std::move(owner), buffer, size);
+
+            send(field, zeromq_element_type<ElementType>(), dimension_sizes, data_message);
+        }
+        else
+        {
+            write<ContainerType, ElementType, ContainerInterface>(field,
+                                                                  static_cast<const ContainerType&>(data));
         }
     }
 
     /**
-     * Main inteface for reading data from netcdf
+     * Write a container shared with the caller. Contiguous containers are sent without
+     * copying, the pipe keeps the container alive until the message is sent.
      */
     template <typename ContainerType, typename ElementType, typename ContainerInterface>
-    ContainerType read(const std::string_view full_path)
+    void write(const Field& field, std::shared_ptr<const ContainerType> data)
     {
-        validate_name(full_path);
-
-        // get socket for reading
-        auto& socket = get_incoming_socket();
+        if (!data)
+        {
+            throw std::runtime_error(fmt::format("ZeroMQPipe: cannot write empty pointer to '{}'.", field.path));
+        }
 
-        zmq::message_t id_message;
-        zmq::message_t data_message;
-        auto res = socket.recv(id_message, zmq::recv_flags::none);
-        if (!id_message.more())
+        // Records are sent as a single message, the data is copied to it
+        if (m_record_depth > 0)
         {
-            throw std::runtime_error(
-                fmt::format("Error receiving a message with id {} with zeromq.", full_path));
+            write<ContainerType, ElementType, ContainerInterface>(field, *data);
         }
-        auto data_res = socket.recv(data_message, zmq::recv_flags::none);
+        else if constexpr (InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType> &&
+                           !ArraySpanOperations::is_array_span_v<ContainerType>)
+        {
+            auto dimension_sizes =
+                container_dimension_sizes<ContainerType, ElementType, ContainerInterface>(*data);
+            auto size = data->size() * sizeof(ElementType);
+            auto* buffer = data->data();
+            auto owner = std::make_unique<std::shared_ptr<const ContainerType>>(std::move(data));
+            auto data_message = message_for_owner(std::move(owner), buffer, size);
 
-        auto variable_info = ZeroMQVariableInfo::from_string_view(id_message.to_string_view());
-        if (variable_info.name != full_path)
+            send(field, zeromq_element_type<ElementType>(), dimension_sizes, data_message);
+        }
+        else
         {
-            throw std::runtime_error(
-                fmt::format("Received the id message with wrong id, expected '{}', received '{}", full_path,
-                            variable_info.name));
+            write<ContainerType, ElementType, ContainerInterface>(field, *data);
         }
+    }
+
+    /**
+     * Write the elements of caller-owned memory, see ArraySpan. The elements are
+     * copied once, straight to the message, as zeromq sends the message after
+     * the call returns, when the caller may already reuse the memory.
+     */
+    template <typename ElementType, std::size_t Rank>
+    void write(const Field& field, const ArraySpan<ElementType, Rank>& data)
+    {
+        write<ArraySpan<ElementType, Rank>, ElementType, ArraySpanInterface>(field, data);
+    }
 
-        auto data =
-            data_from_message<ContainerType, ElementType, ContainerInterface>(data_message, variable_info);
+    /**
+     * Main inteface for reading data from socket
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    ContainerType read(const Field& field)
+    {
+        ContainerType data{};
+        read_into<ContainerType, ElementType, ContainerInterface>(field, data);
         return data;
     }
 
+    /**
+     * Read data from socket to an existing container
+     *
+     * The data is decoded straight from the received message to the container. The
+     * existing capacity of the container is reused, so reading the same field
+     * repeatedly to the same container does not allocate once the container has grown
+     * to size.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void read_into(const Field& field, ContainerType& data)
+    {
+        receive(field, zeromq_element_type<ElementType>());
+
+        if (m_incoming_streamed)
+        {
+            read_chunks<ContainerType, ElementType, ContainerInterface>(data);
+            return;
+        }
+
+        data_from_buffer<ContainerType, ElementType, ContainerInterface>(data, m_incoming_data,
+                                                                         m_incoming_size, m_incoming_info);
+    }
+
+    /**
+     * Collect the writes until the matching end_record() to a single record message
+     *
+     * Instead of two messages per field, the whole record is sent with one send and
+     * received with one recv. The fields are read from a received record in the
+     * order they were written, with the same read calls as individual fields.
+     *
+     * Records can be nested, the outermost end_record() sends the record. Batching
+     * can be disabled with ZeroMQConfiguration::record_batching.
+     */
+    void begin_record();
+    void end_record();
+
+    /**
+     * Drop the fields collected since the outermost begin_record(), e.g. after a
+     * failed write
+     */
+    void discard_record();
+
+    /**
+     * Use the schema of a generated interface
+     *
+     * The schema is sent before the next message, after which the writes of the
+     * generated interfaces send the 32-bit field id instead of the path. When
+     * receiving a schema, its fingerprint is checked against the schema in use,
+     * or the received schema is used to look up the paths of the received ids.
+     */
+    void use_schema(const Schema& schema);
+
+    /**
+     * Wait until the sender thread has sent all the queued messages
+     *
+     * Rethrows the error of a failed asynchronous send. Returns immediately
+     * when sending synchronously.
+     */
+    void flush();
+
+    /**
+     * The counters of the asynchronous sending, all zero when sending synchronously
+     */
+    ZeroMQSendStatistics send_statistics() const;
+
     void validate_name(std::string_view name) const;
 
     /**
@@ -182,11 +388,229 @@ class ZeroMQPipe
     zmq::socket_t& get_outbound_socket();
 
   private:
+    /**
+     * Stream the data in chunks of ZeroMQConfiguration::chunk_size bytes
+     *
+     * The rows of the container are copied to the chunk being filled, and each full
+     * chunk is sent before the next rows are copied. Containers without row access
+     * are flattened first.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void write_chunks(const Field& field, const ContainerType& data,
+                      const std::vector<std::size_t>& dimension_sizes, std::size_t size)
+    {
+        begin_stream(field, zeromq_element_type<ElementType>(), dimension_sizes, size);
+
+        if constexpr (std::is_fundamental_v<ContainerType>)
+        {
+            append_stream(&data, size);
+        }
+        else if constexpr (InterfaceTraits::is_contiguous_v<ContainerInterface, ElementType, ContainerType>)
+        {
+            append_stream(data.data(), size);
+        }
+        else if constexpr (InterfaceTraits::has_for_each_row_v<ContainerInterface, ElementType,
+                                                                ContainerType>)
+        {
+            const std::size_t row_size = dimension_sizes.back();
+            ContainerInterface::template for_each_row<ElementType>(
+                data,
+                [&](const ElementType* row, std::size_t row_elements)
+                {
+                    if (row_elements != row_size)
+                    {
+                        throw std::runtime_error(
+                            fmt::format("ZeroMQPipe: Trying to stream row of size {}, when expecting rows of "
+                                        "size {}.",
+                                        row_elements, row_size));
+                    }
+                    append_stream(row, row_elements * sizeof(ElementType));
+                });
+        }
+        else
+        {
+            auto flat_data =
+                message_for_type<ContainerType, ElementType, ContainerInterface>(data, dimension_sizes);
+            append_stream(flat_data.data(), flat_data.size());
+        }
+
+        end_stream();
+    }
+
+    /**
+     * Reassemble the streamed chunks directly to the rows of the output container.
+     * Containers without row access are decoded from the whole reassembled array.
+     */
+    template <typename ContainerType, typename ElementType, typename ContainerInterface>
+    void read_chunks(ContainerType& data)
+    {
+        if constexpr (!std::is_fundamental_v<ContainerType> &&
+                      InterfaceTraits::has_for_each_row_v<ContainerInterface, ElementType, ContainerType> &&
+                      InterfaceTraits::has_reshape_v<ContainerInterface, ElementType, ContainerType>)
+        {
+            auto expected_size = data_size<ContainerType, ElementType>(m_incoming_info.dimension_sizes);
+            if (m_incoming_size != expected_size)
+            {
+                skip_stream();
+                throw std::runtime_error(
+                    fmt::format("Incorrect size of input vector stream, expected size {}, received size {}",
+                                expected_size, m_incoming_size));
+            }
+
+            ContainerInterface::template reshape<ElementType, ContainerType>(data,
+                                                                            m_incoming_info.dimension_sizes);
+            ContainerInterface::template for_each_row<ElementType>(
+                data, [&](ElementType* row, std::size_t row_elements)
+                { receive_stream(row, row_elements * sizeof(ElementType)); });
+            end_receive_stream();
+        }
+        else
+        {
+            assemble_stream();
+            data_from_buffer<ContainerType, ElementType, ContainerInterface>(
+                data, m_incoming_data, m_incoming_size, m_incoming_info);
+        }
+    }
+
+    /**
+     * Send the start of the stream, the chunks appended to it and the last partial chunk
+     */
+    void begin_stream(const Field& field, ZeroMQElementType element_type,
+                      const std::vector<std::size_t>& dimension_sizes, std::size_t size);
+    void append_stream(const void* data, std::size_t size);
+    void end_stream();
+    void send_chunk();
+
+    /**
+     * Copy the next bytes of the received stream to output, receiving chunks as needed
+     */
+    void receive_stream(void* output, std::size_t size);
+    void end_receive_stream();
+    void skip_stream();
+
+    /**
+     * Receive the rest of the stream to a single buffer, as the payload of the incoming field
+     */
+    void assemble_stream();
+
+    /**
+     * Send the collected fields of the record being written, keeping the record open
+     */
+    void send_record();
+
+    /**
+     * Send the id message followed by the data message, or queue them
+     * for the sender thread
+     */
+    void send(const Field& field, ZeroMQElementType element_type,
+              const std::vector<std::size_t>& dimension_sizes, zmq::message_t& data_message);
+
+    /**
+     * Send the schema before the first message after use_schema()
+     */
+    void send_pending_schema();
+    void receive_schema(const zmq::message_t& message);
+
+    /**
+     * Whether the received field is the requested field, and the path of the received field
+     */
+    bool incoming_matches(const Field& field) const;
+    std::string_view incoming_path() const;
+
+    /**
+     * Encode the header for the field with the configured header encoding
+     */
+    zmq::message_t header_message(const Field& field, ZeroMQElementType element_type,
+                                  const std::vector<std::size_t>& dimension_sizes);
+
+    /**
+     * Reserve a field in the record message, returns the location for the data
+     */
+    std::uint8_t* append_record_field(const Field& field, ZeroMQElementType element_type,
+                                      const std::vector<std::size_t>& dimension_sizes, std::size_t data_size);
+
+    /**
+     * Remove the last field of the record, reserved at the given size of the record
+     */
+    void remove_record_field(std::size_t record_size);
+
+    /**
+     * Receive the next field, either from the received record or from the socket
+     */
+    void receive(const Field& field, ZeroMQElementType element_type);
+    void receive_next_field(const std::string_view full_path);
+    void receive_messages(const std::string_view full_path);
+    void next_record_field();
+
+    /**
+     * Move the received field of another variable aside, or take the oldest
+     * kept field of the variable
+     */
+    void keep_pending_field(const std::string_view full_path);
+    bool take_pending_field(const std::string_view full_path);
+
     std::unique_ptr<zmq::context_t> m_context;
     std::unique_ptr<zmq::socket_t> m_incoming_socket;
     std::unique_ptr<zmq::socket_t> m_outbound_socket;
 
     ZeroMQConfiguration m_config{};
+
+    // The schema used to encode and decode the field ids
+    std::optional<Schema> m_schema{};
+    bool m_schema_pending{};
+
+    // Sends the messages in the asynchronous mode
+    std::unique_ptr<ZeroMQSender> m_sender;
+
+    // The record being written, reused between records
+    std::size_t m_record_depth{};
+    std::uint32_t m_record_field_count{};
+    std::vector<std::uint8_t> m_record_buffer{};
+
+    // Reused between reads
+    zmq::message_t m_id_message{};
+    zmq::message_t m_data_message{};
+    ZeroMQVariableInfo m_incoming_info{};
+
+    // The received record and the fields not yet read from it, shared
+    // with the pending fields of the record
+    std::shared_ptr<zmq::message_t> m_record_message{};
+    std::size_t m_record_offset{};
+    std::uint32_t m_record_fields_left{};
+
+    // The payload of the field being read, and the frame holding it when
+    // the field was kept pending
+    const void* m_incoming_data{};
+    std::size_t m_incoming_size{};
+    std::shared_ptr<zmq::message_t> m_incoming_frame{};
+    bool m_incoming_from_record{};
+
+    // The chunk buffers of the array being streamed, and the chunk being filled
+    std::shared_ptr<ZeroMQChunkPool> m_chunk_pool{};
+    std::uint8_t* m_outgoing_chunk{};
+    std::size_t m_outgoing_chunk_size{};
+    std::size_t m_outgoing_stream_left{};
+
+    // The received stream, m_incoming_size is the size of the whole array
+    bool m_incoming_streamed{};
+    std::size_t m_incoming_stream_left{};
+    const std::uint8_t* m_incoming_chunk{};
+    std::size_t m_incoming_chunk_left{};
+
+    /**
+     * Received field waiting to be read, the payload stays in the received frame
+     */
+    struct PendingField
+    {
+        ZeroMQVariableInfo info{};
+        std::shared_ptr<zmq::message_t> frame{};
+        std::size_t offset{};
+        std::size_t size{};
+    };
+
+    // The fields received out of order, by the variable path
+    std::map<std::string, std::deque<PendingField>, std::less<>> m_pending_fields{};
+    std::size_t m_pending_field_count{};
 };
 
 } // namespace ncdlgen
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ncdlgen
+{
+
+/**
+ * A variable of the schema, identified by the full path e.g. /group/variable
+ *
+ * The generated interfaces also pass the integer id of the variable, that the
+ * pipes can use instead of the path.
+ */
+struct Field
+{
+    static constexpr std::uint32_t no_id = std::numeric_limits<std::uint32_t>::max();
+
+    Field(const char* path) : path(path) {}
+    Field(std::string_view path) : path(path) {}
+    Field(const std::string& path) : path(path) {}
+    Field(std::uint32_t id, std::string_view path) : id(id), path(path) {}
+
+    bool has_id() const { return id != no_id; }
+
+    std::uint32_t id{no_id};
+    std::string_view path{};
+};
+
+/**
+ * The variables of a generated interface
+ *
+ * The id of a variable is the index of its path. The fingerprint is the
+ * hash of the cdl structure the interface was generated from.
+ */
+struct Schema
+{
+    std::uint64_t fingerprint{};
+    std::vector<std::string> paths{};
+};
+
+} // namespace ncdlgen
@@ -137,9 +137,9 @@ const std::string_view cpp_name_for_type(const NetCDFElementaryType& type)
     case NetCDFElementaryType::Int:
         return "int";
     case NetCDFElementaryType::Uint:
-        return "int32_t";
+        return "uint32_t";
     case NetCDFElementaryType::Long:
-        return "int64_t";
+        return "int";
     case NetCDFElementaryType::Int64:
         return "int64_t";
     case NetCDFElementaryType::Uint64:
@@ -568,17 +568,84 @@ std::optional<Attribute> Attribute::parse(Parser& parser, std::optional<NetCDFTy
         }
         attr.m_value = std::string(value->content());
     }
-    else if (attr.m_attribute_name == "_ChunkSizes" || attr.m_attribute_name == "_Storage" ||
-             attr.m_attribute_name == "_Fletcher32" || attr.m_attribute_name == "_DeflateLevel" ||
-             attr.m_attribute_name == "_Endianness" || attr.m_attribute_name == "_NoFill" ||
-             attr.m_attribute_name == "_IsNetcdf4")
+    else if (attr.m_attribute_name == "_ChunkSizes")
+    {
+        if (!variable)
+        {
+            parser.log_parse_error("No matching variable found when parsing attribute '_ChunkSizes'");
+            return {};
+        }
+        attr.m_type = NetCDFElementaryType::Int;
+        auto chunk_sizes = parser.parse_array(NetCDFElementaryType::Int);
+        if (!chunk_sizes || chunk_sizes->data.empty())
+        {
+            parser.log_parse_error("Could not parse value for attribute '_ChunkSizes'");
+            return {};
+        }
+        for (auto& chunk_size : chunk_sizes->data)
+        {
+            variable->storage().chunk_sizes.push_back(
+                std::visit([](auto value) { return static_cast<std::size_t>(value); }, chunk_size.value));
+        }
+        attr.m_value = VariableData(*chunk_sizes);
+    }
+    else if (attr.m_attribute_name == "_DeflateLevel")
+    {
+        if (!variable)
+        {
+            parser.log_parse_error("No matching variable found when parsing attribute '_DeflateLevel'");
+            return {};
+        }
+        attr.m_type = NetCDFElementaryType::Int;
+        auto deflate_level = parser.parse_number(NetCDFElementaryType::Int);
+        if (!deflate_level)
+        {
+            parser.log_parse_error("Could not parse value for attribute '_DeflateLevel'");
+            return {};
+        }
+        variable->storage().deflate_level =
+            std::visit([](auto value) { return static_cast<int>(value); }, deflate_level->value);
+        attr.m_value = VariableData(*deflate_level);
+    }
+    else if (attr.m_attribute_name == "_Storage")
+    {
+        auto value = parser.pop();
+        if (!value || value->content().empty() || !variable)
+        {
+            parser.log_parse_error("Could not parse value for attribute '_Storage'");
+            return {};
+        }
+        auto layout = unquoted(value->content());
+        if (layout == "chunked")
+        {
+            variable->storage().layout = StorageLayout::Chunked;
+        }
+        else if (layout == "contiguous")
+        {
+            variable->storage().layout = StorageLayout::Contiguous;
+        }
+        else if (layout == "compact")
+        {
+            variable->storage().layout = StorageLayout::Compact;
+        }
+        else
+        {
+            parser.log_parse_error(fmt::format("Unknown storage '{}' for attribute '_Storage'", layout));
+            return {};
+        }
+        attr.m_type = NetCDFElementaryType::String;
+        attr.m_value = std::string(value->content());
+    }
+    else if (attr.m_attribute_name == "_Fletcher32" || attr.m_attribute_name == "_Endianness" ||
+             attr.m_attribute_name == "_NoFill" || attr.m_attribute_name == "_IsNetcdf4")
     {
         auto value = parser.pop();
         if (!value || value->content().empty())
         {
             return {};
         }
-        // TODO: some of these are not just strings, like the chunksizes
+        // Kept as written, ncdump -s prints these as strings, except _IsNetcdf4. The
+        // storage attributes with a value the pipe applies are parsed above.
         attr.m_type = NetCDFElementaryType::String;
         attr.m_value = std::string(value->content());
     }
@@ -601,13 +668,17 @@ std::optional<Attribute> Attribute::parse(Parser& parser, std::optional<NetCDFTy
     }
     else if (attr.m_attribute_name == "_Shuffle")
     {
-        // TODO: Shuffle attribute is always Bool, but only parsed as string
+        // ncdump -s prints the flag as the string "true" or "false", the parsed flag
+        // is kept in the storage of the variable
         auto value = parser.pop();
-        if (!value || value->content().empty())
+        if (!value || value->content().empty() || !variable)
         {
             parser.log_parse_error("Could not parse value for attribute '_Shuffle'");
             return {};
         }
+        auto shuffle = unquoted(value->content());
+        variable->storage().shuffle = shuffle == "true" || shuffle == "1";
+        attr.m_type = NetCDFElementaryType::String;
         attr.m_value = std::string(value->content());
     }
     else if (attr.m_attribute_name == "valid_range")
@@ -238,10 +238,17 @@ class Attribute : public Element
     // Get string representation of the contained value
     std::string as_string() const;
 
-    std::optional<NetCDFType> type() { return m_type; }
+    std::optional<NetCDFType> type() const { return m_type; }
     const std::string_view name() const { return m_attribute_name; }
     std::string string_data() const;
 
+    // The variable of the attribute, empty for global attributes
+    std::string_view variable_name() const { return m_variable_name ? *m_variable_name : std::string_view{}; }
+    const std::variant<std::string, ValidRangeValue, FillValueAttributeValue, VariableData>& value() const
+    {
+        return m_value;
+    }
+
   private:
     std::optional<NetCDFType> m_type{};
     std::optional<std::string> m_variable_name{};
@@ -261,6 +268,28 @@ class VariableDimension : public Element
     static std::optional<VariableDimension> parse(Parser&);
 };
 
+enum class StorageLayout
+{
+    Chunked,
+    Contiguous,
+    Compact,
+};
+
+/**
+ * The storage of a variable set by the special attributes _Storage, _ChunkSizes,
+ * _DeflateLevel and _Shuffle, the unset parts use the defaults of the library
+ */
+struct VariableStorage
+{
+    std::optional<StorageLayout> layout{};
+    std::vector<std::size_t> chunk_sizes{};
+    std::optional<int> deflate_level{};
+    std::optional<bool> shuffle{};
+
+    bool has_layout() const { return layout.has_value() || !chunk_sizes.empty(); }
+    bool has_filters() const { return deflate_level.has_value() || shuffle.has_value(); }
+};
+
 class Variable : public Element
 {
   public:
@@ -276,9 +305,12 @@ class Variable : public Element
         // TODO: also scalar when we have only one dimension that has size 1
         return m_dimensions.empty();
     }
+    const VariableStorage& storage() const { return m_storage; }
+    VariableStorage& storage() { return m_storage; }
 
   private:
     std::optional<VariableData> m_value;
+    VariableStorage m_storage{};
     NetCDFType m_type{NetCDFElementaryType::Default};
     std::vector<VariableDimension> m_dimensions{};
 };
@@ -46,6 +46,15 @@ std::vector<std::string_view> split_string(const std::string_view view, const ch
     return split_components;
 }
 
+std::string_view unquoted(std::string_view input)
+{
+    if (input.size() >= 2 && input.front() == '"' && input.back() == '"')
+    {
+        return input.substr(1, input.size() - 2);
+    }
+    return input;
+}
+
 std::string read_file(std::string_view file_name)
 {
     std::ifstream istream{std::string(file_name)};
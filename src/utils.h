@@ -16,6 +16,9 @@ std::pair<std::string, std::string> split_string_at(std::string_view input, cons
 
 std::vector<std::string_view> split_string(const std::string_view view, const char character);
 
+// Remove the surrounding double quotes, if any
+std::string_view unquoted(std::string_view input);
+
 std::string read_file(std::string_view file_name);
 
 } // namespace ncdlgen
@@ -0,0 +1,42 @@
+#include "generated_fixed_array.h"
+
+const ncdlgen::Schema& ncdlgen_fixed_array::simple_schema()
+{
+    static const ncdlgen::Schema schema{0xe2066c7e9561be42,
+                                        {"/foo/bar", "/foo/baz", "/foo/bee", "/foo/foobar"}};
+    return schema;
+}
+
+void ncdlgen_fixed_array::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_fixed_array::simple& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    ncdlgen_fixed_array::write(pipe, data.foo_g);
+    record.end();
+}
+
+void ncdlgen_fixed_array::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_fixed_array::simple::foo& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::FixedArrayInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::FixedArrayInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<ncdlgen::FixedArray<uint16_t, 5>, uint16_t, ncdlgen::FixedArrayInterface>({2, "/foo/bee"},
+                                                                                         data.bee);
+    pipe.write<ncdlgen::FixedArray<int, 5, 5>, int, ncdlgen::FixedArrayInterface>({3, "/foo/foobar"},
+                                                                                  data.foobar);
+    record.end();
+}
+
+void ncdlgen_fixed_array::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_fixed_array::simple& simple)
+{
+    ncdlgen_fixed_array::read(pipe, simple.foo_g);
+}
+
+void ncdlgen_fixed_array::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_fixed_array::simple::foo& foo)
+{
+    pipe.read_into<int, int, ncdlgen::FixedArrayInterface>({0, "/foo/bar"}, foo.bar);
+    pipe.read_into<float, float, ncdlgen::FixedArrayInterface>({1, "/foo/baz"}, foo.baz);
+    pipe.read_into<ncdlgen::FixedArray<uint16_t, 5>, uint16_t, ncdlgen::FixedArrayInterface>({2, "/foo/bee"},
+                                                                                             foo.bee);
+    pipe.read_into<ncdlgen::FixedArray<int, 5, 5>, int, ncdlgen::FixedArrayInterface>({3, "/foo/foobar"},
+                                                                                      foo.foobar);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "stdint.h"
+
+#include "pipes/shared_memory_pipe.h"
+
+#include <vector>
+
+#include "fixed_array_interface.h"
+
+namespace ncdlgen_fixed_array
+{
+
+struct simple
+{
+    struct foo
+    {
+        int bar;
+        float baz;
+        ncdlgen::FixedArray<uint16_t, 5> bee;
+        ncdlgen::FixedArray<int, 5, 5> foobar;
+    };
+
+    foo foo_g{};
+};
+
+const ncdlgen::Schema& simple_schema();
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple&);
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple::foo&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple::foo&);
+
+}; // namespace ncdlgen_fixed_array
@@ -0,0 +1,39 @@
+#include "generated_nd_array.h"
+
+const ncdlgen::Schema& ncdlgen_nd_array::simple_schema()
+{
+    static const ncdlgen::Schema schema{0xe2066c7e9561be42,
+                                        {"/foo/bar", "/foo/baz", "/foo/bee", "/foo/foobar"}};
+    return schema;
+}
+
+void ncdlgen_nd_array::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_nd_array::simple& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    ncdlgen_nd_array::write(pipe, data.foo_g);
+    record.end();
+}
+
+void ncdlgen_nd_array::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_nd_array::simple::foo& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::NDArrayInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::NDArrayInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<ncdlgen::NDArray<uint16_t, 1>, uint16_t, ncdlgen::NDArrayInterface>({2, "/foo/bee"}, data.bee);
+    pipe.write<ncdlgen::NDArray<int, 2>, int, ncdlgen::NDArrayInterface>({3, "/foo/foobar"}, data.foobar);
+    record.end();
+}
+
+void ncdlgen_nd_array::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_nd_array::simple& simple)
+{
+    ncdlgen_nd_array::read(pipe, simple.foo_g);
+}
+
+void ncdlgen_nd_array::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_nd_array::simple::foo& foo)
+{
+    pipe.read_into<int, int, ncdlgen::NDArrayInterface>({0, "/foo/bar"}, foo.bar);
+    pipe.read_into<float, float, ncdlgen::NDArrayInterface>({1, "/foo/baz"}, foo.baz);
+    pipe.read_into<ncdlgen::NDArray<uint16_t, 1>, uint16_t, ncdlgen::NDArrayInterface>({2, "/foo/bee"},
+                                                                                       foo.bee);
+    pipe.read_into<ncdlgen::NDArray<int, 2>, int, ncdlgen::NDArrayInterface>({3, "/foo/foobar"}, foo.foobar);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "stdint.h"
+
+#include "pipes/shared_memory_pipe.h"
+
+#include <vector>
+
+#include "nd_array_interface.h"
+
+namespace ncdlgen_nd_array
+{
+
+struct simple
+{
+    struct foo
+    {
+        int bar;
+        float baz;
+        ncdlgen::NDArray<uint16_t, 1> bee;
+        ncdlgen::NDArray<int, 2> foobar;
+    };
+
+    foo foo_g{};
+};
+
+const ncdlgen::Schema& simple_schema();
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple&);
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple::foo&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple::foo&);
+
+}; // namespace ncdlgen_nd_array
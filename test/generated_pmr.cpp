@@ -0,0 +1,40 @@
+#include "generated_pmr.h"
+
+const ncdlgen::Schema& ncdlgen_pmr::simple_schema()
+{
+    static const ncdlgen::Schema schema{0xe2066c7e9561be42,
+                                        {"/foo/bar", "/foo/baz", "/foo/bee", "/foo/foobar"}};
+    return schema;
+}
+
+void ncdlgen_pmr::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_pmr::simple& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    ncdlgen_pmr::write(pipe, data.foo_g);
+    record.end();
+}
+
+void ncdlgen_pmr::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_pmr::simple::foo& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<std::pmr::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, data.bee);
+    pipe.write<std::pmr::vector<std::pmr::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"},
+                                                                                       data.foobar);
+    record.end();
+}
+
+void ncdlgen_pmr::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_pmr::simple& simple)
+{
+    ncdlgen_pmr::read(pipe, simple.foo_g);
+}
+
+void ncdlgen_pmr::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_pmr::simple::foo& foo)
+{
+    pipe.read_into<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, foo.bar);
+    pipe.read_into<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, foo.baz);
+    pipe.read_into<std::pmr::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, foo.bee);
+    pipe.read_into<std::pmr::vector<std::pmr::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"},
+                                                                                           foo.foobar);
+}
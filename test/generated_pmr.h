@@ -0,0 +1,44 @@
+#pragma once
+
+#include "stdint.h"
+
+#include "pipes/shared_memory_pipe.h"
+
+#include <memory_resource>
+#include <vector>
+
+#include "vector_interface.h"
+
+namespace ncdlgen_pmr
+{
+
+struct simple
+{
+    struct foo
+    {
+        int bar;
+        float baz;
+        std::pmr::vector<uint16_t> bee;
+        std::pmr::vector<std::pmr::vector<int>> foobar;
+
+        foo() = default;
+        explicit foo(std::pmr::memory_resource* resource) : bee(resource), foobar(resource) {}
+    };
+
+    foo foo_g{};
+
+    simple() = default;
+    explicit simple(std::pmr::memory_resource* resource) : foo_g(resource) {}
+};
+
+const ncdlgen::Schema& simple_schema();
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple&);
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple::foo&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple::foo&);
+
+}; // namespace ncdlgen_pmr
@@ -1,47 +1,94 @@
 #include "generated_simple.h"
 
+const ncdlgen::Schema& ncdlgen::simple_schema()
+{
+    static const ncdlgen::Schema schema{0xe2066c7e9561be42,
+                                        {"/foo/bar", "/foo/baz", "/foo/bee", "/foo/foobar"}};
+    return schema;
+}
+
 void ncdlgen::write(ncdlgen::NetCDFPipe& pipe, const ncdlgen::simple& data)
 {
+    ncdlgen::RecordScope record{pipe};
     ncdlgen::write(pipe, data.foo_g);
+    record.end();
 }
 
 void ncdlgen::write(ncdlgen::ZeroMQPipe& pipe, const ncdlgen::simple& data)
 {
+    ncdlgen::RecordScope record{pipe};
     ncdlgen::write(pipe, data.foo_g);
+    record.end();
+}
+
+void ncdlgen::write(ncdlgen::InProcessPipe<ncdlgen::simple>& pipe, const ncdlgen::simple& data)
+{
+    pipe.write(data);
+}
+
+void ncdlgen::write(ncdlgen::InProcessPipe<ncdlgen::simple>& pipe, ncdlgen::simple&& data)
+{
+    pipe.write(std::move(data));
 }
 
 void ncdlgen::write(ncdlgen::NetCDFPipe& pipe, const ncdlgen::simple::foo& data)
 {
-    pipe.write<int, int, ncdlgen::VectorInterface>("/foo/bar", data.bar);
-    pipe.write<float, float, ncdlgen::VectorInterface>("/foo/baz", data.baz);
-    pipe.write<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>("/foo/bee", data.bee);
-    pipe.write<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>("/foo/foobar", data.foobar);
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, data.bee);
+    pipe.write<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"}, data.foobar);
+    record.end();
 }
 
 void ncdlgen::write(ncdlgen::ZeroMQPipe& pipe, const ncdlgen::simple::foo& data)
 {
-    pipe.write<int, int, ncdlgen::VectorInterface>("/foo/bar", data.bar);
-    pipe.write<float, float, ncdlgen::VectorInterface>("/foo/baz", data.baz);
-    pipe.write<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>("/foo/bee", data.bee);
-    pipe.write<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>("/foo/foobar", data.foobar);
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, data.bee);
+    pipe.write<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"}, data.foobar);
+    record.end();
+}
+
+void ncdlgen::write(ncdlgen::InProcessPipe<ncdlgen::simple::foo>& pipe, const ncdlgen::simple::foo& data)
+{
+    pipe.write(data);
+}
+
+void ncdlgen::write(ncdlgen::InProcessPipe<ncdlgen::simple::foo>& pipe, ncdlgen::simple::foo&& data)
+{
+    pipe.write(std::move(data));
 }
 
 void ncdlgen::read(ncdlgen::NetCDFPipe& pipe, ncdlgen::simple& simple) { ncdlgen::read(pipe, simple.foo_g); }
 
 void ncdlgen::read(ncdlgen::ZeroMQPipe& pipe, ncdlgen::simple& simple) { ncdlgen::read(pipe, simple.foo_g); }
 
+void ncdlgen::read(ncdlgen::InProcessPipe<ncdlgen::simple>& pipe, ncdlgen::simple& simple)
+{
+    pipe.read(simple);
+}
+
 void ncdlgen::read(ncdlgen::NetCDFPipe& pipe, ncdlgen::simple::foo& foo)
 {
-    foo.bar = pipe.read<int, int, ncdlgen::VectorInterface>("/foo/bar");
-    foo.baz = pipe.read<float, float, ncdlgen::VectorInterface>("/foo/baz");
-    foo.bee = pipe.read<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>("/foo/bee");
-    foo.foobar = pipe.read<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>("/foo/foobar");
+    pipe.read_into<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, foo.bar);
+    pipe.read_into<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, foo.baz);
+    pipe.read_into<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, foo.bee);
+    pipe.read_into<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"},
+                                                                                 foo.foobar);
 }
 
 void ncdlgen::read(ncdlgen::ZeroMQPipe& pipe, ncdlgen::simple::foo& foo)
 {
-    foo.bar = pipe.read<int, int, ncdlgen::VectorInterface>("/foo/bar");
-    foo.baz = pipe.read<float, float, ncdlgen::VectorInterface>("/foo/baz");
-    foo.bee = pipe.read<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>("/foo/bee");
-    foo.foobar = pipe.read<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>("/foo/foobar");
+    pipe.read_into<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, foo.bar);
+    pipe.read_into<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, foo.baz);
+    pipe.read_into<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, foo.bee);
+    pipe.read_into<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"},
+                                                                                 foo.foobar);
+}
+
+void ncdlgen::read(ncdlgen::InProcessPipe<ncdlgen::simple::foo>& pipe, ncdlgen::simple::foo& foo)
+{
+    pipe.read(foo);
 }
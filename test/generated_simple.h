@@ -2,6 +2,8 @@
 
 #include "stdint.h"
 
+#include "pipes/in_process_pipe.h"
+#include "pipes/lazy_field.h"
 #include "pipes/netcdf_pipe.h"
 #include "pipes/zeromq_pipe.h"
 
@@ -25,20 +27,67 @@ struct simple
     foo foo_g{};
 };
 
+struct lazy_simple
+{
+    struct foo
+    {
+        explicit foo(ncdlgen::NetCDFPipe& pipe)
+            : bar(pipe, {0, "/foo/bar"}), baz(pipe, {1, "/foo/baz"}), bee(pipe, {2, "/foo/bee"}),
+              foobar(pipe, {3, "/foo/foobar"})
+        {
+        }
+
+        void release()
+        {
+            bar.release();
+            baz.release();
+            bee.release();
+            foobar.release();
+        }
+
+        ncdlgen::LazyField<int, int, ncdlgen::VectorInterface, ncdlgen::NetCDFPipe> bar;
+        ncdlgen::LazyField<float, float, ncdlgen::VectorInterface, ncdlgen::NetCDFPipe> baz;
+        ncdlgen::LazyField<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface, ncdlgen::NetCDFPipe>
+            bee;
+        ncdlgen::LazyField<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface, ncdlgen::NetCDFPipe>
+            foobar;
+    };
+
+    explicit lazy_simple(ncdlgen::NetCDFPipe& pipe) : foo_g(pipe) {}
+
+    void release() { foo_g.release(); }
+
+    foo foo_g;
+};
+
+const ncdlgen::Schema& simple_schema();
+
 void read(ncdlgen::NetCDFPipe& pipe, simple&);
 
 void read(ncdlgen::ZeroMQPipe& pipe, simple&);
 
+void read(ncdlgen::InProcessPipe<simple>& pipe, simple&);
+
 void read(ncdlgen::NetCDFPipe& pipe, simple::foo&);
 
 void read(ncdlgen::ZeroMQPipe& pipe, simple::foo&);
 
+void read(ncdlgen::InProcessPipe<simple::foo>& pipe, simple::foo&);
+
 void write(ncdlgen::NetCDFPipe& pipe, const simple&);
 
 void write(ncdlgen::ZeroMQPipe& pipe, const simple&);
 
+void write(ncdlgen::InProcessPipe<simple>& pipe, const simple&);
+
+void write(ncdlgen::InProcessPipe<simple>& pipe, simple&&);
+
 void write(ncdlgen::NetCDFPipe& pipe, const simple::foo&);
 
 void write(ncdlgen::ZeroMQPipe& pipe, const simple::foo&);
 
+void write(ncdlgen::InProcessPipe<simple::foo>& pipe, const simple::foo&);
+
+void write(ncdlgen::InProcessPipe<simple::foo>& pipe, simple::foo&&);
+
 }; // namespace ncdlgen
@@ -0,0 +1,57 @@
+#include "generated_view.h"
+
+const ncdlgen::Schema& ncdlgen_view::simple_schema()
+{
+    static const ncdlgen::Schema schema{0xe2066c7e9561be42,
+                                        {"/foo/bar", "/foo/baz", "/foo/bee", "/foo/foobar"}};
+    return schema;
+}
+
+void ncdlgen_view::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_view::simple& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    ncdlgen_view::write(pipe, data.foo_g);
+    record.end();
+}
+
+void ncdlgen_view::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_view::simple::foo& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, data.bee);
+    pipe.write<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"}, data.foobar);
+    record.end();
+}
+
+void ncdlgen_view::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_view::view_simple& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    ncdlgen_view::write(pipe, data.foo_g);
+    record.end();
+}
+
+void ncdlgen_view::write(ncdlgen::SharedMemoryPipe& pipe, const ncdlgen_view::view_simple::foo& data)
+{
+    ncdlgen::RecordScope record{pipe};
+    pipe.write<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<ncdlgen::ArraySpan<uint16_t, 1>, uint16_t, ncdlgen::ArraySpanInterface>({2, "/foo/bee"},
+                                                                                       data.bee);
+    pipe.write<ncdlgen::ArraySpan<int, 2>, int, ncdlgen::ArraySpanInterface>({3, "/foo/foobar"}, data.foobar);
+    record.end();
+}
+
+void ncdlgen_view::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_view::simple& simple)
+{
+    ncdlgen_view::read(pipe, simple.foo_g);
+}
+
+void ncdlgen_view::read(ncdlgen::SharedMemoryPipe& pipe, ncdlgen_view::simple::foo& foo)
+{
+    pipe.read_into<int, int, ncdlgen::VectorInterface>({0, "/foo/bar"}, foo.bar);
+    pipe.read_into<float, float, ncdlgen::VectorInterface>({1, "/foo/baz"}, foo.baz);
+    pipe.read_into<std::vector<uint16_t>, uint16_t, ncdlgen::VectorInterface>({2, "/foo/bee"}, foo.bee);
+    pipe.read_into<std::vector<std::vector<int>>, int, ncdlgen::VectorInterface>({3, "/foo/foobar"},
+                                                                                 foo.foobar);
+}
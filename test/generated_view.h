@@ -0,0 +1,55 @@
+#pragma once
+
+#include "stdint.h"
+
+#include "pipes/shared_memory_pipe.h"
+
+#include <vector>
+
+#include "array_span_interface.h"
+#include "vector_interface.h"
+
+namespace ncdlgen_view
+{
+
+struct simple
+{
+    struct foo
+    {
+        int bar;
+        float baz;
+        std::vector<uint16_t> bee;
+        std::vector<std::vector<int>> foobar;
+    };
+
+    foo foo_g{};
+};
+
+const ncdlgen::Schema& simple_schema();
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple&);
+
+void read(ncdlgen::SharedMemoryPipe& pipe, simple::foo&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const simple::foo&);
+
+struct view_simple
+{
+    struct foo
+    {
+        int bar{};
+        float baz{};
+        ncdlgen::ArraySpan<uint16_t, 1> bee{};
+        ncdlgen::ArraySpan<int, 2> foobar{};
+    };
+
+    foo foo_g{};
+};
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const view_simple&);
+
+void write(ncdlgen::SharedMemoryPipe& pipe, const view_simple::foo&);
+
+}; // namespace ncdlgen_view
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include "array_span_interface.h"
+#include "pipes/pipe_data.h"
+
+using namespace ncdlgen;
+
+TEST(array_span_interface, view)
+{
+    std::vector<int> buffer{0, 1, 2, 3, 4, 5};
+
+    ArraySpan<int, 2> span{buffer.data(), {2, 3}};
+    EXPECT_EQ(span.data(), buffer.data());
+    EXPECT_EQ(span.size(), 6);
+    EXPECT_EQ(span.extent(0), 2);
+    EXPECT_EQ(span.extent(1), 3);
+    EXPECT_EQ(span.dimension_sizes(), (std::vector<std::size_t>{2, 3}));
+    EXPECT_EQ(std::vector<int>(span.begin(), span.end()), buffer);
+
+    ArraySpan<int, 1> line{buffer.data() + 2, 3};
+    EXPECT_EQ(line.shape(), (std::array<std::size_t, 1>{3}));
+    EXPECT_EQ(*line.begin(), 2);
+
+    ArraySpan<int, 2> container_span{buffer, {3, 2}};
+    EXPECT_EQ(container_span.data(), buffer.data());
+    EXPECT_THROW((ArraySpan<int, 2>{buffer, {4, 2}}), std::runtime_error);
+
+    ArraySpan<int, 2> empty{};
+    EXPECT_TRUE(empty.empty());
+}
+
+TEST(array_span_interface, interface)
+{
+    using Span = ArraySpan<double, 2>;
+    static_assert(ArraySpanInterface::is_supported_ndarray<double, Span>());
+    static_assert(InterfaceTraits::is_contiguous_v<ArraySpanInterface, double, Span>);
+    static_assert(InterfaceTraits::has_dimension_sizes_v<ArraySpanInterface, double, Span>);
+    static_assert(!InterfaceTraits::has_prepare_from_container_v<ArraySpanInterface, double, Span>);
+    static_assert(!InterfaceTraits::has_copy_from_v<ArraySpanInterface, double, Span>);
+
+    // The caller-owned memory, e.g. a frame of a camera
+    const double frame[2][3] = {{1, 2, 3}, {4, 5, 6}};
+    Span span{&frame[0][0], {2, 3}};
+
+    auto dimension_sizes = container_dimension_sizes<Span, double, ArraySpanInterface>(span);
+    EXPECT_EQ(dimension_sizes, (std::vector<std::size_t>{2, 3}));
+
+    std::vector<double> buffer(data_size<Span, double>(dimension_sizes) / sizeof(double));
+    copy_data<Span, double, ArraySpanInterface>(span, dimension_sizes, buffer.data());
+    EXPECT_EQ(buffer, (std::vector<double>{1, 2, 3, 4, 5, 6}));
+}
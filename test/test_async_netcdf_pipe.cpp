@@ -0,0 +1,167 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "array_span_interface.h"
+#include "parser.h"
+#include "pipes/async_netcdf_pipe.h"
+#include "tokeniser.h"
+#include "vector_interface.h"
+
+using namespace ncdlgen;
+
+static RootGroup parse_cdl(std::string cdl)
+{
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    auto root = parser.parse();
+    if (!root)
+    {
+        throw std::runtime_error("Parsing the cdl failed.");
+    }
+    return std::move(*root);
+}
+
+static const char* record_cdl = "netcdf records {\n"
+                                "dimensions:\n"
+                                "    time = unlimited, x = 2;\n"
+                                "variables:\n"
+                                "    double time(time);\n"
+                                "    float position(time, x);\n"
+                                "    int count;\n"
+                                "}";
+
+TEST(pipe, async_netcdf_records)
+{
+    auto root = parse_cdl(record_cdl);
+
+    AsyncNetCDFPipe pipe{"async_records.nc", {.netcdf = {.write_mode = NetCDFWriteMode::Append}}};
+    pipe.create_from_schema(root);
+
+    constexpr int record_count = 100;
+    for (int i = 0; i < record_count; i++)
+    {
+        pipe.begin_record();
+        pipe.write<std::vector<double>, double, VectorInterface>("/time", {i * 0.5});
+        pipe.write<std::vector<std::vector<float>>, float, VectorInterface>(
+            "/position", {{static_cast<float>(i), static_cast<float>(-i)}});
+        pipe.write<int, int, VectorInterface>("/count", i);
+        pipe.end_record();
+    }
+    pipe.flush();
+
+    // The combined writes are written as the records one by one
+    auto time = pipe.read<std::vector<double>, double, VectorInterface>("/time");
+    auto position = pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/position");
+    ASSERT_EQ(time.size(), record_count);
+    ASSERT_EQ(position.size(), record_count);
+    for (int i = 0; i < record_count; i++)
+    {
+        EXPECT_EQ(time[i], i * 0.5);
+        EXPECT_EQ(position[i], (std::vector<float>{static_cast<float>(i), static_cast<float>(-i)}));
+    }
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/count")), record_count - 1);
+
+    auto statistics = pipe.statistics();
+    EXPECT_EQ(statistics.written_operations + statistics.coalesced_writes, 3 * record_count);
+    EXPECT_EQ(pipe.call([](NetCDFPipe& netcdf) { return netcdf.next_record("/time"); }), record_count);
+
+    pipe.close();
+}
+
+TEST(pipe, async_netcdf_moved_write)
+{
+    auto root = parse_cdl(record_cdl);
+
+    AsyncNetCDFPipe pipe{"async_moved.nc", {.queue_depth = 4}};
+    pipe.create_from_schema(root);
+
+    // Queue more writes than fit the queue, the writes wait for space
+    using Records = std::vector<std::vector<float>>;
+    for (int i = 0; i < 16; i++)
+    {
+        Records position{{1.0f, 2.0f}};
+        pipe.append<Records, float, VectorInterface>("/position", std::move(position));
+    }
+    pipe.sync();
+
+    EXPECT_EQ((pipe.read<Records, float, VectorInterface>("/position")).size(), 16);
+    pipe.close();
+}
+
+TEST(pipe, async_netcdf_array_span)
+{
+    auto root = parse_cdl(record_cdl);
+
+    AsyncNetCDFPipe pipe{"async_array_span.nc"};
+    pipe.create_from_schema(root);
+
+    // The viewed elements are copied to the queue, the buffer is reused before the writes
+    std::vector<float> buffer{1.0f, 2.0f};
+    for (int i = 0; i < 4; i++)
+    {
+        buffer[0] = static_cast<float>(i);
+        pipe.append<ArraySpan<float, 2>, float, ArraySpanInterface>("/position",
+                                                                    ArraySpan<float, 2>{buffer, {1, 2}});
+    }
+    pipe.sync();
+
+    using Records = std::vector<std::vector<float>>;
+    auto position = pipe.read<Records, float, VectorInterface>("/position");
+    ASSERT_EQ(position.size(), 4);
+    EXPECT_EQ(position[3], (std::vector<float>{3.0f, 2.0f}));
+    EXPECT_EQ(position[0], (std::vector<float>{0.0f, 2.0f}));
+    pipe.close();
+}
+
+TEST(pipe, async_netcdf_append_after_failed_write)
+{
+    auto root = parse_cdl(record_cdl);
+
+    AsyncNetCDFPipe pipe{"async_failed_append.nc", {.netcdf = {.write_mode = NetCDFWriteMode::Append}}};
+    pipe.create_from_schema(root);
+
+    // The position does not match the dimension x, the write fails on the writer thread
+    pipe.begin_record();
+    pipe.write<std::vector<double>, double, VectorInterface>("/time", {0.0});
+    pipe.write<std::vector<std::vector<float>>, float, VectorInterface>("/position", {{1.0f, 2.0f, 3.0f}});
+    pipe.end_record();
+    EXPECT_THROW(pipe.flush(), std::runtime_error);
+
+    // The following records are appended after the failed one, not over each other
+    for (int i = 1; i < 4; i++)
+    {
+        pipe.begin_record();
+        pipe.write<std::vector<double>, double, VectorInterface>("/time", {i * 1.0});
+        pipe.write<std::vector<std::vector<float>>, float, VectorInterface>(
+            "/position", {{static_cast<float>(i), static_cast<float>(-i)}});
+        pipe.end_record();
+    }
+    pipe.flush();
+
+    EXPECT_EQ((pipe.read<std::vector<double>, double, VectorInterface>("/time")),
+              (std::vector<double>{0.0, 1.0, 2.0, 3.0}));
+    auto position = pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/position");
+    ASSERT_EQ(position.size(), 4);
+    EXPECT_EQ(position[3], (std::vector<float>{3.0f, -3.0f}));
+    pipe.close();
+}
+
+TEST(pipe, async_netcdf_error)
+{
+    auto root = parse_cdl(record_cdl);
+
+    AsyncNetCDFPipe pipe{"async_error.nc"};
+    pipe.create_from_schema(root);
+
+    // The failed write is reported by the next call, and the pipe is usable after it
+    pipe.write<double, double, VectorInterface>("/count", 1.0);
+    EXPECT_THROW(pipe.flush(), std::runtime_error);
+
+    pipe.write<int, int, VectorInterface>("/count", 2);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/count")), 2);
+    pipe.close();
+}
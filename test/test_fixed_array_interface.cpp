@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "fixed_array_interface.h"
+#include "pipes/pipe_data.h"
+
+using namespace ncdlgen;
+
+TEST(fixed_array_interface, indexing)
+{
+    FixedArray<int, 2, 3, 4> array{};
+    for (std::size_t i = 0; i < array.size(); i++)
+    {
+        array.data()[i] = static_cast<int>(i);
+    }
+
+    static_assert(FixedArray<int, 2, 3, 4>::size() == 2 * 3 * 4);
+    static_assert(std::is_trivially_copyable_v<FixedArray<int, 2, 3, 4>>);
+    EXPECT_EQ(array.shape, (std::array<std::size_t, 3>{2, 3, 4}));
+    EXPECT_EQ(array(1, 2, 3), 23);
+    EXPECT_EQ(array(0, 1, 0), 4);
+    EXPECT_EQ(array.dimension_sizes(), (std::vector<std::size_t>{2, 3, 4}));
+
+    // Aggregate initialisation in row-major order
+    FixedArray<int, 2, 2> square{{1, 2, 3, 4}};
+    EXPECT_EQ(square(1, 0), 3);
+}
+
+TEST(fixed_array_interface, interface)
+{
+    using Array = FixedArray<double, 2, 3>;
+    static_assert(FixedArrayInterface::is_supported_ndarray<double, Array>());
+    static_assert(InterfaceTraits::is_contiguous_v<FixedArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_dimension_sizes_v<FixedArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_copy_from_v<FixedArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_reshape_v<FixedArrayInterface, double, Array>);
+    static_assert(!InterfaceTraits::has_prepare_from_container_v<FixedArrayInterface, double, Array>);
+
+    Array array{{1, 2, 3, 4, 5, 6}};
+
+    auto dimension_sizes = container_dimension_sizes<Array, double, FixedArrayInterface>(array);
+    EXPECT_EQ(dimension_sizes, (std::vector<std::size_t>{2, 3}));
+
+    std::vector<double> buffer(data_size<Array, double>(dimension_sizes) / sizeof(double));
+    copy_data<Array, double, FixedArrayInterface>(array, dimension_sizes, buffer.data());
+    EXPECT_EQ(buffer, (std::vector<double>{1, 2, 3, 4, 5, 6}));
+
+    Array read_array{};
+    data_from_buffer<Array, double, FixedArrayInterface>(read_array, buffer.data(),
+                                                         buffer.size() * sizeof(double), dimension_sizes);
+    EXPECT_EQ(read_array, array);
+
+    std::size_t rows{};
+    FixedArrayInterface::for_each_row<double>(array,
+                                              [&](const double* row, std::size_t size)
+                                              {
+                                                  EXPECT_EQ(size, 3);
+                                                  EXPECT_EQ(row[0], static_cast<double>(rows * 3 + 1));
+                                                  rows++;
+                                              });
+    EXPECT_EQ(rows, 2);
+
+    // The array cannot be resized to another shape
+    EXPECT_THROW((FixedArrayInterface::reshape<double, Array>(read_array, {3, 2})), std::runtime_error);
+    EXPECT_THROW((FixedArrayInterface::reshape<double, Array>(read_array, {6})), std::runtime_error);
+    EXPECT_THROW((data_from_buffer<Array, double, FixedArrayInterface>(
+                     read_array, buffer.data(), buffer.size() * sizeof(double), {3, 2})),
+                 std::runtime_error);
+}
+
+TEST(fixed_array_interface, vectors)
+{
+    // The variables with unlimited dimensions keep the nested vectors
+    using Vector = std::vector<std::vector<float>>;
+    static_assert(FixedArrayInterface::is_supported_ndarray<float, Vector>());
+    static_assert(!InterfaceTraits::is_contiguous_v<FixedArrayInterface, float, Vector>);
+    static_assert(InterfaceTraits::is_contiguous_v<FixedArrayInterface, float, std::vector<float>>);
+    static_assert(InterfaceTraits::has_prepare_from_container_v<FixedArrayInterface, float, Vector>);
+
+    Vector data{{1, 2}, {3, 4}, {5, 6}};
+    auto dimension_sizes = container_dimension_sizes<Vector, float, FixedArrayInterface>(data);
+    EXPECT_EQ(dimension_sizes, (std::vector<std::size_t>{3, 2}));
+
+    std::vector<float> buffer(6);
+    copy_data<Vector, float, FixedArrayInterface>(data, dimension_sizes, buffer.data());
+    EXPECT_EQ(buffer, (std::vector<float>{1, 2, 3, 4, 5, 6}));
+
+    Vector read_data{};
+    data_from_buffer<Vector, float, FixedArrayInterface>(read_data, buffer.data(),
+                                                         buffer.size() * sizeof(float), dimension_sizes);
+    EXPECT_EQ(read_data, data);
+
+    EXPECT_THROW((container_dimension_sizes<Vector, float, FixedArrayInterface>(Vector{{1, 2}, {3}})),
+                 std::runtime_error);
+}
@@ -0,0 +1,99 @@
+#include <memory_resource>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "generated_fixed_array.h"
+#include "generated_nd_array.h"
+#include "generated_pmr.h"
+#include "generated_view.h"
+
+// The interfaces generated from simple.cdl with the customisations of the
+// generator, written and read back through the serialising SharedMemoryPipe
+
+TEST(generated_interfaces, nd_array)
+{
+    ncdlgen::SharedMemoryPipe pipe{{.name = "/ncdlgen_test_generated_nd_array"}};
+
+    std::vector<int> foobar(25);
+    std::iota(foobar.begin(), foobar.end(), 0);
+    ncdlgen_nd_array::simple data{};
+    data.foo_g = {.bar = 5,
+                  .baz = 32,
+                  .bee = {{5}, {1, 2, 3, 4, 5}},
+                  .foobar = {{5, 5}, foobar}};
+    ncdlgen_nd_array::write(pipe, data);
+
+    ncdlgen_nd_array::simple read_data{};
+    ncdlgen_nd_array::read(pipe, read_data);
+    EXPECT_EQ(read_data.foo_g.bar, data.foo_g.bar);
+    EXPECT_EQ(read_data.foo_g.baz, data.foo_g.baz);
+    EXPECT_EQ(read_data.foo_g.bee, data.foo_g.bee);
+    EXPECT_EQ(read_data.foo_g.foobar, data.foo_g.foobar);
+    EXPECT_EQ(read_data.foo_g.foobar(2, 3), 13);
+}
+
+TEST(generated_interfaces, fixed_array)
+{
+    ncdlgen::SharedMemoryPipe pipe{{.name = "/ncdlgen_test_generated_fixed_array"}};
+
+    ncdlgen_fixed_array::simple data{};
+    data.foo_g.bar = 5;
+    data.foo_g.baz = 32;
+    data.foo_g.bee = {{1, 2, 3, 4, 5}};
+    std::iota(data.foo_g.foobar.begin(), data.foo_g.foobar.end(), 0);
+    ncdlgen_fixed_array::write(pipe, data);
+
+    ncdlgen_fixed_array::simple read_data{};
+    ncdlgen_fixed_array::read(pipe, read_data);
+    EXPECT_EQ(read_data.foo_g.bar, data.foo_g.bar);
+    EXPECT_EQ(read_data.foo_g.baz, data.foo_g.baz);
+    EXPECT_EQ(read_data.foo_g.bee, data.foo_g.bee);
+    EXPECT_EQ(read_data.foo_g.foobar, data.foo_g.foobar);
+}
+
+TEST(generated_interfaces, memory_resource)
+{
+    ncdlgen::SharedMemoryPipe pipe{{.name = "/ncdlgen_test_generated_pmr"}};
+
+    ncdlgen_pmr::simple data{};
+    data.foo_g.bar = 5;
+    data.foo_g.baz = 32;
+    data.foo_g.bee = {1, 2, 3, 4, 5};
+    data.foo_g.foobar.assign(5, std::pmr::vector<int>{1, 2, 3, 4, 5});
+    ncdlgen_pmr::write(pipe, data);
+
+    // The arrays read are allocated from the resource of the struct
+    std::pmr::monotonic_buffer_resource resource{};
+    ncdlgen_pmr::simple read_data{&resource};
+    ncdlgen_pmr::read(pipe, read_data);
+    EXPECT_EQ(read_data.foo_g.bar, data.foo_g.bar);
+    EXPECT_EQ(read_data.foo_g.baz, data.foo_g.baz);
+    EXPECT_EQ(read_data.foo_g.bee, data.foo_g.bee);
+    EXPECT_EQ(read_data.foo_g.foobar, data.foo_g.foobar);
+    EXPECT_EQ(read_data.foo_g.bee.get_allocator().resource(), &resource);
+    EXPECT_EQ(read_data.foo_g.foobar[4].get_allocator().resource(), &resource);
+}
+
+TEST(generated_interfaces, view)
+{
+    ncdlgen::SharedMemoryPipe pipe{{.name = "/ncdlgen_test_generated_view"}};
+
+    // The buffers of the caller are written through the spans
+    std::vector<uint16_t> bee{1, 2, 3, 4, 5};
+    std::vector<int> foobar(25);
+    std::iota(foobar.begin(), foobar.end(), 0);
+    ncdlgen_view::view_simple view{};
+    view.foo_g = {.bar = 5, .baz = 32, .bee = {bee, {5}}, .foobar = {foobar, {5, 5}}};
+    ncdlgen_view::write(pipe, view);
+
+    // And read to the owning struct
+    ncdlgen_view::simple read_data{};
+    ncdlgen_view::read(pipe, read_data);
+    EXPECT_EQ(read_data.foo_g.bar, 5);
+    EXPECT_EQ(read_data.foo_g.baz, 32);
+    EXPECT_EQ(read_data.foo_g.bee, bee);
+    ASSERT_EQ(read_data.foo_g.foobar.size(), 5);
+    EXPECT_EQ(read_data.foo_g.foobar[2], (std::vector<int>{10, 11, 12, 13, 14}));
+}
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 
 #include "generated_simple.h"
+#include "generator.h"
 
 using namespace ncdlgen;
 
@@ -15,11 +16,26 @@ static void make_nc_from_cdl(const std::string& cdl, const std::string& netcdf_f
     }
 }
 
+/**
+ * The code generated from the cdl for the header or the source target
+ */
+static std::string generate(const std::string& cdl, ncdlgen::Generator::Options options,
+                            ncdlgen::Generator::GenerateTarget target)
+{
+    options.target = target;
+    ncdlgen::Generator generator{options};
+    testing::internal::CaptureStdout();
+    generator.generate(cdl);
+    return testing::internal::GetCapturedStdout();
+}
+
 TEST(generator, basic)
 {
     // The name of the root group is the name
-    ncdlgen::simple::foo data{
-        .bar = 5, .baz = 32, .bee = {1, 2, 3, 4, 5}, .foobar = {{1, 2, 3, 4, 5}, {1, 2, 3, 4, 5}}};
+    ncdlgen::simple::foo data{.bar = 5,
+                              .baz = 32,
+                              .bee = {1, 2, 3, 4, 5},
+                              .foobar = std::vector<std::vector<int>>(5, {1, 2, 3, 4, 5})};
     ncdlgen::simple root{.foo_g = data};
 
     std::string cdl = {"netcdf simple {\n"
@@ -49,4 +65,279 @@ TEST(generator, basic)
     EXPECT_EQ(read_root.foo_g.bee[2], 3);
     EXPECT_EQ(read_root.foo_g.bee[3], 4);
     EXPECT_EQ(read_root.foo_g.bee[4], 5);
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+}
+
+TEST(generator, in_process_pipe)
+{
+    ncdlgen::InProcessPipe<ncdlgen::simple> pipe{};
+
+    ncdlgen::simple::foo data{.bar = 1, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6}, {7, 8}}};
+    ncdlgen::simple root{.foo_g = data};
+    const auto* storage = root.foo_g.foobar.data();
+
+    ncdlgen::write(pipe, std::move(root));
+
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+
+    EXPECT_EQ(read_root.foo_g.bar, data.bar);
+    EXPECT_EQ(read_root.foo_g.bee, data.bee);
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+    EXPECT_EQ(read_root.foo_g.foobar.data(), storage);
+}
+
+TEST(generator, lazy_struct)
+{
+    ncdlgen::simple::foo data{.bar = 5,
+                              .baz = 32,
+                              .bee = {1, 2, 3, 4, 5},
+                              .foobar = std::vector<std::vector<int>>(5, {1, 2, 3, 4, 5})};
+    ncdlgen::simple root{.foo_g = data};
+
+    std::string cdl = {"netcdf simple {\n"
+                       "  group: foo{\n"
+                       "  dimensions:\n"
+                       "      dim = 5;\n"
+                       "  variables:\n"
+                       "      int bar;\n"
+                       "      float baz;\n"
+                       "      ushort bee(dim);\n"
+                       "      int foobar(dim, dim);}}"};
+    make_nc_from_cdl(cdl, "generated_lazy.nc");
+
+    ncdlgen::NetCDFPipe pipe{"generated_lazy.nc"};
+    pipe.open();
+    ncdlgen::write(pipe, root);
+
+    // Nothing is read until the variable is accessed
+    ncdlgen::lazy_simple lazy_root{pipe};
+    EXPECT_FALSE(lazy_root.foo_g.bee.is_loaded());
+    EXPECT_EQ(*lazy_root.foo_g.bee, data.bee);
+    EXPECT_EQ(lazy_root.foo_g.bee->size(), 5);
+    EXPECT_TRUE(lazy_root.foo_g.bee.is_loaded());
+    EXPECT_FALSE(lazy_root.foo_g.foobar.is_loaded());
+
+    // The released variables are read again on the next access
+    lazy_root.release();
+    EXPECT_FALSE(lazy_root.foo_g.bee.is_loaded());
+    EXPECT_EQ(lazy_root.foo_g.bar.get(), data.bar);
+    EXPECT_EQ(lazy_root.foo_g.foobar.get()[1], data.foobar[1]);
+    pipe.close();
+}
+
+TEST(generator, netcdf_schema)
+{
+    ncdlgen::simple::foo data{.bar = 5, .baz = 32, .bee = {1, 2, 3, 4, 5}, .foobar = {}};
+    ncdlgen::simple root{.foo_g = data};
+
+    // No foobar in the file
+    std::string cdl = {"netcdf simple {\n"
+                       "  group: foo{\n"
+                       "  dimensions:\n"
+                       "      dim = 5;\n"
+                       "  variables:\n"
+                       "      int bar;\n"
+                       "      float baz;\n"
+                       "      ushort bee(dim);}}"};
+    make_nc_from_cdl(cdl, "generated_schema.nc");
+
+    // The variables of the schema are resolved on open, including the failed lookup of foobar
+    ncdlgen::NetCDFPipe pipe{"generated_schema.nc"};
+    pipe.use_schema(ncdlgen::simple_schema());
+    pipe.open();
+    EXPECT_EQ(pipe.cache_statistics().misses, 4);
+
+    // And found by the field id
+    pipe.write<int, int, VectorInterface>({0, "/foo/bar"}, data.bar);
+    pipe.write<float, float, VectorInterface>({1, "/foo/baz"}, data.baz);
+    pipe.write<std::vector<uint16_t>, uint16_t, VectorInterface>({2, "/foo/bee"}, data.bee);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>({0, "/foo/bar"})), data.bar);
+    EXPECT_EQ((pipe.read<std::vector<uint16_t>, uint16_t, VectorInterface>({2, "/foo/bee"})), data.bee);
+    EXPECT_EQ(pipe.cache_statistics().misses, 4);
+    EXPECT_EQ(pipe.cache_statistics().hits, 5);
+
+    // An id of another schema is not used for a different variable, the path of
+    // another string is compared again
+    EXPECT_THROW((pipe.write<float, float, VectorInterface>({0, "/foo/baz"}, data.baz)), std::runtime_error);
+    std::string path{"/foo/bar"};
+    std::string other_path{"/foo/bee"};
+    pipe.write<int, int, VectorInterface>({0, path}, data.bar);
+    EXPECT_THROW((pipe.write<int, int, VectorInterface>({0, other_path}, data.bar)), std::runtime_error);
+
+    // The variable missing from the file is looked up by the path
+    EXPECT_THROW((pipe.read<std::vector<std::vector<int>>, int, VectorInterface>({3, "/foo/foobar"})),
+                 std::runtime_error);
+    pipe.close();
+}
+
+TEST(generator, read_records)
+{
+    std::string cdl = {"netcdf records {\n"
+                       "  dimensions:\n"
+                       "      time = unlimited;\n"
+                       "      x = 2;\n"
+                       "  variables:\n"
+                       "      int count;\n"
+                       "  group: sensor{\n"
+                       "  variables:\n"
+                       "      float temperature(time, x);\n"
+                       "      float offset(x);}}"};
+
+    auto source =
+        generate(cdl, {.generated_namespace = "ncdlgen"}, ncdlgen::Generator::GenerateTarget::Source);
+
+    // The record variables of the sub group are read from the root
+    EXPECT_NE(source.find("void ncdlgen::read_records(ncdlgen::NetCDFPipe& pipe, ncdlgen::records& records, "
+                          "std::size_t start, std::size_t count)"),
+              std::string::npos);
+    EXPECT_NE(source.find("ncdlgen::read_records(pipe, records.sensor_g, start, count);"), std::string::npos);
+    EXPECT_NE(source.find("sensor.temperature = pipe.read_records<std::vector<std::vector<float>>, float, "
+                          "ncdlgen::VectorInterface>({1, \"/sensor/temperature\"}, start, count);"),
+              std::string::npos);
+    EXPECT_EQ(source.find("sensor.offset = pipe.read_records"), std::string::npos);
+}
+
+TEST(generator, nd_array_interface)
+{
+    std::string cdl = {"netcdf grids {\n"
+                       "  dimensions:\n"
+                       "      y = 3;\n"
+                       "      x = 4;\n"
+                       "  variables:\n"
+                       "      int count;\n"
+                       "      float grid(y, x);}"};
+
+    ncdlgen::Generator::Options options{.generated_namespace = "ncdlgen"};
+    options.array_interface = "NDArrayInterface";
+    options.container_for_dimensions = ncdlgen::NDArrayCustomisation::container_for_dimensions;
+
+    auto header = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Header);
+
+    // The arrays are contiguous, the scalars are kept as is
+    EXPECT_NE(header.find("ncdlgen::NDArray<float, 2> grid;"), std::string::npos);
+    EXPECT_NE(header.find("int count;"), std::string::npos);
+
+    auto source = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Source);
+
+    EXPECT_NE(source.find("pipe.write<ncdlgen::NDArray<float, 2>, float, ncdlgen::NDArrayInterface>({1, "
+                          "\"/grid\"}, data.grid);"),
+              std::string::npos);
+}
+
+TEST(generator, fixed_array_interface)
+{
+    std::string cdl = {"netcdf grids {\n"
+                       "  dimensions:\n"
+                       "      time = unlimited;\n"
+                       "      y = 3;\n"
+                       "      x = 4;\n"
+                       "  variables:\n"
+                       "      int count;\n"
+                       "      float grid(y, x);\n"
+                       "      float field(time, x);\n"
+                       "  group: sub {\n"
+                       "    dimensions:\n"
+                       "        x = 2;\n"
+                       "    variables:\n"
+                       "        double row(x);\n"
+                       "        double grid(y, x);}}"};
+
+    ncdlgen::Generator::Options options{.generated_namespace = "ncdlgen"};
+    options.array_interface = "FixedArrayInterface";
+    options.container_for_dimension_lengths =
+        ncdlgen::FixedArrayCustomisation::container_for_dimension_lengths;
+
+    auto header = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Header);
+
+    // The lengths come from the dimensions visible to the group of the variable
+    EXPECT_NE(header.find("ncdlgen::FixedArray<float, 3, 4> grid;"), std::string::npos);
+    EXPECT_NE(header.find("ncdlgen::FixedArray<double, 2> row;"), std::string::npos);
+    EXPECT_NE(header.find("ncdlgen::FixedArray<double, 3, 2> grid;"), std::string::npos);
+    EXPECT_NE(header.find("int count;"), std::string::npos);
+
+    // The variables with an unlimited dimension keep the nested vectors
+    EXPECT_NE(header.find("std::vector<std::vector<float>> field;"), std::string::npos);
+
+    auto source = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Source);
+
+    EXPECT_NE(source.find("pipe.write<ncdlgen::FixedArray<float, 3, 4>, float, "
+                          "ncdlgen::FixedArrayInterface>({1, \"/grid\"}, data.grid);"),
+              std::string::npos);
+}
+
+TEST(generator, memory_resource_constructors)
+{
+    std::string cdl = {"netcdf grids {\n"
+                       "  dimensions:\n"
+                       "      x = 4;\n"
+                       "  variables:\n"
+                       "      int count;\n"
+                       "      float row(x);\n"
+                       "  group: sub {\n"
+                       "    variables:\n"
+                       "        double grid(x, x);}}"};
+
+    ncdlgen::Generator::Options options{.generated_namespace = "ncdlgen"};
+    options.container_for_dimensions = ncdlgen::PmrCustomisation::container_for_dimensions;
+    options.memory_resource_constructors = true;
+
+    auto header = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Header);
+
+    EXPECT_NE(header.find("std::pmr::vector<float> row;"), std::string::npos);
+    EXPECT_NE(header.find("std::pmr::vector<std::pmr::vector<double>> grid;"), std::string::npos);
+
+    // The arrays and the sub groups are constructed with the resource, the scalars are not
+    EXPECT_NE(header.find("grids() = default;"), std::string::npos);
+    EXPECT_NE(header.find("explicit grids(std::pmr::memory_resource* resource) : row(resource), "
+                          "sub_g(resource) {}"),
+              std::string::npos);
+    EXPECT_NE(header.find("explicit sub(std::pmr::memory_resource* resource) : grid(resource) {}"),
+              std::string::npos);
+
+    auto source = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Source);
+
+    // The members are read in place, keeping their resource and capacity
+    EXPECT_NE(source.find("pipe.read_into<std::pmr::vector<float>, float, ncdlgen::VectorInterface>({1, "
+                          "\"/row\"}, grids.row);"),
+              std::string::npos);
+}
+
+TEST(generator, view_structs)
+{
+    std::string cdl = {"netcdf frames {\n"
+                       "  dimensions:\n"
+                       "      y = 2, x = 3;\n"
+                       "  variables:\n"
+                       "      int count;\n"
+                       "  group: camera {\n"
+                       "    variables:\n"
+                       "        short frame(y, x);}}"};
+
+    ncdlgen::Generator::Options options{.generated_namespace = "ncdlgen"};
+    options.serialisation_pipes = {"NetCDFPipe", "InProcessPipe"};
+    options.view_structs = true;
+
+    auto header = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Header);
+
+    // The arrays are spans of the memory of the caller, the scalars are values
+    EXPECT_NE(header.find("struct view_frames"), std::string::npos);
+    EXPECT_NE(header.find("ncdlgen::ArraySpan<int16_t, 2> frame{};"), std::string::npos);
+    EXPECT_NE(header.find("int count{};"), std::string::npos);
+    EXPECT_NE(header.find("void write(ncdlgen::NetCDFPipe& pipe, const view_frames::camera&);"),
+              std::string::npos);
+
+    // The pipes of whole structs have no view writes
+    EXPECT_EQ(header.find("ncdlgen::InProcessPipe<view_frames>"), std::string::npos);
+
+    auto source = generate(cdl, options, ncdlgen::Generator::GenerateTarget::Source);
+
+    EXPECT_NE(source.find("pipe.write<ncdlgen::ArraySpan<int16_t, 2>, int16_t, "
+                          "ncdlgen::ArraySpanInterface>({1, \"/camera/frame\"}, data.frame);"),
+              std::string::npos);
+    EXPECT_NE(source.find("ncdlgen::write(pipe, data.camera_g);"), std::string::npos);
+
+    // A failed write discards the record
+    EXPECT_NE(source.find("ncdlgen::RecordScope record{pipe};"), std::string::npos);
+    EXPECT_NE(source.find("record.end();"), std::string::npos);
 }
@@ -0,0 +1,121 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pipes/in_process_pipe.h"
+
+using namespace ncdlgen;
+
+struct InProcessRecord
+{
+    int index{};
+    std::vector<float> values{};
+};
+
+TEST(pipe, in_process_write_read)
+{
+
+    InProcessPipe<InProcessRecord> pipe{};
+
+    pipe.write(InProcessRecord{.index = 1, .values = {1.0f, 2.0f}});
+
+    auto record = pipe.read();
+
+    EXPECT_EQ(record.index, 1);
+    EXPECT_EQ(record.values, (std::vector<float>{1.0f, 2.0f}));
+}
+
+TEST(pipe, in_process_move_without_copy)
+{
+
+    InProcessPipe<InProcessRecord> pipe{};
+
+    InProcessRecord record{.index = 1, .values = std::vector<float>(1024, 1.0f)};
+    const auto* storage = record.values.data();
+    pipe.write(std::move(record));
+
+    InProcessRecord read_record{};
+    pipe.read(read_record);
+
+    EXPECT_EQ(read_record.values.data(), storage);
+}
+
+TEST(pipe, in_process_recycle_buffers)
+{
+
+    InProcessPipe<InProcessRecord> pipe{{.capacity = 1}};
+
+    InProcessRecord record{.values = std::vector<float>(1024, 1.0f)};
+    InProcessRecord read_record{.values = std::vector<float>(1024, 0.0f)};
+    const auto* read_storage = read_record.values.data();
+
+    pipe.write(std::move(record));
+    pipe.read(read_record);
+
+    // The buffers the reader had are handed back to the writer once the writes
+    // wrap around the ring
+    record.values.assign(1024, 2.0f);
+    pipe.write(std::move(record));
+    pipe.read(read_record);
+    record.values.assign(1024, 3.0f);
+    pipe.write(std::move(record));
+    EXPECT_EQ(record.values.data(), read_storage);
+}
+
+TEST(pipe, in_process_copy)
+{
+
+    InProcessPipe<InProcessRecord> pipe{};
+
+    InProcessRecord record{.index = 3, .values = {1.0f}};
+    pipe.write(record);
+
+    EXPECT_EQ(pipe.read().index, 3);
+    EXPECT_EQ(record.values, std::vector<float>{1.0f});
+}
+
+TEST(pipe, in_process_threads)
+{
+
+    InProcessPipe<InProcessRecord> pipe{{.capacity = 4}};
+
+    constexpr int count{10000};
+    std::thread writer(
+        [&]
+        {
+            InProcessRecord record{};
+            for (int i = 0; i < count; i++)
+            {
+                record.index = i;
+                record.values.assign(i % 17, static_cast<float>(i));
+                pipe.write(std::move(record));
+            }
+        });
+
+    InProcessRecord record{};
+    for (int i = 0; i < count; i++)
+    {
+        pipe.read(record);
+        ASSERT_EQ(record.index, i);
+        ASSERT_EQ(record.values, std::vector<float>(i % 17, static_cast<float>(i)));
+    }
+
+    writer.join();
+}
+
+TEST(pipe, in_process_timeout)
+{
+
+    InProcessPipe<int> pipe{{.capacity = 1, .receive_timeout_ms = 10, .send_timeout_ms = 10}};
+
+    EXPECT_THROW(pipe.read(), std::runtime_error);
+
+    pipe.write(1);
+    EXPECT_THROW(pipe.write(2), std::runtime_error);
+
+    int value{};
+    EXPECT_FALSE(pipe.try_write(3));
+    EXPECT_TRUE(pipe.try_read(value));
+    EXPECT_EQ(value, 1);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "nd_array_interface.h"
+#include "pipes/pipe_data.h"
+
+using namespace ncdlgen;
+
+TEST(nd_array_interface, indexing)
+{
+    NDArray<int, 3> array{{2, 3, 4}};
+    for (std::size_t i = 0; i < array.size(); i++)
+    {
+        array.data()[i] = static_cast<int>(i);
+    }
+
+    EXPECT_EQ(array.size(), 2 * 3 * 4);
+    EXPECT_EQ(array.strides(), (std::array<std::size_t, 3>{12, 4, 1}));
+    EXPECT_EQ(array(1, 2, 3), 23);
+    EXPECT_EQ(array(0, 1, 0), 4);
+
+    // The sub arrays are views to the same buffer
+    auto row = array[1][2];
+    EXPECT_EQ(row.extent(0), 4);
+    EXPECT_EQ(row[3], 23);
+    row[0] = -1;
+    EXPECT_EQ(array(1, 2, 0), -1);
+
+    const auto& const_array = array;
+    EXPECT_EQ(const_array[0](1, 1), 5);
+
+    EXPECT_THROW((NDArray<int, 2>{{2, 2}, {1, 2, 3}}), std::runtime_error);
+}
+
+TEST(nd_array_interface, reshape)
+{
+    NDArray<float, 2> array{{4, 5}, 1.0f};
+    const auto* buffer = array.data();
+
+    // The capacity is reused when the array shrinks
+    array.reshape({2, 5});
+    EXPECT_EQ(array.data(), buffer);
+    EXPECT_EQ(array.dimension_sizes(), (std::vector<std::size_t>{2, 5}));
+    EXPECT_EQ(array.strides(), (std::array<std::size_t, 2>{5, 1}));
+
+    EXPECT_THROW(array.reshape({10}), std::runtime_error);
+}
+
+TEST(nd_array_interface, interface)
+{
+    using Array = NDArray<double, 2>;
+    static_assert(NDArrayInterface::is_supported_ndarray<double, Array>());
+    static_assert(InterfaceTraits::is_contiguous_v<NDArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_dimension_sizes_v<NDArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_copy_from_v<NDArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_for_each_row_v<NDArrayInterface, double, Array>);
+    static_assert(InterfaceTraits::has_reshape_v<NDArrayInterface, double, Array>);
+    static_assert(!InterfaceTraits::has_dimension_sizes_v<VectorInterface, double, std::vector<double>>);
+
+    Array array{{2, 3}, {1, 2, 3, 4, 5, 6}};
+
+    // The shape comes from the array, without walking the elements
+    auto dimension_sizes = container_dimension_sizes<Array, double, NDArrayInterface>(array);
+    EXPECT_EQ(dimension_sizes, (std::vector<std::size_t>{2, 3}));
+
+    std::vector<double> buffer(data_size<Array, double>(dimension_sizes) / sizeof(double));
+    copy_data<Array, double, NDArrayInterface>(array, dimension_sizes, buffer.data());
+    EXPECT_EQ(buffer, (std::vector<double>{1, 2, 3, 4, 5, 6}));
+
+    Array read_array{};
+    data_from_buffer<Array, double, NDArrayInterface>(read_array, buffer.data(), buffer.size() * sizeof(double),
+                                                      dimension_sizes);
+    EXPECT_EQ(read_array, array);
+
+    // The rows are the innermost dimension
+    std::size_t rows{};
+    NDArrayInterface::for_each_row<double>(array,
+                                           [&](const double* row, std::size_t size)
+                                           {
+                                               EXPECT_EQ(size, 3);
+                                               EXPECT_EQ(row[0], static_cast<double>(rows * 3 + 1));
+                                               rows++;
+                                           });
+    EXPECT_EQ(rows, 2);
+
+    // The size of the buffer is checked against the shape
+    EXPECT_THROW((data_from_buffer<Array, double, NDArrayInterface>(read_array, buffer.data(), sizeof(double),
+                                                                    dimension_sizes)),
+                 std::runtime_error);
+
+    // An empty array has no buffer to copy
+    Array empty_array{};
+    auto empty_sizes = container_dimension_sizes<Array, double, NDArrayInterface>(empty_array);
+    copy_data<Array, double, NDArrayInterface>(empty_array, empty_sizes, nullptr);
+    data_from_buffer<Array, double, NDArrayInterface>(read_array, nullptr, 0, empty_sizes);
+    EXPECT_EQ(read_array, empty_array);
+}
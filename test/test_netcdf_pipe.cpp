@@ -1,14 +1,23 @@
 
 #include <array>
+#include <cstdint>
 #include <cstdio>
+#include <filesystem>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <stdexcept>
 
 #include <fmt/core.h>
 #include <gtest/gtest.h>
 
+#include "array_span_interface.h"
+#include "fixed_array_interface.h"
 #include "foo_wrapper.h"
+#include "nd_array_interface.h"
+#include "parser.h"
 #include "pipes/netcdf_pipe.h"
+#include "tokeniser.h"
 #include "vector_interface.h"
 
 using namespace ncdlgen;
@@ -89,6 +98,33 @@ TEST(pipe, netcdf_ndarray)
     ASSERT_EQ(read_data[2][1], 2);
 }
 
+TEST(pipe, netcdf_nested_vector_shape)
+{
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    dim = 5;\n"
+                       "variables:\n"
+                       "    int grid(dim, dim);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "nested_vector_shape.nc");
+
+    NetCDFPipe pipe{"nested_vector_shape.nc"};
+    pipe.open();
+
+    // The rows are flattened before writing, so a grid of another shape must
+    // not be read past its end
+    using Grid = std::vector<std::vector<int>>;
+    EXPECT_THROW((pipe.write<Grid, int, VectorInterface>("/grid", Grid(2, {1, 2, 3, 4, 5}))),
+                 std::runtime_error);
+    EXPECT_THROW((pipe.write<Grid, int, VectorInterface>("/grid", Grid(5, {1, 2}))), std::runtime_error);
+
+    Grid grid(5, {1, 2, 3, 4, 5});
+    pipe.write<Grid, int, VectorInterface>("/grid", grid);
+    EXPECT_EQ((pipe.read<Grid, int, VectorInterface>("/grid")), grid);
+
+    pipe.close();
+}
+
 /**
  * Make a custom vector ND reference to try supporting custom container
  * types
@@ -167,3 +203,724 @@ TEST(pipe, write_ND)
     EXPECT_EQ(foo.bee[3], 66);
     EXPECT_EQ(foo.bee[4], 5);
 }
+
+TEST(pipe, netcdf_variable_cache)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "group: foo{\n"
+                       "dimensions:\n"
+                       "    dim = 3;\n"
+                       "variables:\n"
+                       "    int bar;\n"
+                       "    double bee(dim);\n"
+                       "}}"};
+    make_nc_from_cdl(cdl, "cache.nc");
+
+    NetCDFPipe pipe{"cache.nc"};
+    pipe.open();
+
+    for (int i = 0; i < 3; i++)
+    {
+        pipe.write<int, int, VectorInterface>("/foo/bar", i);
+        pipe.write<std::vector<double>, double, VectorInterface>("/foo/bee", {1.0, 2.0, 3.0});
+    }
+    EXPECT_EQ(pipe.cache_statistics().misses, 2);
+    EXPECT_EQ(pipe.cache_statistics().hits, 4);
+
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 2);
+    EXPECT_EQ(pipe.cache_statistics().hits, 5);
+
+    // Closing the file invalidates the cached ids
+    pipe.close();
+    pipe.open();
+    EXPECT_EQ((pipe.read<std::vector<double>, double, VectorInterface>("/foo/bee")),
+              (std::vector<double>{1.0, 2.0, 3.0}));
+    EXPECT_EQ(pipe.cache_statistics().misses, 3);
+
+    // So does the define mode
+    pipe.redef();
+    pipe.enddef();
+    pipe.read<int, int, VectorInterface>("/foo/bar");
+    EXPECT_EQ(pipe.cache_statistics().misses, 4);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_variable_cache_unlimited_dimension)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "group: foo{\n"
+                       "variables:\n"
+                       "    float bar(time);\n"
+                       "}}"};
+    make_nc_from_cdl(cdl, "cache_unlimited.nc");
+
+    NetCDFPipe pipe{"cache_unlimited.nc"};
+    pipe.open();
+
+    const auto& variable = pipe.variable("/foo/bar");
+    ASSERT_EQ(variable.unlimited_dimensions, std::vector<bool>{true});
+    EXPECT_EQ(variable.dimension_sizes, std::vector<std::size_t>{0});
+
+    // Grow the unlimited dimension outside the pipe
+    std::vector<float> data{1.0f, 2.0f};
+    std::size_t start{0};
+    std::size_t count{data.size()};
+    ASSERT_EQ(nc_put_vara_float(variable.group_id, variable.variable_id, &start, &count, data.data()),
+              NC_NOERR);
+
+    // The cached variable has the current size
+    EXPECT_EQ((pipe.read<std::vector<float>, float, VectorInterface>("/foo/bar")), data);
+    EXPECT_EQ(pipe.cache_statistics().hits, 1);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_slab)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "group: foo{\n"
+                       "dimensions:\n"
+                       "    y = 4;\n"
+                       "    x = 5;\n"
+                       "variables:\n"
+                       "    int grid(y, x);\n"
+                       "}}"};
+    make_nc_from_cdl(cdl, "slab.nc");
+
+    NetCDFPipe pipe{"slab.nc"};
+    pipe.open();
+
+    using Grid = std::vector<std::vector<int>>;
+    Grid grid(4, std::vector<int>(5, 0));
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 5; x++)
+        {
+            grid[y][x] = y * 10 + x;
+        }
+    }
+    pipe.write_slab<Grid, int, VectorInterface>("/foo/grid", grid, {0, 0}, {4, 5});
+
+    // A tile
+    auto tile = pipe.read_slab<Grid, int, VectorInterface>("/foo/grid", {1, 2}, {2, 3});
+    EXPECT_EQ(tile, (Grid{{12, 13, 14}, {22, 23, 24}}));
+
+    // Every second column
+    auto strided = pipe.read_slab<Grid, int, VectorInterface>("/foo/grid", {0, 0}, {2, 3}, {2, 2});
+    EXPECT_EQ(strided, (Grid{{0, 2, 4}, {20, 22, 24}}));
+
+    // Overwrite a tile from a flat vector
+    pipe.write_slab<std::vector<int>, int, VectorInterface>("/foo/grid", {-1, -2, -3, -4}, {2, 3}, {2, 2});
+    tile = pipe.read_slab<Grid, int, VectorInterface>("/foo/grid", {2, 3}, {2, 2});
+    EXPECT_EQ(tile, (Grid{{-1, -2}, {-3, -4}}));
+
+    EXPECT_THROW((pipe.read_slab<std::vector<int>, int, VectorInterface>("/foo/grid", {0}, {4})),
+                 std::runtime_error);
+    std::vector<int> short_tile{1, 2, 3};
+    EXPECT_THROW(
+        (pipe.write_slab<std::vector<int>, int, VectorInterface>("/foo/grid", short_tile, {0, 0}, {2, 2})),
+        std::runtime_error);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_read_records)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "    x = 2;\n"
+                       "variables:\n"
+                       "    float temperature(time, x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "records.nc");
+
+    NetCDFPipe pipe{"records.nc"};
+    pipe.open();
+
+    std::vector<float> data{0.0f, 0.5f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 3.5f};
+    pipe.write_slab<std::vector<float>, float, VectorInterface>("/temperature", data, {0, 0}, {4, 2});
+
+    using Records = std::vector<std::vector<float>>;
+    auto records = pipe.read_records<Records, float, VectorInterface>("/temperature", 1, 2);
+    EXPECT_EQ(records, (Records{{1.0f, 1.5f}, {2.0f, 2.5f}}));
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_append)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "    x = 2;\n"
+                       "variables:\n"
+                       "    double time(time);\n"
+                       "    int position(time, x);\n"
+                       "    int count;\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "append.nc");
+
+    NetCDFPipe pipe{"append.nc", {.write_mode = NetCDFWriteMode::Append}};
+    pipe.open();
+    EXPECT_EQ(pipe.next_record("/time"), 0);
+
+    // The variables of a record are appended at the same index
+    for (int i = 0; i < 3; i++)
+    {
+        pipe.begin_record();
+        pipe.write<std::vector<double>, double, VectorInterface>("/time", {i * 0.5});
+        pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/position", {{i, -i}});
+        pipe.write<int, int, VectorInterface>("/count", i);
+        pipe.end_record();
+    }
+    EXPECT_EQ(pipe.next_record("/position"), 3);
+
+    // Several records at once
+    pipe.begin_record();
+    pipe.write<std::vector<double>, double, VectorInterface>("/time", {1.5, 2.0});
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/position", {{3, -3}, {4, -4}});
+    pipe.end_record();
+    pipe.close();
+
+    // Appending continues after the records in the file
+    pipe.open();
+    EXPECT_EQ(pipe.next_record("/time"), 5);
+    pipe.append<std::vector<double>, double, VectorInterface>("/time", {2.5});
+    EXPECT_EQ(pipe.next_record("/time"), 6);
+
+    EXPECT_EQ((pipe.read<std::vector<double>, double, VectorInterface>("/time")),
+              (std::vector<double>{0.0, 0.5, 1.0, 1.5, 2.0, 2.5}));
+    EXPECT_EQ((pipe.read_records<std::vector<std::vector<int>>, int, VectorInterface>("/position", 0, 5)),
+              (std::vector<std::vector<int>>{{0, 0}, {1, -1}, {2, -2}, {3, -3}, {4, -4}}));
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/count")), 2);
+
+    // The records have to match the fixed dimensions
+    EXPECT_THROW((pipe.append<std::vector<std::vector<int>>, int, VectorInterface>("/position", {{1, 2, 3}})),
+                 std::runtime_error);
+    EXPECT_THROW((pipe.append<std::vector<int>, int, VectorInterface>("/position", {1, 2})),
+                 std::runtime_error);
+    EXPECT_THROW(pipe.next_record("/count"), std::runtime_error);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_append_after_failed_write)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "    x = 2;\n"
+                       "variables:\n"
+                       "    double time(time);\n"
+                       "    int position(time, x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "append_failed.nc");
+
+    NetCDFPipe pipe{"append_failed.nc", {.write_mode = NetCDFWriteMode::Append}};
+    pipe.open();
+
+    // The position of the record does not match the dimension x
+    pipe.begin_record();
+    pipe.write<std::vector<double>, double, VectorInterface>("/time", {0.5});
+    EXPECT_THROW((pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/position", {{1, 2, 3}})),
+                 std::runtime_error);
+    pipe.discard_record();
+    EXPECT_EQ(pipe.next_record("/time"), 0);
+
+    // The next records are appended one after another, over the discarded record
+    for (int i = 0; i < 3; i++)
+    {
+        pipe.begin_record();
+        pipe.write<std::vector<double>, double, VectorInterface>("/time", {i * 1.0});
+        pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/position", {{i, -i}});
+        pipe.end_record();
+    }
+    EXPECT_EQ(pipe.next_record("/time"), 3);
+    EXPECT_EQ((pipe.read<std::vector<double>, double, VectorInterface>("/time")),
+              (std::vector<double>{0.0, 1.0, 2.0}));
+    EXPECT_EQ((pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/position")),
+              (std::vector<std::vector<int>>{{0, 0}, {1, -1}, {2, -2}}));
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_nd_array)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "    y = 3;\n"
+                       "    x = 4;\n"
+                       "variables:\n"
+                       "    float grid(y, x);\n"
+                       "    float field(time, y, x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "nd_array.nc");
+
+    NetCDFPipe pipe{"nd_array.nc"};
+    pipe.open();
+
+    using Grid = NDArray<float, 2>;
+    Grid grid{{3, 4}};
+    for (std::size_t i = 0; i < grid.size(); i++)
+    {
+        grid.data()[i] = static_cast<float>(i);
+    }
+    pipe.write<Grid, float, NDArrayInterface>("/grid", grid);
+
+    // The array is read directly to its buffer, and matches the nested vectors
+    auto read_grid = pipe.read<Grid, float, NDArrayInterface>("/grid");
+    EXPECT_EQ(read_grid, grid);
+    EXPECT_EQ(read_grid(2, 1), 9.0f);
+    auto vector_grid = pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/grid");
+    EXPECT_EQ(vector_grid[2][1], 9.0f);
+
+    auto tile = pipe.read_slab<Grid, float, NDArrayInterface>("/grid", {1, 1}, {2, 2});
+    EXPECT_EQ(tile, (Grid{{2, 2}, {5, 6, 9, 10}}));
+    pipe.write_slab<Grid, float, NDArrayInterface>("/grid", Grid{{1, 2}, {-1, -2}}, {0, 0}, {1, 2});
+    EXPECT_EQ((pipe.read<Grid, float, NDArrayInterface>("/grid")(0, 1)), -2.0f);
+
+    // The records are checked against the shape of the array
+    using Field = NDArray<float, 3>;
+    pipe.append<Field, float, NDArrayInterface>("/field", Field{{2, 3, 4}, 1.0f});
+    pipe.append<Field, float, NDArrayInterface>("/field", Field{{1, 3, 4}, 2.0f});
+    auto records = pipe.read_records<Field, float, NDArrayInterface>("/field", 1, 2);
+    EXPECT_EQ(records.shape(), (std::array<std::size_t, 3>{2, 3, 4}));
+    EXPECT_EQ(records(0, 2, 3), 1.0f);
+    EXPECT_EQ(records(1, 0, 0), 2.0f);
+    EXPECT_THROW((pipe.append<Field, float, NDArrayInterface>("/field", Field{{1, 4, 3}})), std::runtime_error);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_fixed_array)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "    y = 3;\n"
+                       "    x = 4;\n"
+                       "variables:\n"
+                       "    float grid(y, x);\n"
+                       "    float field(time, y, x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "fixed_array.nc");
+
+    NetCDFPipe pipe{"fixed_array.nc"};
+    pipe.open();
+
+    using Grid = FixedArray<float, 3, 4>;
+    Grid grid{};
+    for (std::size_t i = 0; i < grid.size(); i++)
+    {
+        grid.data()[i] = static_cast<float>(i);
+    }
+    pipe.write<Grid, float, FixedArrayInterface>("/grid", grid);
+
+    // The array is read directly to its inline buffer
+    auto read_grid = pipe.read<Grid, float, FixedArrayInterface>("/grid");
+    EXPECT_EQ(read_grid, grid);
+    EXPECT_EQ(read_grid(2, 1), 9.0f);
+
+    // A slab has to have the fixed shape of the array
+    using Tile = FixedArray<float, 2, 2>;
+    auto tile = pipe.read_slab<Tile, float, FixedArrayInterface>("/grid", {1, 1}, {2, 2});
+    EXPECT_EQ(tile, (Tile{{5, 6, 9, 10}}));
+    EXPECT_THROW((pipe.read_slab<Tile, float, FixedArrayInterface>("/grid", {0, 0}, {1, 2})), std::runtime_error);
+
+    // And the fixed shape of a written array the shape of the variable
+    EXPECT_THROW((pipe.write<Tile, float, FixedArrayInterface>("/grid", tile)), std::runtime_error);
+    EXPECT_THROW((pipe.write<FixedArray<float, 4, 3>, float, FixedArrayInterface>("/grid", {})),
+                 std::runtime_error);
+
+    // The records of the unlimited dimension keep the nested vectors
+    using Field = std::vector<std::vector<std::vector<float>>>;
+    Field field(2, std::vector<std::vector<float>>(3, std::vector<float>(4, 1.0f)));
+    pipe.append<Field, float, FixedArrayInterface>("/field", field);
+    EXPECT_EQ((pipe.read<Field, float, FixedArrayInterface>("/field")), field);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_read_into)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    y = 3;\n"
+                       "    x = 4;\n"
+                       "variables:\n"
+                       "    int count;\n"
+                       "    float grid(y, x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "read_into.nc");
+
+    NetCDFPipe pipe{"read_into.nc"};
+    pipe.open();
+
+    std::vector<std::vector<float>> grid(3, std::vector<float>{1, 2, 3, 4});
+    pipe.write<int, int, VectorInterface>("/count", 7);
+    pipe.write<std::vector<std::vector<float>>, float, VectorInterface>("/grid", grid);
+
+    int count{};
+    pipe.read_into<int, int, VectorInterface>("/count", count);
+    EXPECT_EQ(count, 7);
+
+    // The rows are allocated from the arena, which has no upstream
+    std::array<std::byte, 1024> arena{};
+    std::pmr::monotonic_buffer_resource resource{arena.data(), arena.size(),
+                                                 std::pmr::null_memory_resource()};
+    using Grid = std::pmr::vector<std::pmr::vector<float>>;
+    Grid read_grid{&resource};
+    pipe.read_into<Grid, float, VectorInterface>("/grid", read_grid);
+    ASSERT_EQ(read_grid.size(), 3);
+    EXPECT_EQ(read_grid[2][3], 4.0f);
+    EXPECT_EQ(read_grid[2].get_allocator().resource(), &resource);
+
+    // Reading again reuses the rows, 100 reads would not fit to the arena
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        pipe.read_into<Grid, float, VectorInterface>("/grid", read_grid);
+    }
+    EXPECT_EQ(read_grid[0][1], 2.0f);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_array_span)
+{
+
+    std::string cdl = {"netcdf simple {\n"
+                       "dimensions:\n"
+                       "    time = unlimited;\n"
+                       "    y = 2;\n"
+                       "    x = 3;\n"
+                       "variables:\n"
+                       "    short frame(y, x);\n"
+                       "    short frames(time, y, x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "array_span.nc");
+
+    NetCDFPipe pipe{"array_span.nc"};
+    pipe.open();
+
+    // The memory of the producer, e.g. a slot of a DMA ring buffer
+    const std::int16_t slot[2][3] = {{1, 2, 3}, {4, 5, 6}};
+    pipe.write("/frame", ArraySpan<std::int16_t, 2>{&slot[0][0], {2, 3}});
+
+    using Frame = std::vector<std::vector<std::int16_t>>;
+    EXPECT_EQ((pipe.read<Frame, std::int16_t, VectorInterface>("/frame")), (Frame{{1, 2, 3}, {4, 5, 6}}));
+
+    // The records are appended with the shape of the span
+    pipe.append<ArraySpan<std::int16_t, 3>, std::int16_t, ArraySpanInterface>(
+        "/frames", ArraySpan<std::int16_t, 3>{&slot[0][0], {1, 2, 3}});
+    EXPECT_THROW((pipe.append<ArraySpan<std::int16_t, 3>, std::int16_t, ArraySpanInterface>(
+                     "/frames", ArraySpan<std::int16_t, 3>{&slot[0][0], {1, 3, 2}})),
+                 std::runtime_error);
+
+    // The span has to have the shape of the variable, not only fit it
+    EXPECT_THROW(pipe.write("/frame", ArraySpan<std::int16_t, 2>{&slot[0][0], {1, 3}}), std::runtime_error);
+    EXPECT_THROW(pipe.write("/frame", ArraySpan<std::int16_t, 2>{&slot[0][0], {3, 2}}), std::runtime_error);
+    EXPECT_THROW(pipe.write("/frame", ArraySpan<std::int16_t, 1>{&slot[0][0], 6}), std::runtime_error);
+    const std::int16_t larger[3][3] = {};
+    EXPECT_THROW(pipe.write("/frame", ArraySpan<std::int16_t, 2>{&larger[0][0], {3, 3}}), std::runtime_error);
+
+    // The contiguous containers without a shape need the exact number of elements
+    EXPECT_THROW((pipe.write<std::vector<std::int16_t>, std::int16_t, VectorInterface>(
+                     "/frame", std::vector<std::int16_t>(7))),
+                 std::runtime_error);
+
+    pipe.close();
+}
+
+TEST(pipe, netcdf_create_from_schema)
+{
+
+    std::string cdl = {"netcdf foo {\n"
+                       "types:\n"
+                       "    ubyte enum enum_t {Clear = 0, Cumulonimbus = 1, Stratus = 2};\n"
+                       "    opaque(11) opaque_t;\n"
+                       "    int(*) vlen_t;\n"
+                       "dimensions:\n"
+                       "    lat = 3, time = unlimited ;\n"
+                       "variables:\n"
+                       "    double p(time, lat);\n"
+                       "    float lat(lat);\n"
+                       "    lat:units = \"degrees_north\";\n"
+                       "    lat:_CoordinateAxisType = \"Lat\";\n"
+                       "    float Z(time, lat);\n"
+                       "    float Z:valid_range = 0., 5000.;\n"
+                       "    double p:_FillValue = -9999.;\n"
+                       "    :title = \"created\";\n"
+                       "    vlen_t :globalatt = {17, 18, 19};\n"
+                       "group: g {\n"
+                       "types:\n"
+                       "    compound cmpd_t { vlen_t f1; enum_t f2;};\n"
+                       "variables:\n"
+                       "    int bar(lat);\n"
+                       "    cmpd_t compoundvar;\n"
+                       "}}"};
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    auto root = parser.parse();
+    ASSERT_TRUE(root.has_value());
+
+    NetCDFPipe pipe{"created.nc", {.write_mode = NetCDFWriteMode::Append}};
+    pipe.create_from_schema(*root);
+
+    // The dimensions of the parent group are visible in the sub group
+    std::vector<int> bar{1, 2, 3};
+    pipe.write<std::vector<int>, int, VectorInterface>("/g/bar", bar);
+    EXPECT_EQ((pipe.read<std::vector<int>, int, VectorInterface>("/g/bar")), bar);
+
+    // The unlimited dimension grows with the records
+    EXPECT_EQ(pipe.next_record("/p"), 0);
+    pipe.write<std::vector<std::vector<double>>, double, VectorInterface>("/p", {{1.0, 2.0, 3.0}});
+    EXPECT_EQ(pipe.next_record("/p"), 1);
+
+    auto& p = pipe.variable("/p");
+    nc_type type{};
+    std::size_t length{};
+    ASSERT_EQ(nc_inq_att(p.group_id, p.variable_id, "_FillValue", &type, &length), NC_NOERR);
+    EXPECT_EQ(type, NC_DOUBLE);
+
+    auto& z = pipe.variable("/Z");
+    ASSERT_EQ(nc_inq_att(z.group_id, z.variable_id, "valid_range", &type, &length), NC_NOERR);
+    EXPECT_EQ(type, NC_FLOAT);
+    EXPECT_EQ(length, 2);
+
+    auto& lat = pipe.variable("/lat");
+    ASSERT_EQ(nc_inq_att(lat.group_id, lat.variable_id, "units", &type, &length), NC_NOERR);
+    std::string units(length, '\0');
+    ASSERT_EQ(nc_get_att_text(lat.group_id, lat.variable_id, "units", units.data()), NC_NOERR);
+    EXPECT_EQ(units, "degrees_north");
+
+    // The attributes starting with an underscore are stored, except the virtual storage attributes
+    ASSERT_EQ(nc_inq_att(lat.group_id, lat.variable_id, "_CoordinateAxisType", &type, &length), NC_NOERR);
+    EXPECT_EQ(type, NC_CHAR);
+
+    ASSERT_EQ(nc_inq_att(lat.group_id, NC_GLOBAL, "globalatt", &type, &length), NC_NOERR);
+    EXPECT_EQ(length, 1);
+
+    // The variable of the user defined type
+    auto& compoundvar = pipe.variable("/g/compoundvar");
+    EXPECT_GT(compoundvar.nc_type, NC_STRING);
+    pipe.close();
+
+    // The created file can be opened again
+    pipe.open();
+    EXPECT_EQ((pipe.read<std::vector<int>, int, VectorInterface>("/g/bar")), bar);
+    pipe.close();
+}
+
+TEST(pipe, netcdf_storage_attributes)
+{
+
+    std::string cdl = {"netcdf foo {\n"
+                       "dimensions:\n"
+                       "    time = unlimited, lat = 8, lon = 4;\n"
+                       "variables:\n"
+                       "    float t(time, lat, lon);\n"
+                       "    t:_ChunkSizes = 1, 8, 4;\n"
+                       "    t:_DeflateLevel = 2;\n"
+                       "    t:_Shuffle = \"true\";\n"
+                       "    t:units = \"K\";\n"
+                       "    float lat(lat);\n"
+                       "    lat:_Storage = \"contiguous\";\n"
+                       "}"};
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    auto root = parser.parse();
+    ASSERT_TRUE(root.has_value());
+
+    NetCDFPipe pipe{"storage.nc"};
+    pipe.create_from_schema(*root);
+
+    auto& t = pipe.variable("/t");
+    int storage{};
+    std::vector<std::size_t> chunk_sizes(3);
+    ASSERT_EQ(nc_inq_var_chunking(t.group_id, t.variable_id, &storage, chunk_sizes.data()), NC_NOERR);
+    EXPECT_EQ(storage, NC_CHUNKED);
+    EXPECT_EQ(chunk_sizes, (std::vector<std::size_t>{1, 8, 4}));
+
+    int shuffle{};
+    int deflate{};
+    int deflate_level{};
+    ASSERT_EQ(nc_inq_var_deflate(t.group_id, t.variable_id, &shuffle, &deflate, &deflate_level), NC_NOERR);
+    EXPECT_EQ(shuffle, 1);
+    EXPECT_EQ(deflate, 1);
+    EXPECT_EQ(deflate_level, 2);
+
+    // The special attributes are not stored as attributes
+    nc_type type{};
+    std::size_t length{};
+    EXPECT_NE(nc_inq_att(t.group_id, t.variable_id, "_DeflateLevel", &type, &length), NC_NOERR);
+    EXPECT_EQ(nc_inq_att(t.group_id, t.variable_id, "units", &type, &length), NC_NOERR);
+
+    auto& lat = pipe.variable("/lat");
+    ASSERT_EQ(nc_inq_var_chunking(lat.group_id, lat.variable_id, &storage, nullptr), NC_NOERR);
+    EXPECT_EQ(storage, NC_CONTIGUOUS);
+
+    // The chunk cache of the variable
+    pipe.set_chunk_cache("/t", {.size = 1024 * 1024, .slots = 101, .preemption = 0.5f});
+    auto cache = pipe.chunk_cache("/t");
+    EXPECT_EQ(cache.size, 1024 * 1024);
+    EXPECT_EQ(cache.slots, 101);
+    EXPECT_FLOAT_EQ(cache.preemption, 0.5f);
+
+    // The compressed records can be written and read back
+    using Records = std::vector<std::vector<std::vector<float>>>;
+    Records record(1, std::vector<std::vector<float>>(8, {1, 2, 3, 4}));
+    pipe.write_slab<Records, float, VectorInterface>("/t", record, {0, 0, 0}, {1, 8, 4});
+    EXPECT_EQ((pipe.read<Records, float, VectorInterface>("/t")), record);
+    pipe.close();
+}
+
+TEST(pipe, netcdf_element_types)
+{
+    std::string cdl = {"netcdf types {\n"
+                       "dimensions:\n"
+                       "    x = 4, name = 3, y = 2;\n"
+                       "variables:\n"
+                       "    float t(x);\n"
+                       "    float grid(y, y);\n"
+                       "    double d;\n"
+                       "    short s(x);\n"
+                       "    char label(name);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "element_types.nc");
+
+    // The elements of another type than the variable are rejected by default
+    NetCDFPipe pipe{"element_types.nc"};
+    pipe.open();
+    std::vector<double> data{1.5, 2.5, -3.5, 4.0};
+    EXPECT_THROW((pipe.write<std::vector<double>, double, VectorInterface>("/t", data)), std::runtime_error);
+    EXPECT_THROW((pipe.write<float, float, VectorInterface>("/d", 1.0f)), std::runtime_error);
+    EXPECT_THROW((pipe.read<std::vector<int>, int, VectorInterface>("/t")), std::runtime_error);
+
+    // The 1 byte integers are the characters of char variables
+    std::vector<int8_t> label{'a', 'b', 'c'};
+    pipe.write<std::vector<int8_t>, int8_t, VectorInterface>("/label", label);
+    EXPECT_EQ((pipe.read<std::vector<int8_t>, int8_t, VectorInterface>("/label")), label);
+    pipe.close();
+
+    // And converted to the type of the variable in the Convert mode
+    NetCDFPipe converting_pipe{"element_types.nc", {.type_conversion = NetCDFTypeConversion::Convert}};
+    converting_pipe.open();
+    converting_pipe.write<std::vector<double>, double, VectorInterface>("/t", data);
+    converting_pipe.write<float, float, VectorInterface>("/d", 0.25f);
+    converting_pipe.write_slab<std::vector<int>, int, VectorInterface>("/t", {7}, {3}, {1});
+
+    EXPECT_EQ((converting_pipe.read<std::vector<float>, float, VectorInterface>("/t")),
+              (std::vector<float>{1.5f, 2.5f, -3.5f, 7.0f}));
+    EXPECT_EQ((converting_pipe.read<std::vector<double>, double, VectorInterface>("/t")),
+              (std::vector<double>{1.5, 2.5, -3.5, 7.0}));
+    EXPECT_EQ((converting_pipe.read<double, double, VectorInterface>("/d")), 0.25);
+
+    // The nested containers are read through the read buffer, converted from another buffer
+    using Grid = std::vector<std::vector<double>>;
+    Grid grid{{1.0, 2.0}, {3.0, 4.0}};
+    converting_pipe.write<Grid, double, VectorInterface>("/grid", grid);
+    EXPECT_EQ((converting_pipe.read<Grid, double, VectorInterface>("/grid")), grid);
+
+    // The values out of the range of the type converted to are rejected
+    using Values = std::vector<int>;
+    EXPECT_THROW((converting_pipe.write<Values, int, VectorInterface>("/s", {1, 2, 70000, 4})),
+                 std::runtime_error);
+    EXPECT_THROW((converting_pipe.write<Values, int, VectorInterface>("/s", {1, 2, -32769, 4})),
+                 std::runtime_error);
+    EXPECT_THROW(
+        (converting_pipe.write<std::vector<double>, double, VectorInterface>("/t", {1.0, 1e40, 3.0, 4.0})),
+        std::runtime_error);
+    EXPECT_THROW((converting_pipe.write<std::vector<double>, double, VectorInterface>(
+                     "/s", {1.0, 2.0, std::numeric_limits<double>::quiet_NaN(), 4.0})),
+                 std::runtime_error);
+    converting_pipe.write<Values, int, VectorInterface>("/s", {1, -32768, 32767, 4});
+    EXPECT_EQ((converting_pipe.read<Values, int, VectorInterface>("/s")), (Values{1, -32768, 32767, 4}));
+    EXPECT_THROW((converting_pipe.read<std::vector<std::uint8_t>, std::uint8_t, VectorInterface>("/s")),
+                 std::runtime_error);
+    converting_pipe.write<std::vector<double>, double, VectorInterface>("/t", {1.5, 2.5, 1e10, 4.0});
+    EXPECT_THROW((converting_pipe.read<Values, int, VectorInterface>("/t")), std::runtime_error);
+
+    // The characters are not converted
+    EXPECT_THROW((converting_pipe.read<std::vector<float>, float, VectorInterface>("/label")),
+                 std::runtime_error);
+    converting_pipe.close();
+}
+
+TEST(pipe, netcdf_memory)
+{
+
+    std::string cdl = {"netcdf memory {\n"
+                       "dimensions:\n"
+                       "    time = unlimited, x = 3;\n"
+                       "variables:\n"
+                       "    float t(time, x);\n"
+                       "}"};
+    Tokeniser tokeniser{cdl};
+    auto tokens = tokeniser.tokenise();
+    Parser parser{tokens};
+    auto root = parser.parse();
+    ASSERT_TRUE(root.has_value());
+    std::filesystem::remove("memory.nc");
+
+    // The file is built in memory and handed over as a buffer
+    NetCDFPipe pipe{"memory.nc",
+                    {.write_mode = NetCDFWriteMode::Append, .storage = NetCDFStorage::Memory}};
+    pipe.create_from_schema(*root);
+    std::vector<std::vector<float>> records{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}};
+    pipe.write<std::vector<std::vector<float>>, float, VectorInterface>("/t", records);
+    auto buffer = pipe.close_memory();
+    EXPECT_FALSE(buffer.empty());
+    EXPECT_FALSE(std::filesystem::exists("memory.nc"));
+
+    // And opened from the buffer by another pipe
+    NetCDFPipe reading_pipe{"received.nc", {.storage = NetCDFStorage::Memory, .persist = true}};
+    reading_pipe.open_memory(buffer);
+    EXPECT_EQ((reading_pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/t")), records);
+
+    // Which persists it to the disk when closing
+    reading_pipe.close();
+    NetCDFPipe disk_pipe{"received.nc"};
+    disk_pipe.open();
+    EXPECT_EQ((disk_pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/t")), records);
+    disk_pipe.close();
+}
+
+TEST(pipe, netcdf_diskless)
+{
+
+    std::string cdl = {"netcdf diskless {\n"
+                       "dimensions:\n"
+                       "    x = 3;\n"
+                       "variables:\n"
+                       "    int bar(x);\n"
+                       "}"};
+    make_nc_from_cdl(cdl, "diskless.nc");
+
+    // The changes of a diskless file are not written to the disk
+    NetCDFPipe pipe{"diskless.nc", {.storage = NetCDFStorage::Diskless}};
+    pipe.open();
+    pipe.write<std::vector<int>, int, VectorInterface>("/bar", {1, 2, 3});
+    EXPECT_EQ((pipe.read<std::vector<int>, int, VectorInterface>("/bar")), (std::vector<int>{1, 2, 3}));
+    pipe.close();
+
+    NetCDFPipe disk_pipe{"diskless.nc"};
+    disk_pipe.open();
+    EXPECT_NE((disk_pipe.read<std::vector<int>, int, VectorInterface>("/bar")), (std::vector<int>{1, 2, 3}));
+    disk_pipe.close();
+}
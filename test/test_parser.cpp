@@ -259,3 +259,66 @@ TEST(parser, variables)
     EXPECT_EQ(dimensions[0].length, 5);
     EXPECT_EQ(dimensions[0].name, "dim");
 }
+
+TEST(parser, fingerprint)
+{
+    auto parse = [](const std::string& input)
+    {
+        auto input_tokens = tokens_from_string(input);
+        Parser parser{input_tokens};
+        auto result = parser.parse();
+        EXPECT_TRUE(result.has_value());
+        return fingerprint(*result->group);
+    };
+
+    auto reference = parse("netcdf foo { variables: int bar; float baz(dim); }");
+
+    // Equal schemas have equal fingerprints, any change to them changes it
+    EXPECT_EQ(reference, parse("netcdf foo { variables: int bar; float baz(dim); }"));
+    EXPECT_NE(reference, parse("netcdf foo { variables: int bar; double baz(dim); }"));
+    EXPECT_NE(reference, parse("netcdf foo { variables: int bar; float bee(dim); }"));
+    EXPECT_NE(reference, parse("netcdf foo { variables: int bar; float baz(dim2); }"));
+    EXPECT_NE(reference, parse("netcdf foo { variables: float baz(dim); int bar; }"));
+}
+
+TEST(parser, storage_attributes)
+{
+
+    std::string input{"netcdf foo {\n"
+                      "dimensions:\n"
+                      "    time = unlimited, lat = 10;\n"
+                      "variables:\n"
+                      "    float t(time, lat);\n"
+                      "    t:_Storage = \"chunked\";\n"
+                      "    t:_ChunkSizes = 1, 10;\n"
+                      "    t:_DeflateLevel = 4;\n"
+                      "    t:_Shuffle = \"true\";\n"
+                      "    float lat(lat);\n"
+                      "    lat:_Storage = \"contiguous\";\n"
+                      "    lat:units = \"degrees_north\";\n"
+                      "}"};
+    auto input_tokens = tokens_from_string(input);
+
+    Parser parser{input_tokens};
+    auto result = parser.parse();
+    ASSERT_TRUE(result.has_value());
+
+    auto& variables = result->group->variables();
+    ASSERT_EQ(variables.size(), 2);
+
+    auto& storage = variables[0].storage();
+    EXPECT_EQ(storage.layout, StorageLayout::Chunked);
+    EXPECT_EQ(storage.chunk_sizes, (std::vector<std::size_t>{1, 10}));
+    EXPECT_EQ(storage.deflate_level, 4);
+    EXPECT_EQ(storage.shuffle, true);
+    auto& shuffle = result->group->attributes()[3];
+    EXPECT_EQ(shuffle.name(), "_Shuffle");
+    EXPECT_EQ(shuffle.type().value(), NetCDFType(NetCDFElementaryType::String));
+
+    EXPECT_EQ(variables[1].storage().layout, StorageLayout::Contiguous);
+    EXPECT_FALSE(variables[1].storage().has_filters());
+
+    // The following attributes are parsed as usual
+    ASSERT_EQ(result->group->attributes().size(), 6);
+    EXPECT_EQ(result->group->attributes()[5].name(), "units");
+}
@@ -0,0 +1,219 @@
+#include <memory>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+#include "pipes/shared_memory_pipe.h"
+
+using namespace ncdlgen;
+
+TEST(pipe, shared_memory_scalar)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_scalar"}};
+
+    int data{4};
+    pipe.write<int, int, VectorInterface>("/foo/bar", data);
+
+    auto read_data = pipe.read<int, int, VectorInterface>("/foo/bar");
+
+    EXPECT_EQ(read_data, data);
+}
+
+TEST(pipe, shared_memory_vector)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_vector"}};
+
+    std::vector<int> data{1, 2, 3};
+    pipe.write<std::vector<int>, int, VectorInterface>("/foo/bar", data);
+
+    auto read_data = pipe.read<std::vector<int>, int, VectorInterface>("/foo/bar");
+
+    EXPECT_EQ(read_data, data);
+}
+
+TEST(pipe, shared_memory_vector_2d)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_vector_2d"}};
+
+    std::vector<std::vector<double>> data{{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
+    pipe.write<std::vector<std::vector<double>>, double, VectorInterface>("/foo/bar", data);
+
+    auto read_data = pipe.read<std::vector<std::vector<double>>, double, VectorInterface>("/foo/bar");
+
+    EXPECT_EQ(read_data, data);
+}
+
+TEST(pipe, shared_memory_read_into)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_read_into"}};
+
+    std::vector<float> data{1.0f, 2.0f, 3.0f};
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/bar", data);
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/bar", data);
+
+    std::vector<float> read_data{};
+    pipe.read_into<std::vector<float>, float, VectorInterface>("/foo/bar", read_data);
+    auto* storage = read_data.data();
+    pipe.read_into<std::vector<float>, float, VectorInterface>("/foo/bar", read_data);
+
+    EXPECT_EQ(read_data, data);
+    EXPECT_EQ(read_data.data(), storage);
+}
+
+TEST(pipe, shared_memory_wrap_around)
+{
+
+    // Room for a couple of fields, the writes wrap around the end of the ring
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_wrap_around", .capacity = 256}};
+
+    for (int i = 0; i < 20; i++)
+    {
+        std::vector<int> data(i % 7 + 1, i);
+        pipe.write<std::vector<int>, int, VectorInterface>("/foo/bar", data);
+
+        auto read_data = pipe.read<std::vector<int>, int, VectorInterface>("/foo/bar");
+        EXPECT_EQ(read_data, data);
+    }
+}
+
+TEST(pipe, shared_memory_writer_and_reader)
+{
+
+    // The writer creates the ring and waits for the reader to free space
+    SharedMemoryPipe writer{{.name = "/ncdlgen_test_writer_and_reader", .capacity = 1024}};
+    SharedMemoryPipe reader{{.name = "/ncdlgen_test_writer_and_reader", .capacity = 4}};
+
+    EXPECT_EQ(reader.capacity(), writer.capacity());
+
+    constexpr int count{1000};
+    std::thread writing_thread{[&]
+                               {
+                                   for (int i = 0; i < count; i++)
+                                   {
+                                       std::vector<int> data(i % 31 + 1, i);
+                                       writer.write<std::vector<int>, int, VectorInterface>("/foo/bar", data);
+                                   }
+                               }};
+
+    for (int i = 0; i < count; i++)
+    {
+        auto read_data = reader.read<std::vector<int>, int, VectorInterface>("/foo/bar");
+        ASSERT_EQ(read_data, std::vector<int>(i % 31 + 1, i));
+    }
+
+    writing_thread.join();
+}
+
+TEST(pipe, shared_memory_read_incorrect_path)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_incorrect_path"}};
+
+    int data{4};
+    pipe.write<int, int, VectorInterface>("/foo/bar", data);
+    pipe.write<int, int, VectorInterface>("/foo/baz", data);
+
+    EXPECT_THROW((pipe.read<int, int, VectorInterface>("/foo/baz")), std::runtime_error);
+
+    // The mismatching field is still the next one
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), data);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), data);
+}
+
+TEST(pipe, shared_memory_read_incorrect_element_type)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_incorrect_element_type"}};
+
+    int data{4};
+    pipe.write<int, int, VectorInterface>("/foo/bar", data);
+
+    EXPECT_THROW((pipe.read<float, float, VectorInterface>("/foo/bar")), std::runtime_error);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), data);
+}
+
+TEST(pipe, shared_memory_field_too_large)
+{
+
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_too_large", .capacity = 128}};
+
+    std::vector<double> data(64, 1.0);
+    EXPECT_THROW((pipe.write<std::vector<double>, double, VectorInterface>("/foo/bar", data)),
+                 std::runtime_error);
+}
+
+TEST(pipe, shared_memory_timeout)
+{
+
+    SharedMemoryPipe pipe{
+        {.name = "/ncdlgen_test_timeout", .capacity = 96, .receive_timeout_ms = 10, .send_timeout_ms = 10}};
+
+    EXPECT_THROW((pipe.read<int, int, VectorInterface>("/foo/bar")), std::runtime_error);
+
+    // The first field fills the ring
+    std::vector<int> data(8, 1);
+    pipe.write<std::vector<int>, int, VectorInterface>("/foo/bar", data);
+    EXPECT_THROW((pipe.write<std::vector<int>, int, VectorInterface>("/foo/bar", data)), std::runtime_error);
+}
+
+TEST(pipe, shared_memory_stale_ring)
+{
+
+    // A creator that exits without closing its pipe leaves the ring behind
+    auto creator = fork();
+    ASSERT_GE(creator, 0);
+    if (creator == 0)
+    {
+        new SharedMemoryPipe{{.name = "/ncdlgen_test_stale_ring", .capacity = 256}};
+        _exit(0);
+    }
+    int status{};
+    ASSERT_EQ(waitpid(creator, &status, 0), creator);
+
+    // The stale ring is replaced by a new one
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_stale_ring", .capacity = 1024}};
+    EXPECT_EQ(pipe.capacity(), 1024);
+
+    int data{4};
+    pipe.write<int, int, VectorInterface>("/foo/bar", data);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), data);
+}
+
+TEST(pipe, shared_memory_recreate)
+{
+
+    SharedMemoryPipe previous{{.name = "/ncdlgen_test_recreate", .capacity = 256}};
+    int data{4};
+    previous.write<int, int, VectorInterface>("/foo/bar", data);
+
+    // Without the fields of the previous ring
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_recreate", .capacity = 1024, .recreate = true}};
+    EXPECT_EQ(pipe.capacity(), 1024);
+
+    pipe.write<int, int, VectorInterface>("/foo/baz", data);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), data);
+}
+
+TEST(pipe, shared_memory_recreate_previous_closed)
+{
+
+    auto previous =
+        std::make_unique<SharedMemoryPipe>(SharedMemoryConfiguration{.name = "/ncdlgen_test_recreate_closed"});
+    SharedMemoryPipe pipe{{.name = "/ncdlgen_test_recreate_closed", .capacity = 1024, .recreate = true}};
+    int data{4};
+    pipe.write<int, int, VectorInterface>("/foo/bar", data);
+
+    // The previous creator does not remove the name of the recreated ring
+    previous.reset();
+    SharedMemoryPipe reader{{.name = "/ncdlgen_test_recreate_closed", .receive_timeout_ms = 1000}};
+    ASSERT_EQ(reader.capacity(), 1024);
+    EXPECT_EQ((reader.read<int, int, VectorInterface>("/foo/bar")), data);
+}
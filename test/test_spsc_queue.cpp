@@ -0,0 +1,103 @@
+
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "pipes/spsc_queue.h"
+
+using namespace ncdlgen;
+
+TEST(spsc_queue, push_pop)
+{
+    SPSCQueue<int> queue{2};
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.capacity(), 2);
+
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_push(2));
+    EXPECT_FALSE(queue.try_push(3));
+    EXPECT_EQ(queue.size(), 2);
+
+    int value{};
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.try_push(3));
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(spsc_queue, pop_releases_value)
+{
+    SPSCQueue<std::shared_ptr<int>> queue{1};
+
+    auto value = std::make_shared<int>(1);
+    queue.try_push(std::shared_ptr<int>{value});
+
+    std::shared_ptr<int> popped{};
+    queue.try_pop(popped);
+    popped.reset();
+
+    EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(spsc_queue, threads)
+{
+    constexpr int count = 100000;
+    SPSCQueue<int> queue{16};
+
+    std::thread producer(
+        [&]
+        {
+            for (int i = 0; i < count; i++)
+            {
+                while (!queue.try_push(int{i}))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    int expected{};
+    while (expected < count)
+    {
+        int value{};
+        if (!queue.try_pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(value, expected);
+        expected++;
+    }
+    producer.join();
+}
+
+TEST(spsc_queue, swap_recycles_values)
+{
+    SPSCQueue<std::vector<int>> queue{1};
+
+    std::vector<int> value(16, 1);
+    const auto* storage = value.data();
+    EXPECT_TRUE(queue.try_swap_push(value));
+    EXPECT_TRUE(value.empty());
+
+    // The pop leaves the previous contents of the output to the slot
+    std::vector<int> popped(8, 2);
+    const auto* popped_storage = popped.data();
+    EXPECT_TRUE(queue.try_swap_pop(popped));
+    EXPECT_EQ(popped.data(), storage);
+
+    // Which are handed back to the producer once the pushes wrap around to the slot
+    value.assign(4, 3);
+    EXPECT_TRUE(queue.try_swap_push(value));
+    EXPECT_TRUE(queue.try_swap_pop(popped));
+    value.assign(4, 4);
+    EXPECT_TRUE(queue.try_swap_push(value));
+    EXPECT_EQ(value.data(), popped_storage);
+}
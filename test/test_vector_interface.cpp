@@ -1,6 +1,9 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <memory_resource>
+
 #include "vector_interface.h"
 
 using namespace ncdlgen;
@@ -136,3 +139,112 @@ TEST(vector_interface, dimension_sizes)
         EXPECT_EQ(dimension_sizes[1], 3);
     }
 }
+
+TEST(vector_interface, dimension_sizes_ragged)
+{
+    // Only the sizes of the first containers match
+    using Data3D = std::vector<std::vector<std::vector<int>>>;
+    Data3D data{{{1, 2}, {3, 4}}, {{5, 6}, {7}}};
+    EXPECT_THROW((VectorOperations::container_dimension_sizes<int, Data3D>(data)), std::runtime_error);
+    EXPECT_THROW((VectorOperations::flatten_data<int, Data3D>(data)), std::runtime_error);
+
+    // The same number of elements in differently sized rows
+    std::vector<std::vector<int>> rows{{1, 2}, {3}, {4, 5, 6}};
+    EXPECT_THROW((VectorOperations::flatten_data<int, std::vector<std::vector<int>>>(rows)),
+                 std::runtime_error);
+
+    std::vector<std::vector<int>> empty_rows{{}, {}};
+    EXPECT_EQ((VectorOperations::container_dimension_sizes<int, std::vector<std::vector<int>>>(empty_rows)),
+              (std::vector<std::size_t>{2, 0}));
+}
+
+TEST(vector_interface, flatten_data)
+{
+    using Data3D = std::vector<std::vector<std::vector<float>>>;
+    Data3D data{{{1, 2, 3}, {4, 5, 6}}, {{7, 8, 9}, {10, 11, 12}}};
+
+    auto flat_data = VectorOperations::flatten_data<float, Data3D>(data);
+    EXPECT_EQ(flat_data.dimension_sizes, (std::vector<std::size_t>{2, 2, 3}));
+    EXPECT_EQ(flat_data.data, (std::vector<float>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}));
+
+    auto scalar = VectorOperations::flatten_data<float, float>(2.5f);
+    EXPECT_EQ(scalar.dimension_sizes, (std::vector<std::size_t>{1}));
+    EXPECT_EQ(scalar.data, (std::vector<float>{2.5f}));
+
+    auto empty = VectorOperations::flatten_data<float, Data3D>({});
+    EXPECT_EQ(empty.dimension_sizes, (std::vector<std::size_t>{0, 0, 0}));
+    EXPECT_TRUE(empty.data.empty());
+}
+
+TEST(vector_interface, copy_rows)
+{
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+    std::vector<int> flat(6);
+
+    VectorOperations::copy_rows(data, flat.data(), {2, 3});
+
+    EXPECT_EQ(flat, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(vector_interface, copy_rows_incorrect_dimensions)
+{
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5}};
+    std::vector<int> flat(6);
+
+    // Rows of different size
+    EXPECT_ANY_THROW(VectorOperations::copy_rows(data, flat.data(), {2, 3}));
+
+    // Too few rows
+    std::vector<std::vector<int>> short_data{{1, 2, 3}};
+    EXPECT_ANY_THROW(VectorOperations::copy_rows(short_data, flat.data(), {2, 3}));
+
+    // Incorrect number of dimensions
+    std::vector<std::vector<int>> full_data{{1, 2, 3}, {4, 5, 6}};
+    EXPECT_ANY_THROW(VectorOperations::copy_rows(full_data, flat.data(), {6}));
+}
+
+TEST(vector_interface, assign_rows)
+{
+    std::vector<std::vector<int>> data{};
+    std::vector<int> flat{1, 2, 3, 4, 5, 6};
+
+    VectorInterface::copy_from(data, flat.data(), {3, 2});
+
+    ASSERT_EQ(data.size(), 3);
+    EXPECT_EQ(data[0], (std::vector<int>{1, 2}));
+    EXPECT_EQ(data[1], (std::vector<int>{3, 4}));
+    EXPECT_EQ(data[2], (std::vector<int>{5, 6}));
+
+    // Incorrect number of dimensions
+    EXPECT_ANY_THROW(VectorInterface::copy_from(data, flat.data(), {6}));
+}
+
+TEST(vector_interface, pmr_vector)
+{
+    // The arena has no upstream, growing past it throws
+    std::array<std::byte, 1024> arena{};
+    std::pmr::monotonic_buffer_resource resource{arena.data(), arena.size(),
+                                                 std::pmr::null_memory_resource()};
+
+    using Container = std::pmr::vector<std::pmr::vector<int>>;
+    static_assert(VectorInterface::is_supported_ndarray<int, Container>());
+    static_assert(InterfaceTraits::has_copy_from_v<VectorInterface, int, Container>);
+
+    Container data{&resource};
+    std::vector<int> flat{1, 2, 3, 4, 5, 6};
+    VectorInterface::copy_from(data, flat.data(), {3, 2});
+
+    // The rows are allocated from the resource of the outer vector
+    ASSERT_EQ(data.size(), 3);
+    EXPECT_EQ(data[2][1], 6);
+    EXPECT_EQ(data[1].get_allocator().resource(), &resource);
+    EXPECT_EQ((VectorOperations::container_dimension_sizes<int, Container>(data)),
+              (std::vector<std::size_t>{3, 2}));
+
+    // The existing capacity is reused, 100 reads would not fit to the arena
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        VectorInterface::copy_from(data, flat.data(), {3, 2});
+    }
+    EXPECT_EQ(data[0], (std::pmr::vector<int>{1, 2}));
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <memory>
 
 #include <fmt/core.h>
 #include <gtest/gtest.h>
@@ -112,8 +114,9 @@ TEST(pipe, zeromq_read_incorrect_type)
 
 TEST(pipe, zeromq_read_incorrect_path)
 {
-
-    ZeroMQPipe pipe{};
+    // The other fields are kept until the requested field arrives
+    ZeroMQConfiguration config{.receive_timeout_ms = 100};
+    ZeroMQPipe pipe{config};
 
     {
         int data{4};
@@ -211,3 +214,742 @@ TEST(pipe, zeromq_config)
         EXPECT_EQ(read_data, data1);
     }
 }
+
+TEST(pipe, zeromq_vector_moved)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<float> data{1, 2, 3, 4};
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/bar", std::move(data));
+
+    auto read_data = pipe.read<std::vector<float>, float, VectorInterface>("/foo/bar");
+
+    ASSERT_EQ(read_data.size(), 4);
+    EXPECT_EQ(read_data[0], 1);
+    EXPECT_EQ(read_data[1], 2);
+    EXPECT_EQ(read_data[2], 3);
+    EXPECT_EQ(read_data[3], 4);
+}
+
+TEST(pipe, zeromq_vector_shared)
+{
+
+    ZeroMQPipe pipe{};
+
+    auto data = std::make_shared<const std::vector<double>>(std::vector<double>{1, 2, 3});
+    pipe.write<std::vector<double>, double, VectorInterface>("/foo/bar", data);
+
+    // The pipe holds on to the data until it is sent
+    data.reset();
+
+    auto read_data = pipe.read<std::vector<double>, double, VectorInterface>("/foo/bar");
+
+    ASSERT_EQ(read_data.size(), 3);
+    EXPECT_EQ(read_data[0], 1);
+    EXPECT_EQ(read_data[1], 2);
+    EXPECT_EQ(read_data[2], 3);
+}
+
+TEST(pipe, zeromq_vector_moved_empty)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<int> data{};
+    pipe.write<std::vector<int>, int, VectorInterface>("/foo/bar", std::move(data));
+
+    auto read_data = pipe.read<std::vector<int>, int, VectorInterface>("/foo/bar");
+
+    EXPECT_TRUE(read_data.empty());
+}
+
+TEST(pipe, zeromq_array_span)
+{
+
+    ZeroMQPipe pipe{};
+
+    // The span is copied to the message, the caller reuses its buffer right away
+    std::vector<float> buffer{1, 2, 3, 4, 5, 6};
+    pipe.write("/foo/bar", ArraySpan<float, 2>{buffer, {2, 3}});
+    pipe.write<ArraySpan<float, 2>, float, ArraySpanInterface>("/foo/baz",
+                                                               ArraySpan<float, 2>{buffer.data(), {3, 2}});
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+
+    auto read_data = pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/foo/bar");
+    EXPECT_EQ(read_data, (std::vector<std::vector<float>>{{1, 2, 3}, {4, 5, 6}}));
+
+    auto moved_data = pipe.read<std::vector<std::vector<float>>, float, VectorInterface>("/foo/baz");
+    EXPECT_EQ(moved_data, (std::vector<std::vector<float>>{{1, 2}, {3, 4}, {5, 6}}));
+}
+
+TEST(pipe, zeromq_vector_ragged)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5}};
+    auto helper = [&] { pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data); };
+    EXPECT_ANY_THROW(helper());
+}
+
+TEST(pipe, zeromq_read_into)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+    std::vector<std::vector<int>> read_data{};
+
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+    pipe.read_into<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", read_data);
+    EXPECT_EQ(read_data, data);
+
+    // The second read reuses the rows of the container
+    const int* first_row = read_data[0].data();
+    const int* second_row = read_data[1].data();
+
+    data = {{7, 8, 9}, {10, 11, 12}};
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+    pipe.read_into<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", read_data);
+    EXPECT_EQ(read_data, data);
+    EXPECT_EQ(read_data[0].data(), first_row);
+    EXPECT_EQ(read_data[1].data(), second_row);
+}
+
+TEST(pipe, zeromq_read_into_scalar)
+{
+
+    ZeroMQPipe pipe{};
+
+    double data{3.5};
+    pipe.write<double, double, VectorInterface>("/foo/bar", data);
+
+    double read_data{};
+    pipe.read_into<double, double, VectorInterface>("/foo/bar", read_data);
+    EXPECT_DOUBLE_EQ(read_data, 3.5);
+}
+
+TEST(pipe, zeromq_variable_info_binary)
+{
+
+    ZeroMQVariableInfo info{"/foo/bar", {3, 5}, ZeroMQElementType::Float};
+    auto binary = info.to_binary();
+
+    EXPECT_EQ(binary.size(), ZeroMQVariableInfo::binary_size("/foo/bar", 2));
+    EXPECT_EQ(static_cast<std::uint8_t>(binary[0]), ZeroMQVariableInfo::binary_version);
+
+    ZeroMQVariableInfo decoded{};
+    decoded.decode(binary);
+
+    EXPECT_EQ(decoded.name, "/foo/bar");
+    EXPECT_EQ(decoded.element_type, ZeroMQElementType::Float);
+    ASSERT_EQ(decoded.dimension_sizes.size(), 2);
+    EXPECT_EQ(decoded.dimension_sizes[0], 3);
+    EXPECT_EQ(decoded.dimension_sizes[1], 5);
+}
+
+TEST(pipe, zeromq_variable_info_binary_little_endian)
+{
+
+    ZeroMQVariableInfo info{"/a", {258}, ZeroMQElementType::Int32};
+    auto binary = info.to_binary();
+
+    // version, type, rank, name length, dimension size, name
+    ASSERT_EQ(binary.size(), 1 + 1 + 2 + 4 + 8 + 2);
+    EXPECT_EQ(binary[2], 1);
+    EXPECT_EQ(binary[3], 0);
+    EXPECT_EQ(binary[4], 2);
+    EXPECT_EQ(binary[8], 2);
+    EXPECT_EQ(binary[9], 1);
+    EXPECT_EQ(binary.substr(16), "/a");
+}
+
+TEST(pipe, zeromq_variable_info_binary_invalid)
+{
+
+    ZeroMQVariableInfo info{"/foo/bar", {3, 5}, ZeroMQElementType::Float};
+    auto binary = info.to_binary();
+
+    ZeroMQVariableInfo decoded{};
+    EXPECT_ANY_THROW(decoded.decode(binary.substr(0, binary.size() - 1)));
+    EXPECT_ANY_THROW(decoded.decode(binary.substr(0, 4)));
+}
+
+TEST(pipe, zeromq_variable_info_decode_text)
+{
+
+    ZeroMQVariableInfo decoded{};
+    decoded.decode("/bar;3,5");
+
+    EXPECT_EQ(decoded.name, "/bar");
+    EXPECT_EQ(decoded.element_type, ZeroMQElementType::Unknown);
+    ASSERT_EQ(decoded.dimension_sizes.size(), 2);
+    EXPECT_EQ(decoded.dimension_sizes[0], 3);
+    EXPECT_EQ(decoded.dimension_sizes[1], 5);
+}
+
+TEST(pipe, zeromq_text_header)
+{
+    ZeroMQConfiguration config{.header_encoding = ZeroMQHeaderEncoding::Text};
+    ZeroMQPipe pipe{config};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+
+    auto read_data = pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar");
+    EXPECT_EQ(read_data, data);
+}
+
+TEST(pipe, zeromq_read_incorrect_element_type)
+{
+
+    ZeroMQPipe pipe{};
+
+    // Same size, different element type
+    std::vector<float> data{1, 2, 3};
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/bar", data);
+
+    auto helper = [&] { pipe.read<std::vector<int>, int, VectorInterface>("/foo/bar"); };
+    EXPECT_ANY_THROW(helper());
+}
+
+TEST(pipe, zeromq_record)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+    std::vector<float> data_1d{1.5f, 2.5f};
+
+    pipe.begin_record();
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/baz", std::vector<float>{data_1d});
+    pipe.write<int, int, VectorInterface>("/foo/scalar", 42);
+    pipe.end_record();
+
+    // Fields outside the record are sent individually
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/after", data_1d);
+
+    auto read_data = pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar");
+    auto read_data_1d = pipe.read<std::vector<float>, float, VectorInterface>("/foo/baz");
+    auto read_scalar = pipe.read<int, int, VectorInterface>("/foo/scalar");
+    auto read_after = pipe.read<std::vector<float>, float, VectorInterface>("/foo/after");
+
+    EXPECT_EQ(read_data, data);
+    EXPECT_EQ(read_data_1d, data_1d);
+    EXPECT_EQ(read_scalar, 42);
+    EXPECT_EQ(read_after, data_1d);
+}
+
+TEST(pipe, zeromq_record_text_header)
+{
+    ZeroMQConfiguration config{.header_encoding = ZeroMQHeaderEncoding::Text};
+    ZeroMQPipe pipe{config};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+
+    pipe.begin_record();
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+    pipe.write<int, int, VectorInterface>("/foo/scalar", 42);
+    pipe.end_record();
+
+    EXPECT_EQ((pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar")), data);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/scalar")), 42);
+}
+
+TEST(pipe, zeromq_record_nested)
+{
+
+    ZeroMQPipe pipe{};
+
+    pipe.begin_record();
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    pipe.begin_record();
+    pipe.write<int, int, VectorInterface>("/foo/baz/bee", 2);
+    pipe.end_record();
+    pipe.write<int, int, VectorInterface>("/foo/foobar", 3);
+    pipe.end_record();
+
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 1);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz/bee")), 2);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/foobar")), 3);
+}
+
+TEST(pipe, zeromq_record_discard)
+{
+
+    ZeroMQPipe pipe{};
+
+    pipe.begin_record();
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    pipe.discard_record();
+
+    pipe.write<int, int, VectorInterface>("/foo/baz", 2);
+
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), 2);
+    EXPECT_ANY_THROW(pipe.end_record());
+}
+
+TEST(pipe, zeromq_record_failed_field)
+{
+
+    ZeroMQPipe pipe{};
+
+    pipe.begin_record();
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    std::vector<std::vector<int>> ragged{{1, 2, 3}, {4, 5}};
+    EXPECT_ANY_THROW((pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/ragged", ragged)));
+    pipe.write<int, int, VectorInterface>("/foo/baz", 2);
+    pipe.end_record();
+
+    // The failed field is not left in the record
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 1);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), 2);
+}
+
+TEST(pipe, zeromq_record_disabled)
+{
+    ZeroMQConfiguration config{.record_batching = false};
+    ZeroMQPipe pipe{config};
+
+    pipe.begin_record();
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    pipe.write<int, int, VectorInterface>("/foo/baz", 2);
+    pipe.end_record();
+
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 1);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), 2);
+}
+
+TEST(pipe, zeromq_record_incorrect_path)
+{
+    ZeroMQConfiguration config{.receive_timeout_ms = 100};
+    ZeroMQPipe pipe{config};
+
+    pipe.begin_record();
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    pipe.end_record();
+
+    auto helper = [&] { pipe.read<int, int, VectorInterface>("/foo/baz"); };
+    EXPECT_ANY_THROW(helper());
+}
+
+TEST(pipe, zeromq_generated_record)
+{
+
+    ZeroMQPipe pipe{};
+
+    ncdlgen::simple::foo data{.bar = 1, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6}, {7, 8}}};
+    ncdlgen::simple root{.foo_g = data};
+
+    ncdlgen::write(pipe, root);
+
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+
+    EXPECT_EQ(read_root.foo_g.bar, data.bar);
+    EXPECT_EQ(read_root.foo_g.baz, data.baz);
+    EXPECT_EQ(read_root.foo_g.bee, data.bee);
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+}
+
+TEST(pipe, zeromq_generated_record_failed_write)
+{
+
+    ZeroMQPipe pipe{};
+
+    // The ragged foobar throws while it is copied to the record
+    ncdlgen::simple ragged_root{.foo_g = {.bar = 1, .foobar = {{5, 6}, {7}}}};
+    EXPECT_THROW(ncdlgen::write(pipe, ragged_root), std::runtime_error);
+
+    // The failed record is discarded, the next one is sent
+    ncdlgen::simple root{.foo_g = {.bar = 2, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6}, {7, 8}}}};
+    ncdlgen::write(pipe, root);
+
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+    EXPECT_EQ(read_root.foo_g.bar, 2);
+    EXPECT_EQ(read_root.foo_g.foobar, root.foo_g.foobar);
+}
+
+TEST(pipe, zeromq_asynchronous_send)
+{
+    ZeroMQConfiguration config{.asynchronous_send = true, .send_queue_depth = 4};
+    ZeroMQPipe pipe{config};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+    for (int i = 0; i < 16; i++)
+    {
+        pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+        pipe.write<int, int, VectorInterface>("/foo/baz", int{i});
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        EXPECT_EQ((pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar")), data);
+        EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), i);
+    }
+
+    pipe.flush();
+    auto statistics = pipe.send_statistics();
+    EXPECT_EQ(statistics.sent_messages, 32);
+    EXPECT_EQ(statistics.queue_depth, 0);
+    EXPECT_LE(statistics.max_queue_depth, 4);
+    EXPECT_EQ(statistics.dropped_messages, 0);
+}
+
+TEST(pipe, zeromq_asynchronous_send_record)
+{
+    ZeroMQConfiguration config{.asynchronous_send = true};
+    ZeroMQPipe pipe{config};
+
+    ncdlgen::simple::foo data{.bar = 1, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6}, {7, 8}}};
+    ncdlgen::simple root{.foo_g = data};
+
+    ncdlgen::write(pipe, root);
+    pipe.flush();
+    EXPECT_EQ(pipe.send_statistics().sent_messages, 1);
+
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+}
+
+TEST(pipe, zeromq_asynchronous_send_drop)
+{
+    ZeroMQConfiguration config{
+        .asynchronous_send = true, .send_queue_depth = 1, .queue_full_policy = ZeroMQQueueFullPolicy::Drop};
+    ZeroMQPipe pipe{config};
+
+    for (int i = 0; i < 100; i++)
+    {
+        pipe.write<int, int, VectorInterface>("/foo/bar", int{i});
+    }
+    pipe.flush();
+
+    // The messages that did not fit to the queue are dropped
+    auto statistics = pipe.send_statistics();
+    EXPECT_EQ(statistics.sent_messages + statistics.dropped_messages, 100);
+    EXPECT_LE(statistics.max_queue_depth, 1);
+    EXPECT_EQ(statistics.stalls, 0);
+
+    for (std::size_t i = 0; i < statistics.sent_messages; i++)
+    {
+        pipe.read<int, int, VectorInterface>("/foo/bar");
+    }
+}
+
+TEST(pipe, zeromq_synchronous_send_statistics)
+{
+
+    ZeroMQPipe pipe{};
+
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    pipe.flush();
+
+    EXPECT_EQ(pipe.send_statistics().sent_messages, 0);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 1);
+}
+
+TEST(pipe, zeromq_read_out_of_order)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<std::vector<int>> data{{1, 2, 3}, {4, 5, 6}};
+    pipe.write<int, int, VectorInterface>("/foo/bar", 1);
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/baz", data);
+    pipe.write<int, int, VectorInterface>("/foo/bar", 2);
+    pipe.write<int, int, VectorInterface>("/foo/bee", 3);
+
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bee")), 3);
+    EXPECT_EQ((pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/foo/baz")), data);
+    // The fields of the same variable are read in the order they were written
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 1);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 2);
+}
+
+TEST(pipe, zeromq_record_out_of_order)
+{
+
+    ZeroMQPipe pipe{};
+
+    std::vector<float> data{1.5f, 2.5f};
+    for (int i = 0; i < 2; i++)
+    {
+        pipe.begin_record();
+        pipe.write<int, int, VectorInterface>("/foo/bar", int{i});
+        pipe.write<std::vector<float>, float, VectorInterface>("/foo/baz", data);
+        pipe.end_record();
+    }
+    pipe.write<int, int, VectorInterface>("/foo/bee", 3);
+
+    // The first records are kept while waiting for the last field
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bee")), 3);
+    EXPECT_EQ((pipe.read<std::vector<float>, float, VectorInterface>("/foo/baz")), data);
+    EXPECT_EQ((pipe.read<std::vector<float>, float, VectorInterface>("/foo/baz")), data);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 0);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), 1);
+}
+
+TEST(pipe, zeromq_read_streams)
+{
+    // Two streams sharing the socket, read by separate generated readers
+    ZeroMQPipe pipe{};
+
+    ncdlgen::simple::foo data{.bar = 1, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6}, {7, 8}}};
+    ncdlgen::simple root{.foo_g = data};
+
+    pipe.write<int, int, VectorInterface>("/status/counter", 7);
+    ncdlgen::write(pipe, root);
+    pipe.write<int, int, VectorInterface>("/status/counter", 8);
+
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/status/counter")), 7);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/status/counter")), 8);
+}
+
+TEST(pipe, zeromq_read_max_pending_fields)
+{
+    ZeroMQConfiguration config{.max_pending_fields = 2};
+    ZeroMQPipe pipe{config};
+
+    for (int i = 0; i < 3; i++)
+    {
+        pipe.write<int, int, VectorInterface>("/foo/bar", int{i});
+    }
+    pipe.write<int, int, VectorInterface>("/foo/baz", 3);
+
+    auto helper = [&] { pipe.read<int, int, VectorInterface>("/foo/baz"); };
+    EXPECT_ANY_THROW(helper());
+}
+
+TEST(pipe, zeromq_variable_info_binary_id)
+{
+
+    auto binary = std::string(ZeroMQVariableInfo::binary_id_size(2), '\0');
+    ZeroMQVariableInfo::to_binary_id(7, ZeroMQElementType::Int32, {3, 5}, binary.data());
+
+    EXPECT_EQ(static_cast<std::uint8_t>(binary[0]), ZeroMQVariableInfo::binary_id_version);
+    // The id replaces the name
+    EXPECT_EQ(binary.size(), ZeroMQVariableInfo::binary_size("", 2));
+
+    ZeroMQVariableInfo decoded{};
+    decoded.decode(binary);
+
+    EXPECT_EQ(decoded.field_id, 7);
+    EXPECT_EQ(decoded.name, "");
+    EXPECT_EQ(decoded.element_type, ZeroMQElementType::Int32);
+    ASSERT_EQ(decoded.dimension_sizes.size(), 2);
+    EXPECT_EQ(decoded.dimension_sizes[0], 3);
+    EXPECT_EQ(decoded.dimension_sizes[1], 5);
+}
+
+TEST(pipe, zeromq_generated_schema)
+{
+
+    ZeroMQPipe pipe{};
+    pipe.use_schema(ncdlgen::simple_schema());
+
+    ncdlgen::simple::foo data{.bar = 1, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6}, {7, 8}}};
+    ncdlgen::simple root{.foo_g = data};
+
+    ncdlgen::write(pipe, root);
+    ncdlgen::write(pipe, root);
+
+    // Generated and hand written reads both find the fields sent by id
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+    EXPECT_EQ(read_root.foo_g.bar, data.bar);
+    EXPECT_EQ(read_root.foo_g.baz, data.baz);
+    EXPECT_EQ(read_root.foo_g.bee, data.bee);
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+
+    EXPECT_EQ((pipe.read<std::vector<uint16_t>, uint16_t, VectorInterface>("/foo/bee")), data.bee);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/bar")), data.bar);
+}
+
+TEST(pipe, zeromq_schema_received)
+{
+    // Separate sending and receiving pipes
+    ZeroMQConfiguration config{
+        .outbound_socket = "tcp://127.0.0.1:42044",
+        .incoming_socket = "tcp://127.0.0.1:42046",
+        .record_batching = false,
+    };
+    ZeroMQConfiguration receiver_config{
+        .outbound_socket = "tcp://127.0.0.1:42046",
+        .incoming_socket = "tcp://127.0.0.1:42044",
+    };
+    ZeroMQPipe sender{config};
+    ZeroMQPipe receiver{receiver_config};
+    sender.use_schema(ncdlgen::simple_schema());
+
+    sender.write<int, int, VectorInterface>({0, "/foo/bar"}, 4);
+
+    // The receiver without a schema of its own uses the received one to resolve the id
+    EXPECT_EQ((receiver.read<int, int, VectorInterface>("/foo/bar")), 4);
+}
+
+TEST(pipe, zeromq_schema_mismatch)
+{
+    ZeroMQConfiguration config{
+        .outbound_socket = "tcp://127.0.0.1:42045",
+        .incoming_socket = "tcp://127.0.0.1:42047",
+    };
+    ZeroMQConfiguration receiver_config{
+        .outbound_socket = "tcp://127.0.0.1:42047",
+        .incoming_socket = "tcp://127.0.0.1:42045",
+    };
+    ZeroMQPipe sender{config};
+    ZeroMQPipe receiver{receiver_config};
+
+    auto schema = ncdlgen::simple_schema();
+    schema.fingerprint++;
+    sender.use_schema(ncdlgen::simple_schema());
+    receiver.use_schema(schema);
+
+    sender.write<int, int, VectorInterface>({0, "/foo/bar"}, 4);
+
+    auto helper = [&] { receiver.read<int, int, VectorInterface>({0, "/foo/bar"}); };
+    EXPECT_ANY_THROW(helper());
+}
+
+TEST(pipe, zeromq_chunked_vector)
+{
+    ZeroMQConfiguration config{.chunk_size = 64};
+    ZeroMQPipe pipe{config};
+
+    std::vector<float> data(1000);
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = static_cast<float>(i) * 0.5f;
+    }
+
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/bar", data);
+    EXPECT_EQ((pipe.read<std::vector<float>, float, VectorInterface>("/foo/bar")), data);
+
+    // The chunks are reassembled to the existing container
+    std::vector<float> read_data(5000);
+    auto* storage = read_data.data();
+    pipe.write<std::vector<float>, float, VectorInterface>("/foo/bar", data);
+    pipe.read_into<std::vector<float>, float, VectorInterface>("/foo/bar", read_data);
+    EXPECT_EQ(read_data, data);
+    EXPECT_EQ(read_data.data(), storage);
+}
+
+TEST(pipe, zeromq_chunked_vector_2d)
+{
+    // The rows of 7 elements do not line up with the chunks
+    ZeroMQConfiguration config{.chunk_size = 16, .max_chunks_in_flight = 2};
+    ZeroMQPipe pipe{config};
+
+    std::vector<std::vector<int>> data(50, std::vector<int>(7));
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        for (std::size_t j = 0; j < data[i].size(); j++)
+        {
+            data[i][j] = static_cast<int>(i * 100 + j);
+        }
+    }
+
+    pipe.write<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar", data);
+    pipe.write<int, int, VectorInterface>("/foo/baz", 3);
+
+    EXPECT_EQ((pipe.read<std::vector<std::vector<int>>, int, VectorInterface>("/foo/bar")), data);
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), 3);
+}
+
+TEST(pipe, zeromq_chunked_out_of_order)
+{
+    ZeroMQConfiguration config{.chunk_size = 16};
+    ZeroMQPipe pipe{config};
+
+    std::vector<double> data{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    pipe.write<std::vector<double>, double, VectorInterface>("/foo/bar", data);
+    pipe.write<int, int, VectorInterface>("/foo/baz", 3);
+
+    // The stream of the other variable is reassembled and kept
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), 3);
+    EXPECT_EQ((pipe.read<std::vector<double>, double, VectorInterface>("/foo/bar")), data);
+}
+
+TEST(pipe, zeromq_chunked_incorrect_element_type)
+{
+    ZeroMQConfiguration config{.chunk_size = 16};
+    ZeroMQPipe pipe{config};
+
+    std::vector<int> data(100, 1);
+    pipe.write<std::vector<int>, int, VectorInterface>("/foo/bar", data);
+    pipe.write<int, int, VectorInterface>("/foo/baz", 3);
+
+    // The chunks of the rejected stream are skipped
+    auto helper = [&] { pipe.read<std::vector<float>, float, VectorInterface>("/foo/bar"); };
+    EXPECT_ANY_THROW(helper());
+    EXPECT_EQ((pipe.read<int, int, VectorInterface>("/foo/baz")), 3);
+}
+
+TEST(pipe, zeromq_chunked_generated_record)
+{
+    // The record is split around the streamed field
+    ZeroMQConfiguration config{.chunk_size = 8};
+    ZeroMQPipe pipe{config};
+
+    ncdlgen::simple::foo data{.bar = 1, .baz = 2.5f, .bee = {3, 4}, .foobar = {{5, 6, 7}, {8, 9, 10}}};
+    ncdlgen::simple root{.foo_g = data};
+
+    ncdlgen::write(pipe, root);
+
+    ncdlgen::simple read_root{};
+    ncdlgen::read(pipe, read_root);
+
+    EXPECT_EQ(read_root.foo_g.bar, data.bar);
+    EXPECT_EQ(read_root.foo_g.baz, data.baz);
+    EXPECT_EQ(read_root.foo_g.bee, data.bee);
+    EXPECT_EQ(read_root.foo_g.foobar, data.foobar);
+}
+
+TEST(pipe, zeromq_chunked_asynchronous_send)
+{
+    ZeroMQConfiguration config{.asynchronous_send = true,
+                               .send_queue_depth = 2,
+                               .queue_full_policy = ZeroMQQueueFullPolicy::Drop,
+                               .chunk_size = 32};
+    ZeroMQPipe pipe{config};
+
+    using Array = std::vector<std::vector<std::uint16_t>>;
+    Array data(64, std::vector<std::uint16_t>(9, 7));
+    pipe.write<Array, std::uint16_t, VectorInterface>("/foo/bar", data);
+    pipe.flush();
+
+    // The chunks are not dropped even when the queue is full
+    EXPECT_EQ(pipe.send_statistics().dropped_messages, 0);
+    EXPECT_EQ((pipe.read<Array, std::uint16_t, VectorInterface>("/foo/bar")), data);
+}
+
+TEST(pipe, zeromq_chunked_send_timeout)
+{
+    // Nothing receives from the outbound socket, so the sender thread blocks and
+    // the chunks stay in flight
+    ZeroMQConfiguration config{.outbound_socket = "tcp://127.0.0.1:42043",
+                               .incoming_socket = "tcp://127.0.0.1:42044",
+                               .asynchronous_send = true,
+                               .send_timeout_ms = 100,
+                               .chunk_size = 16,
+                               .max_chunks_in_flight = 2};
+    auto pipe = std::make_unique<ZeroMQPipe>(config);
+
+    std::vector<std::uint16_t> data(256, 7);
+    EXPECT_THROW((pipe->write<std::vector<std::uint16_t>, std::uint16_t, VectorInterface>("/foo/bar", data)),
+                 std::runtime_error);
+
+    // A receiver lets the sender thread send the queued chunks and stop
+    ZeroMQPipe receiver{
+        {.outbound_socket = "tcp://127.0.0.1:42045", .incoming_socket = "tcp://127.0.0.1:42043"}};
+    pipe.reset();
+}